@@ -0,0 +1,710 @@
+#pragma once
+
+#include "intersect.hpp"
+#include <algorithm>
+
+//Batched kernels over arrays, compiled for several instruction sets and
+//dispatched at run time, so a single binary uses AVX2 or AVX-512 where the
+//CPU has them without being built with -mavx2. Dispatch needs GCC or Clang
+//on x86; elsewhere, or with GEFEC_MATH_NO_DISPATCH defined, only the scalar
+//level exists. Results must not overlap the inputs.
+#if !defined(GEFEC_MATH_NO_DISPATCH) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEFEC_MATH_DISPATCH 1
+#else
+#define GEFEC_MATH_DISPATCH 0
+#endif
+
+namespace gf::math{
+
+//Instruction set levels, in increasing order:
+enum class isa{
+  scalar, //one element at a time
+  sse2, //packets of DispatchLanes elements for the x86-64 baseline
+  avx2, //the same packets with AVX2 and FMA
+  avx512 //the same packets with AVX-512 (F and VL)
+};
+
+inline constexpr auto isa_name(isa level) noexcept{
+  switch (level){
+    case isa::sse2: return "sse2";
+    case isa::avx2: return "avx2";
+    case isa::avx512: return "avx512";
+    default: return "scalar";
+  }
+}
+
+namespace detail{
+
+//Elements per packet; the packet loops have this fixed trip count, which is
+//what lets -O2 vectorize them:
+inline constexpr auto DispatchLanes = std::size_t(16);
+
+inline auto detect_isa() noexcept{
+#if GEFEC_MATH_DISPATCH
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) return isa::avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return isa::avx2;
+  if (__builtin_cpu_supports("sse2")) return isa::sse2;
+#endif
+
+  return isa::scalar;
+}
+
+//Detected once, on first use:
+inline auto& selected_isa() noexcept{
+  static auto level = detect_isa();
+  return level;
+}
+
+//Calls kernel.step(i, arrays...) for i in [0, count), a packet at a time.
+//The arrays are restrict qualified here, where the loop is, so that the
+//stores of one element can't be assumed to change the inputs of another.
+//Uniform inputs (matrices, planes) are members of the kernel, which is a
+//local copy, so they stay in registers across the loop:
+template<typename Kernel, typename... P>
+[[gnu::always_inline]] inline auto for_packets(Kernel kernel, std::size_t count, P* __restrict... arrays) noexcept -> void{
+  const auto packets = count / DispatchLanes;
+
+  for (auto packet : range(packets)){
+    for (auto lane : range(DispatchLanes)){
+      kernel.step(packet * DispatchLanes + lane, arrays...);
+    }
+  }
+
+  for (auto i : range(packets * DispatchLanes, count)){
+    kernel.step(i, arrays...);
+  }
+}
+
+template<typename Kernel, typename... P>
+inline auto run_scalar(Kernel kernel, std::size_t count, P*... arrays) noexcept -> void{
+  for (auto i : range(count)){
+    kernel.step(i, arrays...);
+  }
+}
+
+#if GEFEC_MATH_DISPATCH
+template<typename Kernel, typename... P>
+inline auto run_sse2(Kernel kernel, std::size_t count, P*... arrays) noexcept -> void{
+  for_packets(kernel, count, arrays...);
+}
+
+template<typename Kernel, typename... P>
+[[gnu::target("avx2,fma")]]
+inline auto run_avx2(Kernel kernel, std::size_t count, P*... arrays) noexcept -> void{
+  for_packets(kernel, count, arrays...);
+}
+
+template<typename Kernel, typename... P>
+[[gnu::target("avx512f,avx512vl,avx2,fma")]]
+inline auto run_avx512(Kernel kernel, std::size_t count, P*... arrays) noexcept -> void{
+  for_packets(kernel, count, arrays...);
+}
+#endif
+
+template<typename Kernel, typename... P>
+inline auto dispatch(const Kernel& kernel, std::size_t count, P*... arrays) noexcept{
+  switch (selected_isa()){
+#if GEFEC_MATH_DISPATCH
+    case isa::avx512: return run_avx512(kernel, count, arrays...);
+    case isa::avx2: return run_avx2(kernel, count, arrays...);
+    case isa::sse2: return run_sse2(kernel, count, arrays...);
+#endif
+    default: return run_scalar(kernel, count, arrays...);
+  }
+}
+
+//The kernels see arrays of vectors, matrices and boxes as arrays of their
+//components. Every step() computes in the same order as the corresponding
+//vec and mat operators, so all levels give the operators' results (unless
+//the compiler contracts into FMA, as -std=gnu++ modes do by default).
+//The steps are straight-line code, a loop inside keeps the packet loop
+//around it from vectorizing (cull_kernel vectorizes its inner loop instead).
+static_assert(sizeof(vec<float, 3>) == 3 * sizeof(float), "vectors can't have padding");
+static_assert(sizeof(vec<float, 4>) == 4 * sizeof(float), "vectors can't have padding");
+static_assert(sizeof(mat<float, 4, 4>) == 16 * sizeof(float), "matrices can't have padding");
+static_assert(sizeof(aabb<float>) == 6 * sizeof(float), "boxes can't have padding");
+
+template<typename T, typename E>
+inline auto components(E* elements) noexcept{
+  return reinterpret_cast<std::conditional_t<std::is_const_v<E>, const T*, T*>>(elements);
+}
+
+//Column-major matrix elements, m[column * 4 + row]:
+struct transform_points_kernel{
+  float m[16];
+
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* p, float* result) const noexcept{
+    const auto x = p[i * 3];
+    const auto y = p[i * 3 + 1];
+    const auto z = p[i * 3 + 2];
+
+    result[i * 3] = m[0] * x + m[4] * y + m[8] * z + m[12];
+    result[i * 3 + 1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+    result[i * 3 + 2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+  }
+};
+
+struct transform_kernel{
+  float m[16];
+
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* v, float* result) const noexcept{
+    const auto x = v[i * 4];
+    const auto y = v[i * 4 + 1];
+    const auto z = v[i * 4 + 2];
+    const auto w = v[i * 4 + 3];
+
+    result[i * 4] = m[0] * x + m[4] * y + m[8] * z + m[12] * w;
+    result[i * 4 + 1] = m[1] * x + m[5] * y + m[9] * z + m[13] * w;
+    result[i * 4 + 2] = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+    result[i * 4 + 3] = m[3] * x + m[7] * y + m[11] * z + m[15] * w;
+  }
+};
+
+struct dot_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* a, const float* b, float* result) const noexcept{
+    result[i] = a[i * 3] * b[i * 3] + a[i * 3 + 1] * b[i * 3 + 1] + a[i * 3 + 2] * b[i * 3 + 2];
+  }
+};
+
+struct normalize_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* v, float* result) const noexcept{
+    const auto x = v[i * 3];
+    const auto y = v[i * 3 + 1];
+    const auto z = v[i * 3 + 2];
+    const auto inverse = 1.f / std::sqrt(x * x + y * y + z * z);
+
+    result[i * 3] = x * inverse;
+    result[i * 3 + 1] = y * inverse;
+    result[i * 3 + 2] = z * inverse;
+  }
+};
+
+//Column x of the product is a * column x of b, four columns of a scaled and summed:
+struct multiply_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* a, const float* b, float* result) const noexcept{
+    const auto column = [&](std::size_t x){
+      const auto b0 = b[i * 16 + x * 4];
+      const auto b1 = b[i * 16 + x * 4 + 1];
+      const auto b2 = b[i * 16 + x * 4 + 2];
+      const auto b3 = b[i * 16 + x * 4 + 3];
+
+      result[i * 16 + x * 4] = a[i * 16] * b0 + a[i * 16 + 4] * b1 + a[i * 16 + 8] * b2 + a[i * 16 + 12] * b3;
+      result[i * 16 + x * 4 + 1] = a[i * 16 + 1] * b0 + a[i * 16 + 5] * b1 + a[i * 16 + 9] * b2 + a[i * 16 + 13] * b3;
+      result[i * 16 + x * 4 + 2] = a[i * 16 + 2] * b0 + a[i * 16 + 6] * b1 + a[i * 16 + 10] * b2 + a[i * 16 + 14] * b3;
+      result[i * 16 + x * 4 + 3] = a[i * 16 + 3] * b0 + a[i * 16 + 7] * b1 + a[i * 16 + 11] * b2 + a[i * 16 + 15] * b3;
+    };
+
+    column(0);
+    column(1);
+    column(2);
+    column(3);
+  }
+};
+
+//Boxes are 6 floats apart, a stride the vectorizer can't deinterleave, so
+//this kernel vectorizes across the planes of one box instead. The planes are
+//stored by component and padded to 8 with planes every box is inside of.
+//Like overlaps(frustum, aabb), n.farthest picks min or max by the sign of n:
+struct cull_kernel{
+  static constexpr auto Planes = std::size_t(8);
+
+  float nx[Planes] = {};
+  float ny[Planes] = {};
+  float nz[Planes] = {};
+  float w[Planes] = {};
+
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* boxes, std::uint8_t* visible) const noexcept{
+    const auto min_x = boxes[i * 6];
+    const auto min_y = boxes[i * 6 + 1];
+    const auto min_z = boxes[i * 6 + 2];
+    const auto max_x = boxes[i * 6 + 3];
+    const auto max_y = boxes[i * 6 + 4];
+    const auto max_z = boxes[i * 6 + 5];
+    auto inside = 1;
+
+    for (auto p : range(Planes)){
+      const auto distance =
+        nx[p] * (nx[p] >= 0.f ? max_x : min_x) +
+        ny[p] * (ny[p] >= 0.f ? max_y : min_y) +
+        nz[p] * (nz[p] >= 0.f ? max_z : min_z) + w[p];
+
+      inside &= distance >= 0.f;
+    }
+
+    visible[i] = static_cast<std::uint8_t>(inside);
+  }
+};
+
+//Polynomial approximations of float sin, cos, tan, atan2, exp, log and pow,
+//within 2 ULP of the correctly rounded result. They have no branches: every
+//case is computed and picked with an integer mask, and conditions are
+//combined with | and &, since for a float select or a || the compiler may put
+//a case behind a branch that it can't take back (-ftrapping-math) to
+//vectorize the packet loop. Per element they're slower than std::, which is
+//why math.hpp calls std:: for vectors.
+[[gnu::always_inline]] inline auto select_bits(bool condition, float a, float b) noexcept{
+  const auto mask = std::uint32_t(0) - std::uint32_t(condition);
+  return bits_float((float_bits(a) & mask) | (float_bits(b) & ~mask));
+}
+
+[[gnu::always_inline]] inline auto select_bits(bool condition, double a, double b) noexcept{
+  const auto mask = std::uint64_t(0) - std::uint64_t(condition);
+  return bits_double((double_bits(a) & mask) | (double_bits(b) & ~mask));
+}
+
+//std::clamp() compiles to branches; this also takes NaN to min, which keeps
+//conversions to integers defined:
+template<typename T>
+[[gnu::always_inline]] inline auto clamp_bits(T x, T min, T max) noexcept{
+  return select_bits(!(x >= min), min, select_bits(x > max, max, x));
+}
+
+//Rounds to the nearest integer, |x| < 2^51, without SSE4.1:
+[[gnu::always_inline]] inline auto round_nearest(double x) noexcept{
+  return (x + 6755399441055744.0) - 6755399441055744.0;
+}
+
+//x - q * pi / 2 for the nearest integer q, in double, and the quadrant q mod
+//4. pi / 2 is split in a 33 bit part, whose products with q are exact, and
+//the rest. Exact enough for |x| < 2^22, the array functions call std:: for
+//larger x. Those, infinities and NaN are reduced as 0 here, which keeps q in
+//the range of an int; the callers make the non-finite ones NaN:
+[[gnu::always_inline]] inline auto reduce_half_pi(float x, std::uint32_t& quadrant) noexcept{
+  const auto d = double(select_bits(std::abs(x) < 4194304.f, x, 0.f));
+  const auto q = round_nearest(d * 0.63661977236758134);
+
+  quadrant = std::uint32_t(std::int32_t(q));
+  return (d - q * 1.57079632673412561417) - q * 6.07710050650619224932e-11;
+}
+
+//Minimax polynomials of sin and cos on [-pi / 4, pi / 4] (Cephes), swapped
+//and negated by quadrant:
+[[gnu::always_inline]] inline auto float_sincos(float x) noexcept{
+  auto quadrant = std::uint32_t(0);
+  const auto r = float(reduce_half_pi(x, quadrant));
+  const auto z = r * r;
+
+  //r * z * (...) is +0 for -0, which would lose the sign of sin(-0):
+  const auto s = select_bits(r == 0.f, r, r + r * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f)));
+  const auto c = 1.f - 0.5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+
+  const auto swap = (quadrant & 1) != 0;
+  const auto finite = x - x == 0.f;
+  constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+  return std::pair(
+    select_bits(finite, bits_float(float_bits(select_bits(swap, c, s)) ^ ((quadrant & 2) << 30)), NaN),
+    select_bits(finite, bits_float(float_bits(select_bits(swap, s, c)) ^ (((quadrant + 1) & 2) << 30)), NaN)
+  );
+}
+
+//tan(r) on [-pi / 4, pi / 4] (Cephes), -1 / tan(r) in odd quadrants. In
+//double, the division would cost a float 2 ULP:
+[[gnu::always_inline]] inline auto float_tan(float x) noexcept{
+  auto quadrant = std::uint32_t(0);
+  const auto r = reduce_half_pi(x, quadrant);
+  const auto z = r * r;
+
+  const auto t = r + r * z * (3.33331568548e-1 + z * (1.33387994085e-1 + z * (5.34112807005e-2 +
+    z * (2.44301354525e-2 + z * (3.11992232697e-3 + z * 9.38540185543e-3)))));
+
+  const auto result = float(select_bits((quadrant & 1) != 0, -1.0 / t, t));
+  return select_bits(x - x == 0.f, result, std::numeric_limits<float>::quiet_NaN());
+}
+
+//e^x = 2^n * e^r, |r| <= ln(2) / 2. 2^n is applied in two halves, so that
+//results that are subnormal floats are still exact:
+[[gnu::always_inline]] inline auto float_exp(float x) noexcept{
+  const auto clamped = clamp_bits(x, -104.f, 89.f);
+  const auto n = float(round_nearest(clamped * 1.44269504088896341f));
+  const auto r = (clamped - n * 0.693359375f) + n * 2.12194440e-4f;
+
+  const auto p = 1.f + r + r * r * (5.0000001201e-1f + r * (1.6666665459e-1f + r * (4.1665795894e-2f +
+    r * (8.3334519073e-3f + r * (1.3981999507e-3f + r * 1.9875691500e-4f)))));
+
+  const auto exponent = std::int32_t(n);
+  const auto half = exponent / 2;
+  const auto a = bits_float(std::uint32_t(half + 127) << 23);
+  const auto b = bits_float(std::uint32_t(exponent - half + 127) << 23);
+
+  return select_bits(x != x, x, p * a * b);
+}
+
+//x = 2^e * (1 + m), sqrt(1/2) <= 1 + m < sqrt(2), and log(1 + m) by a
+//polynomial (Cephes). Subnormals are scaled to normals first:
+[[gnu::always_inline]] inline auto float_log(float x) noexcept{
+  constexpr auto Infinity = std::numeric_limits<float>::infinity();
+
+  const auto subnormal = x < std::numeric_limits<float>::min();
+  const auto bits = float_bits(select_bits(subnormal, x * 8388608.f, x));
+
+  const auto biased = float(std::int32_t(bits >> 23) - 126 - 23 * std::int32_t(subnormal));
+  const auto fraction = bits_float((bits & 0x007fffffu) | 0x3f000000u);
+  const auto low = fraction < 0.707106781186547524f;
+
+  const auto e = select_bits(low, biased - 1.f, biased);
+  const auto m = select_bits(low, fraction + fraction, fraction) - 1.f;
+  const auto z = m * m;
+
+  auto y = m * z * (3.3333331174e-1f + m * (-2.4999993993e-1f + m * (2.0000714765e-1f + m * (-1.6668057665e-1f +
+    m * (1.4249322787e-1f + m * (-1.2420140846e-1f + m * (1.1676998740e-1f + m * (-1.1514610310e-1f +
+    m * 7.0376836292e-2f))))))));
+
+  y = y - 2.12194440e-4f * e - 0.5f * z;
+
+  auto result = (m + y) + 0.693359375f * e;
+  result = select_bits(x == 0.f, -Infinity, result);
+  result = select_bits(x == Infinity, Infinity, result);
+  return select_bits((x < 0.f) | (x != x), std::numeric_limits<float>::quiet_NaN(), result);
+}
+
+//atan of min(|x|, |y|) / max(|x|, |y|) (Cephes, in double for the division),
+//then reflected into the quadrant of (x, y):
+[[gnu::always_inline]] inline auto float_atan2(float y, float x) noexcept{
+  const auto ax = double(std::abs(x));
+  const auto ay = double(std::abs(y));
+  const auto greater = std::max(ax, ay);
+  const auto lesser = std::min(ax, ay);
+
+  //0 / 0 is 0, and infinity / infinity 1:
+  auto a = select_bits(greater == 0.0, 0.0, select_bits(greater == lesser, 1.0, lesser / std::max(greater, 1e-300)));
+  const auto reduced = a > 0.41421356237309505;
+  a = select_bits(reduced, (a - 1.0) / (a + 1.0), a);
+
+  const auto z = a * a;
+  auto angle = a + a * z * (-3.33329491539e-1 + z * (1.99777106478e-1 + z * (-1.38776856032e-1 + z * 8.05374449538e-2)));
+
+  angle = select_bits(reduced, angle + 0.78539816339744831, angle);
+  angle = select_bits(ay > ax, 1.57079632679489662 - angle, angle);
+  angle = select_bits((float_bits(x) >> 31) != 0, 3.14159265358979324 - angle, angle);
+
+  const auto result = select_bits((x != x) | (y != y), std::numeric_limits<float>::quiet_NaN(), float(angle));
+  return bits_float(float_bits(result) | (float_bits(y) & 0x80000000u));
+}
+
+//exp(y * log|x|) in double, which keeps a float result within 1 ULP where
+//float would lose |y * log|x|| ULP. Finite negative x give a result for integer y:
+[[gnu::always_inline]] inline auto float_pow(float x, float y) noexcept{
+  constexpr auto Infinity = std::numeric_limits<double>::infinity();
+  constexpr auto Integral = 16777216.f;
+
+  //log|x| = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172:
+  const auto ax = double(std::abs(x));
+  const auto bits = double_bits(ax);
+  const auto fraction = bits_double((bits & 0x000fffffffffffffull) | 0x3fe0000000000000ull);
+  const auto low = fraction < 0.70710678118654752;
+  const auto biased = double(std::int32_t(bits >> 52) - 1022);
+  const auto e = select_bits(low, biased - 1.0, biased);
+  const auto m = select_bits(low, fraction + fraction, fraction);
+
+  const auto s = (m - 1.0) / (m + 1.0);
+  const auto s2 = s * s;
+
+  auto log = 2.0 * s * (1.0 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9 +
+    s2 * (1.0 / 11 + s2 * (1.0 / 13 + s2 * (1.0 / 15)))))))) + e * 0.69314718055994531;
+
+  log = select_bits(ax == 0.0, -Infinity, select_bits(ax == Infinity, Infinity, log));
+
+  //e^t = 2^k * e^f, |f| <= ln(2) / 2; the range keeps 2^k a normal double:
+  const auto t = clamp_bits(select_bits(log == 0.0, 0.0, double(y) * log), -120.0, 100.0);
+  const auto k = round_nearest(t * 1.4426950408889634);
+  const auto f = (t - k * 6.93147180369123816490e-01) - k * 1.90821492927058770002e-10;
+
+  const auto p = 1.0 + f * (1.0 + f * (1.0 / 2 + f * (1.0 / 6 + f * (1.0 / 24 + f * (1.0 / 120 +
+    f * (1.0 / 720 + f * (1.0 / 5040 + f * (1.0 / 40320 + f * (1.0 / 362880)))))))));
+
+  auto result = float(p * bits_double(std::uint64_t(std::int32_t(k) + 1023) << 52));
+
+  //Floats of 2^24 and above are even integers, 0 stands in for them:
+  const auto small = select_bits(std::abs(y) < Integral, y, 0.f);
+  const auto half = small * 0.5f;
+  const auto integer = float(std::int32_t(small)) == small;
+  const auto odd = integer & (float(std::int32_t(half)) != half);
+
+  result = select_bits((x < 0.f) & odd, -result, result);
+  result = select_bits((x == 0.f) & odd, bits_float(float_bits(result) | (float_bits(x) & 0x80000000u)), result);
+  result = select_bits(((x < 0.f) & (x != -std::numeric_limits<float>::infinity()) & !integer) | (x != x) | (y != y), std::numeric_limits<float>::quiet_NaN(), result);
+  return select_bits((y == 0.f) | (x == 1.f), 1.f, result);
+}
+
+//The polynomials above, one element per step:
+template<float(*F)(float)>
+struct unary_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* x, float* result) const noexcept{
+    result[i] = F(x[i]);
+  }
+};
+
+template<float(*F)(float, float)>
+struct binary_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* a, const float* b, float* result) const noexcept{
+    result[i] = F(a[i], b[i]);
+  }
+};
+
+[[gnu::always_inline]] inline auto float_sin(float x) noexcept{
+  return float_sincos(x).first;
+}
+
+[[gnu::always_inline]] inline auto float_cos(float x) noexcept{
+  return float_sincos(x).second;
+}
+
+struct sincos_kernel{
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* x, float* sines, float* cosines) const noexcept{
+    const auto [s, c] = float_sincos(x[i]);
+    sines[i] = s;
+    cosines[i] = c;
+  }
+};
+
+struct pow_scalar_kernel{
+  float y;
+
+  [[gnu::always_inline]] inline auto step(std::size_t i, const float* x, float* result) const noexcept{
+    result[i] = float_pow(x[i], y);
+  }
+};
+
+//The std:: functions, for the levels where the polynomials don't vectorize:
+//the scalar level and, for atan2 and pow, which compute in double, sse2 (it
+//can't select between vectors of 64 bit integers). Per element std:: is faster:
+template<typename Callable>
+struct std_kernel{
+  Callable function;
+
+  auto step(std::size_t i, const float* x, float* result) const noexcept{
+    result[i] = function(x[i]);
+  }
+
+  auto step(std::size_t i, const float* a, const float* b, float* result) const noexcept{
+    result[i] = function(a[i], b[i]);
+  }
+
+  auto step(std::size_t i, const float* x, float* sines, float* cosines) const noexcept{
+    const auto [s, c] = function(x[i]);
+    sines[i] = s;
+    cosines[i] = c;
+  }
+};
+
+template<typename Callable>
+inline auto std_loop(Callable function) noexcept{
+  return std_kernel<Callable>{ function };
+}
+
+template<typename Kernel, typename Fallback, typename... P>
+inline auto dispatch_vectorized(isa minimum, const Kernel& kernel, const Fallback& fallback, std::size_t count, P*... arrays) noexcept{
+  if (selected_isa() < minimum) return run_scalar(fallback, count, arrays...);
+  return dispatch(kernel, count, arrays...);
+}
+
+//sin, cos and tan: the polynomials while every |x| < 2^22, where
+//reduce_half_pi() is exact enough, else std:: for the whole array, at every
+//level. Checked up front, since the results may overwrite x:
+template<typename Kernel, typename Fallback, typename... P>
+inline auto dispatch_angles(const Kernel& kernel, const Fallback& fallback, std::size_t count, const float* x, P*... results) noexcept{
+  auto large = std::uint32_t(0);
+  const auto packets = count / DispatchLanes;
+
+  //Packets of a known size, so that this vectorizes at -O2 too:
+  for (auto packet : range(packets)){
+    for (auto lane : range(DispatchLanes)){
+      large |= std::uint32_t(std::abs(x[packet * DispatchLanes + lane]) >= 4194304.f);
+    }
+  }
+
+  for (auto i : range(packets * DispatchLanes, count)){
+    large |= std::uint32_t(std::abs(x[i]) >= 4194304.f);
+  }
+
+  if (large != 0) return run_scalar(fallback, count, x, results...);
+  return dispatch_vectorized(isa::sse2, kernel, fallback, count, x, results...);
+}
+
+} //namespace detail
+
+//The level the CPU supports, detected once:
+inline auto supported_isa() noexcept{
+  static const auto level = detail::detect_isa();
+  return level;
+}
+
+inline auto active_isa() noexcept{
+  return detail::selected_isa();
+}
+
+//Selects the level of all kernels, for tests and benchmarks; levels above
+//supported_isa() are clamped to it. Returns the level now active. Not
+//synchronized with kernels running on other threads.
+inline auto force_isa(isa level) noexcept{
+  detail::selected_isa() = std::min(level, supported_isa());
+  return detail::selected_isa();
+}
+
+//result[i] = (transform * points[i].as_vec<4>(1)).xyz(), without the projective divide:
+template<typename L>
+inline auto transform_points(
+  const mat<float, 4, 4, L>& transform,
+  const vec<float, 3>* points,
+  std::size_t count,
+  vec<float, 3>* result
+) noexcept{
+  auto kernel = detail::transform_points_kernel();
+
+  for (auto [x, y] : range({ 4, 4 })){
+    kernel.m[x * 4 + y] = transform.at(x, y);
+  }
+
+  detail::dispatch(kernel, count, detail::components<float>(points), detail::components<float>(result));
+}
+
+//result[i] = transform * vectors[i]:
+template<typename L>
+inline auto transform(
+  const mat<float, 4, 4, L>& transform,
+  const vec<float, 4>* vectors,
+  std::size_t count,
+  vec<float, 4>* result
+) noexcept{
+  auto kernel = detail::transform_kernel();
+
+  for (auto [x, y] : range({ 4, 4 })){
+    kernel.m[x * 4 + y] = transform.at(x, y);
+  }
+
+  detail::dispatch(kernel, count, detail::components<float>(vectors), detail::components<float>(result));
+}
+
+//result[i] = dot(a[i], b[i]):
+inline auto dot(
+  const vec<float, 3>* a,
+  const vec<float, 3>* b,
+  std::size_t count,
+  float* result
+) noexcept{
+  detail::dispatch(detail::dot_kernel(), count, detail::components<float>(a), detail::components<float>(b), result);
+}
+
+//result[i] = vectors[i].normalized(). The square roots only vectorize with
+//-fno-math-errno:
+inline auto normalize(
+  const vec<float, 3>* vectors,
+  std::size_t count,
+  vec<float, 3>* result
+) noexcept{
+  detail::dispatch(detail::normalize_kernel(), count, detail::components<float>(vectors), detail::components<float>(result));
+}
+
+//result[i] = a[i] * b[i], column-major matrices:
+inline auto multiply(
+  const mat<float, 4, 4>* a,
+  const mat<float, 4, 4>* b,
+  std::size_t count,
+  mat<float, 4, 4>* result
+) noexcept{
+  detail::dispatch(
+    detail::multiply_kernel(), count,
+    detail::components<float>(a), detail::components<float>(b), detail::components<float>(result)
+  );
+}
+
+//visible[i] = overlaps(f, boxes[i]):
+inline auto cull(
+  const frustum<float>& f,
+  const aabb<float>* boxes,
+  std::size_t count,
+  std::uint8_t* visible
+) noexcept{
+  auto kernel = detail::cull_kernel();
+
+  for (auto p : range(6)){
+    kernel.nx[p] = f.planes[p].x;
+    kernel.ny[p] = f.planes[p].y;
+    kernel.nz[p] = f.planes[p].z;
+    kernel.w[p] = f.planes[p].w;
+  }
+
+  detail::dispatch(kernel, count, detail::components<float>(boxes), visible);
+}
+
+//Element by element sin, cos, tan, atan2, exp, log and pow of float arrays,
+//within 2 ULP at every level; pass the components of vectors as count * N
+//floats. Arrays holding a sin, cos or tan argument of |x| >= 2^22 (or
+//infinite) are computed one element at a time with std::, as at the scalar level.
+
+//result[i] = sin(x[i]):
+inline auto sin(const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_angles(
+    detail::unary_kernel<detail::float_sin>(),
+    detail::std_loop([](float e){ return std::sin(e); }), count, x, result
+  );
+}
+
+//result[i] = cos(x[i]):
+inline auto cos(const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_angles(
+    detail::unary_kernel<detail::float_cos>(),
+    detail::std_loop([](float e){ return std::cos(e); }), count, x, result
+  );
+}
+
+//sines[i] = sin(x[i]), cosines[i] = cos(x[i]), about the cost of either:
+inline auto sincos(const float* x, std::size_t count, float* sines, float* cosines) noexcept{
+  detail::dispatch_angles(
+    detail::sincos_kernel(),
+    detail::std_loop([](float e){ return std::pair(std::sin(e), std::cos(e)); }), count, x, sines, cosines
+  );
+}
+
+//result[i] = tan(x[i]):
+inline auto tan(const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_angles(
+    detail::unary_kernel<detail::float_tan>(),
+    detail::std_loop([](float e){ return std::tan(e); }), count, x, result
+  );
+}
+
+//result[i] = atan2(y[i], x[i]):
+inline auto atan2(const float* y, const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_vectorized(
+    isa::avx2, detail::binary_kernel<detail::float_atan2>(),
+    detail::std_loop([](float a, float b){ return std::atan2(a, b); }), count, y, x, result
+  );
+}
+
+//result[i] = exp(x[i]):
+inline auto exp(const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_vectorized(
+    isa::sse2, detail::unary_kernel<detail::float_exp>(),
+    detail::std_loop([](float e){ return std::exp(e); }), count, x, result
+  );
+}
+
+//result[i] = log(x[i]):
+inline auto log(const float* x, std::size_t count, float* result) noexcept{
+  detail::dispatch_vectorized(
+    isa::sse2, detail::unary_kernel<detail::float_log>(),
+    detail::std_loop([](float e){ return std::log(e); }), count, x, result
+  );
+}
+
+//result[i] = pow(x[i], y[i]):
+inline auto pow(const float* x, const float* y, std::size_t count, float* result) noexcept{
+  detail::dispatch_vectorized(
+    isa::avx2, detail::binary_kernel<detail::float_pow>(),
+    detail::std_loop([](float a, float b){ return std::pow(a, b); }), count, x, y, result
+  );
+}
+
+//result[i] = pow(x[i], y):
+inline auto pow(const float* x, float y, std::size_t count, float* result) noexcept{
+  detail::dispatch_vectorized(
+    isa::avx2, detail::pow_scalar_kernel{ y },
+    detail::std_loop([y](float e){ return std::pow(e, y); }), count, x, result
+  );
+}
+
+} //namespace gf::math
@@ -0,0 +1,95 @@
+//Batched kernels at every instruction set level the CPU supports, against
+//loops over the vec and mat operators.
+//Usage: batch [elements = 1000000]
+
+#include "../batch.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(1000000);
+
+  auto random = std::mt19937(9);
+  auto element = std::uniform_real_distribution<float>(-10.f, 10.f);
+
+  auto points = std::vector<m::vec3>(count);
+  auto matrices = std::vector<m::mat4>(count / 4);
+  auto boxes = std::vector<m::aabb<float>>(count);
+
+  for (auto i : m::range(count)){
+    points[i] = m::vec3(element(random), element(random), element(random));
+    boxes[i] = m::aabb<float>().extend(points[i]).extend(points[i] + m::vec3(1.f));
+  }
+
+  for (auto& a : matrices){
+    for (auto [x, y] : m::range({ 4, 4 })){
+      a[x][y] = element(random);
+    }
+  }
+
+  const auto transform = matrices[0];
+  const auto f = m::frustum<float>(m::mat4(
+    0.5f, 0.f, 0.f, 0.f,
+    0.f, 0.5f, 0.f, 0.f,
+    0.f, 0.f, 0.1f, 0.5f,
+    0.f, 0.f, 0.1f, 1.f
+  ));
+
+  auto transformed = std::vector<m::vec3>(count);
+  auto dots = std::vector<float>(count);
+  auto products = std::vector<m::mat4>(matrices.size());
+  auto visible = std::vector<std::uint8_t>(count);
+
+  auto stages = std::vector<samples>();
+
+  const auto run = [&](const std::string& suffix, auto transform_points, auto dot, auto normalize, auto multiply, auto cull){
+    auto s = std::vector<samples>{
+      { "points " + suffix, {} },
+      { "dot " + suffix, {} },
+      { "norm " + suffix, {} },
+      { "mat4 " + suffix, {} },
+      { "cull " + suffix, {} }
+    };
+
+    for (auto i = 0; i < 10; ++i){
+      measure(s[0], transform_points);
+      measure(s[1], dot);
+      measure(s[2], normalize);
+      measure(s[3], multiply);
+      measure(s[4], cull);
+
+      do_not_optimize(transformed.data());
+      do_not_optimize(dots.data());
+      do_not_optimize(products.data());
+      do_not_optimize(visible.data());
+    }
+
+    stages.insert(stages.end(), s.begin(), s.end());
+  };
+
+  run("ops",
+    [&]{ for (auto i : m::range(count)) transformed[i] = (transform * points[i].as_vec<4>(1.f)).xyz(); },
+    [&]{ for (auto i : m::range(count - 1)) dots[i] = m::dot(points[i], points[i + 1]); },
+    [&]{ for (auto i : m::range(count)) transformed[i] = points[i].normalized(); },
+    [&]{ for (auto i : m::range(matrices.size() - 1)) products[i] = matrices[i] * matrices[i + 1]; },
+    [&]{ for (auto i : m::range(count)) visible[i] = m::overlaps(f, boxes[i]); }
+  );
+
+  for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+    if (m::force_isa(level) != level) continue;
+
+    run(m::isa_name(level),
+      [&]{ m::transform_points(transform, points.data(), count, transformed.data()); },
+      [&]{ m::dot(points.data(), points.data() + 1, count - 1, dots.data()); },
+      [&]{ m::normalize(points.data(), count, transformed.data()); },
+      [&]{ m::multiply(matrices.data(), matrices.data() + 1, matrices.size() - 1, products.data()); },
+      [&]{ m::cull(f, boxes.data(), count, visible.data()); }
+    );
+  }
+
+  std::cout << count << " elements, " << matrices.size() << " matrices, supported: " << m::isa_name(m::supported_isa()) << '\n';
+  report(stages);
+}
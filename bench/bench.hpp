@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+//Collected durations (in milliseconds) of a single measured stage:
+struct samples{
+  std::string name;
+  std::vector<double> values;
+
+  auto add(bench_clock::duration duration){
+    values.push_back(std::chrono::duration<double, std::milli>(duration).count());
+  }
+
+  auto percentile(double p) const{
+    if (values.empty()) return 0.0;
+
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto index = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+  }
+
+  auto min() const{ return percentile(0.0); }
+  auto median() const{ return percentile(0.5); }
+  auto p99() const{ return percentile(0.99); }
+};
+
+template<typename Callable>
+inline auto measure(samples& s, Callable callable){
+  const auto start = bench_clock::now();
+  callable();
+  s.add(bench_clock::now() - start);
+}
+
+//Runs the callable `iterations` times and returns elapsed seconds:
+template<typename Callable>
+inline auto time_seconds(std::size_t iterations, Callable callable){
+  const auto start = bench_clock::now();
+
+  for (std::size_t i = 0; i < iterations; ++i){
+    callable();
+  }
+
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+//Keeps the optimizer from discarding benchmarked results:
+template<typename T>
+inline auto do_not_optimize(const T& value){
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline auto report(const std::vector<samples>& stages){
+  std::cout
+    << std::left << std::setw(12) << "stage"
+    << std::right << std::setw(12) << "min ms"
+    << std::setw(12) << "median ms"
+    << std::setw(12) << "p99 ms" << '\n';
+
+  for (const auto& s : stages){
+    std::cout
+      << std::left << std::setw(12) << s.name
+      << std::right << std::fixed << std::setprecision(4)
+      << std::setw(12) << s.min()
+      << std::setw(12) << s.median()
+      << std::setw(12) << s.p99() << '\n';
+  }
+}
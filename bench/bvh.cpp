@@ -0,0 +1,75 @@
+//BVH build times across thread counts and traversal throughput.
+//Usage: bvh [triangles = 200000] [rays = 200000]
+
+#include "../bvh.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+template<typename Tree>
+auto bench_rays(const char* name, const Tree& tree, const std::vector<m::fray>& rays){
+  auto hits = std::size_t(0);
+
+  const auto seconds = time_seconds(1, [&]{
+    for (const auto& r : rays){
+      hits += tree.intersect(r).hit();
+    }
+  });
+
+  std::cout << name << ": " << rays.size() / seconds / 1e6 << " Mrays/s (" << hits << " hits)\n";
+}
+
+auto main(int argc, char** argv) -> int{
+  const auto triangles = argc > 1 ? std::atoi(argv[1]) : 200000;
+  const auto ray_count = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+  auto random = std::mt19937(1234);
+  auto position = std::uniform_real_distribution<float>(-50.f, 50.f);
+  auto offset = std::uniform_real_distribution<float>(-1.f, 1.f);
+
+  auto vertices = std::vector<m::vec3>();
+
+  for (auto i = 0; i < triangles; ++i){
+    const auto center = m::vec3(position(random), position(random), position(random));
+
+    for (auto j = 0; j < 3; ++j){
+      vertices.push_back(center + m::vec3(offset(random), offset(random), offset(random)));
+    }
+  }
+
+  auto rays = std::vector<m::fray>();
+
+  for (auto i = 0; i < ray_count; ++i){
+    const auto origin = m::vec3(position(random), position(random), -100.f);
+    const auto target = m::vec3(position(random), position(random), position(random));
+
+    rays.push_back(m::fray{ origin, (target - origin).normalized() });
+  }
+
+  for (auto threads = std::size_t(1); threads < m::hardware_threads() * 2; threads *= 2){
+    auto build = samples{ "build", {} };
+
+    for (auto i = 0; i < 5; ++i){
+      measure(build, [&]{ do_not_optimize(m::bvh<float>(vertices, {}, threads).nodes.size()); });
+    }
+
+    std::cout << "build with " << threads << " threads: " << build.median() << " ms\n";
+  }
+
+  auto tree = m::bvh<float>(vertices);
+  std::cout << tree.nodes.size() << " nodes, " << tree.leaves.size() << " leaves\n";
+
+  auto refit = samples{ "refit", {} };
+  measure(refit, [&]{ tree.refit(vertices); });
+  std::cout << "refit: " << refit.median() << " ms\n";
+
+  auto collapse = samples{ "collapse", {} };
+  auto tree4 = m::bvh4<float>();
+  measure(collapse, [&]{ tree4 = m::bvh4<float>(tree); });
+  std::cout << "bvh4 collapse: " << collapse.median() << " ms\n";
+
+  bench_rays("bvh", tree, rays);
+  bench_rays("bvh4", tree4, rays);
+}
@@ -0,0 +1,60 @@
+//Build time of translation units that include math.hpp: as they are, with
+//the standard aliases declared extern (their members compiled once, in
+//math.cpp) and with math.hpp precompiled. Run from the repository root.
+//Usage: compile [compiler = c++] [flags = "-std=c++17 -O0"] [sources = test/vec.cpp test/matrix.cpp]
+
+#include "bench.hpp"
+#include <cstdlib>
+#include <filesystem>
+
+auto main(int argc, char** argv) -> int{
+  const auto compiler = std::string(argc > 1 ? argv[1] : "c++");
+  const auto flags = std::string(argc > 2 ? argv[2] : "-std=c++17 -O0");
+
+  auto sources = std::vector<std::string>(argv + std::min(argc, 3), argv + argc);
+  if (sources.empty()) sources = { "test/vec.cpp", "test/matrix.cpp" };
+
+  const auto directory = std::filesystem::temp_directory_path() / "gf_math_compile";
+  std::filesystem::create_directories(directory);
+
+  const auto object = (directory / "unit.o").string();
+  const auto header = (directory / "math.hpp").string();
+
+  auto failed = false;
+
+  const auto run = [&](const std::string& command){
+    if (std::system((command + " > " + (directory / "log").string() + " 2>&1").c_str()) != 0){
+      std::cerr << "failed: " << command << '\n';
+      failed = true;
+    }
+  };
+
+  const auto compile = [&](const std::string& extra){
+    return [&, extra]{
+      for (const auto& source : sources){
+        run(compiler + ' ' + flags + extra + " -c " + source + " -o " + object);
+      }
+    };
+  };
+
+  auto stages = std::vector<samples>{
+    { "math.cpp", {} },
+    { "pch build", {} },
+    { "header", {} },
+    { "extern", {} },
+    { "pch", {} }
+  };
+
+  for (auto i = 0; i < 5 && !failed; ++i){
+    measure(stages[0], [&]{ run(compiler + ' ' + flags + " -c math.cpp -o " + object); });
+    measure(stages[1], [&]{ run(compiler + ' ' + flags + " -x c++-header math.hpp -o " + header + ".gch"); });
+    measure(stages[2], compile(""));
+    measure(stages[3], compile(" -DGEFEC_MATH_EXTERN_TEMPLATES"));
+    measure(stages[4], compile(" -Winvalid-pch -include " + header));
+  }
+
+  if (failed) return 1;
+
+  std::cout << sources.size() << " translation units, " << compiler << ' ' << flags << '\n';
+  report(stages);
+}
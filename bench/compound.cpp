@@ -0,0 +1,63 @@
+//Compound assignment against the equivalent binary expression: an explicit
+//Euler integrator over vec3 particles and accumulated 4x4 transforms.
+//Usage: compound [particles = 1000000]
+
+#include "../math.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(1000000);
+  const auto dt = 1.f / 60.f;
+
+  auto positions = std::vector<m::vec3>(count);
+  auto velocities = std::vector<m::vec3>(count);
+
+  for (auto i : m::range(count)){
+    velocities[i] = m::vec3(float(i % 7), -1.f, float(i % 3)) * 0.1f;
+  }
+
+  const auto step = m::rotation(0.01f, m::vec3(0.f, 1.f, 0.f)) * m::translation(m::vec3(0.1f, 0.f, 0.f));
+  auto transforms = std::vector<m::mat4>(count / 16, m::mat4(1.f));
+
+  auto binary = samples{ "p = p + v", {} };
+  auto compound = samples{ "p += v", {} };
+  auto binary_mat = samples{ "t = t * s", {} };
+  auto compound_mat = samples{ "t *= s", {} };
+
+  for (auto frame = 0; frame < 20; ++frame){
+    measure(binary, [&]{
+      for (auto i : m::range(count)){
+        velocities[i] = velocities[i] + m::vec3(0.f, -9.81f, 0.f) * dt;
+        positions[i] = positions[i] + velocities[i] * dt;
+      }
+    });
+
+    measure(compound, [&]{
+      for (auto i : m::range(count)){
+        velocities[i] += m::vec3(0.f, -9.81f, 0.f) * dt;
+        positions[i] += velocities[i] * dt;
+      }
+    });
+
+    measure(binary_mat, [&]{
+      for (auto& transform : transforms){
+        transform = transform * step;
+      }
+    });
+
+    measure(compound_mat, [&]{
+      for (auto& transform : transforms){
+        transform *= step;
+      }
+    });
+
+    do_not_optimize(positions.data());
+    do_not_optimize(transforms.data());
+  }
+
+  std::cout << count << " particles, " << transforms.size() << " transforms\n";
+  report({ binary, compound, binary_mat, compound_mat });
+}
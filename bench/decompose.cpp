@@ -0,0 +1,73 @@
+//3x3 decomposition throughput: one matrix at a time against the packet
+//versions running DecomposeWidth lanes at once.
+//Usage: decompose [matrices = 100000]
+
+#include "../decompose.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(100000);
+
+  auto random = std::mt19937(3);
+  auto element = std::uniform_real_distribution<float>(-1.f, 1.f);
+  auto matrices = std::vector<m::mat3>(count);
+
+  for (auto& a : matrices){
+    for (auto [x, y] : m::range({ 3, 3 })){
+      a[x][y] = element(random);
+    }
+  }
+
+  auto covariances = std::vector<m::mat3>(count);
+  for (auto i : m::range(count)){
+    covariances[i] = matrices[i] * matrices[i].t();
+  }
+
+  auto eigens = std::vector<m::eigen3<float>>(count);
+  auto svds = std::vector<m::svd3<float>>(count);
+  auto polars = std::vector<m::polar3<float>>(count);
+
+  auto eigen_single = samples{ "eigen_sym", {} };
+  auto eigen_packet = samples{ "eigen x8", {} };
+  auto svd_single = samples{ "svd", {} };
+  auto svd_packet = samples{ "svd x8", {} };
+  auto polar_single = samples{ "polar", {} };
+  auto polar_packet = samples{ "polar x8", {} };
+
+  for (auto i = 0; i < 10; ++i){
+    measure(eigen_single, [&]{
+      for (auto j : m::range(count)) eigens[j] = m::eigen_sym(covariances[j]);
+    });
+
+    measure(eigen_packet, [&]{
+      m::eigen_sym(covariances.data(), count, eigens.data());
+    });
+
+    measure(svd_single, [&]{
+      for (auto j : m::range(count)) svds[j] = m::svd(matrices[j]);
+    });
+
+    measure(svd_packet, [&]{
+      m::svd(matrices.data(), count, svds.data());
+    });
+
+    measure(polar_single, [&]{
+      for (auto j : m::range(count)) polars[j] = m::polar(matrices[j]);
+    });
+
+    measure(polar_packet, [&]{
+      m::polar(matrices.data(), count, polars.data());
+    });
+
+    do_not_optimize(eigens.data());
+    do_not_optimize(svds.data());
+    do_not_optimize(polars.data());
+  }
+
+  std::cout << count << " matrices\n";
+  report({ eigen_single, eigen_packet, svd_single, svd_packet, polar_single, polar_packet });
+}
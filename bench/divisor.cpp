@@ -0,0 +1,67 @@
+//Batched ivec3 division by a runtime value: hardware idiv against divisor<int32_t>.
+//Usage: divisor [vectors = 1000000] [divisor = 7]
+
+#include "../divisor.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const auto value = argc > 2 ? std::atoi(argv[2]) : 7;
+
+  auto random = std::mt19937(1234);
+  auto values = std::vector<m::ivec3>(count);
+
+  for (auto& v : values){
+    v = m::ivec3(
+      static_cast<std::int32_t>(random()),
+      static_cast<std::int32_t>(random()),
+      static_cast<std::int32_t>(random())
+    );
+  }
+
+  auto quotients = std::vector<m::ivec3>(count);
+
+  const auto d = m::divisor<std::int32_t>(value);
+
+  auto idiv = samples{ "idiv", {} };
+  auto scalar = samples{ "divisor", {} };
+  auto batched = samples{ "batched", {} };
+  auto power_of_two = samples{ "batched, 1024", {} };
+
+  const auto shift = m::divisor<std::int32_t>(1024);
+
+  for (auto i = 0; i < 20; ++i){
+    measure(idiv, [&]{
+      for (auto j : m::range(values.size())){
+        quotients[j] = values[j] / value;
+      }
+
+      do_not_optimize(quotients.data());
+    });
+
+    measure(scalar, [&]{
+      for (auto j : m::range(values.size())){
+        quotients[j] = values[j] / d;
+      }
+
+      do_not_optimize(quotients.data());
+    });
+
+    measure(batched, [&]{
+      m::detail::divide_batch(values, d, quotients);
+      do_not_optimize(quotients.data());
+    });
+
+    measure(power_of_two, [&]{
+      m::detail::divide_batch(values, shift, quotients);
+      do_not_optimize(quotients.data());
+    });
+  }
+
+  std::cout << count << " ivec3 divided by " << value << '\n';
+  report({ idiv, scalar, batched, power_of_two });
+}
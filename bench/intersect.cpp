@@ -0,0 +1,118 @@
+//Throughput of the batched ray-triangle and ray-box kernels.
+//Usage: intersect [triangles = 1024] [rays = 4096]
+
+#include "../intersect.hpp"
+#include "bench.hpp"
+#include <bitset>
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+template<std::size_t W>
+auto bench_triangles(
+  const std::vector<m::vec3>& vertices,
+  const std::vector<m::fray>& rays
+){
+  const auto count = vertices.size() / 3;
+  auto packets = std::vector<m::triangle_packet<float, W>>((count + W - 1) / W);
+
+  //Padding lanes are degenerate triangles, which never report a hit:
+  for (auto i : m::range(count)){
+    packets[i / W].set(i % W, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+  }
+
+  auto hits = std::size_t(0);
+
+  const auto seconds = time_seconds(1, [&]{
+    for (const auto& r : rays){
+      auto nearest = std::numeric_limits<float>::infinity();
+
+      for (const auto& packet : packets){
+        const auto result = m::intersect(r, packet, 0.f, nearest);
+        const auto lane = result.nearest();
+
+        if (lane != W) nearest = result.t[lane];
+      }
+
+      hits += nearest != std::numeric_limits<float>::infinity();
+    }
+  });
+
+  std::cout 
+    << "ray-triangle W=" << W << ": "
+    << rays.size() / seconds / 1e6 << " Mrays/s, "
+    << rays.size() * count / seconds / 1e6 << " Mtests/s ("
+    << hits << " hits)\n";
+}
+
+template<std::size_t W>
+auto bench_boxes(
+  const std::vector<m::vec3>& vertices,
+  const std::vector<m::fray>& rays
+){
+  const auto count = vertices.size() / 3;
+  auto packets = std::vector<m::box_packet<float, W>>((count + W - 1) / W);
+
+  for (auto i : m::range(count)){
+    const auto lo = m::min(m::min(vertices[i * 3], vertices[i * 3 + 1]), vertices[i * 3 + 2]);
+    const auto hi = m::max(m::max(vertices[i * 3], vertices[i * 3 + 1]), vertices[i * 3 + 2]);
+    packets[i / W].set(i % W, lo, hi);
+  }
+
+  auto hits = std::size_t(0);
+
+  const auto seconds = time_seconds(1, [&]{
+    for (const auto& r : rays){
+      for (auto p : m::range(packets.size())){
+        //Padding lanes of the last packet are masked out:
+        const auto lanes = std::min(W, count - p * W);
+        const auto valid = lanes == 32 ? ~0u : (1u << lanes) - 1;
+
+        hits += std::bitset<32>(m::intersect(r, packets[p]).mask & valid).count();
+      }
+    }
+  });
+
+  std::cout 
+    << "ray-box W=" << W << ": "
+    << rays.size() / seconds / 1e6 << " Mrays/s, "
+    << rays.size() * count / seconds / 1e6 << " Mtests/s ("
+    << hits << " hits)\n";
+}
+
+auto main(int argc, char** argv) -> int{
+  const auto triangles = argc > 1 ? std::atoi(argv[1]) : 1024;
+  const auto ray_count = argc > 2 ? std::atoi(argv[2]) : 4096;
+
+  auto random = std::mt19937(1234);
+  auto position = std::uniform_real_distribution<float>(-10.f, 10.f);
+  auto offset = std::uniform_real_distribution<float>(-0.5f, 0.5f);
+
+  auto vertices = std::vector<m::vec3>();
+
+  for (auto i = 0; i < triangles; ++i){
+    const auto center = m::vec3(position(random), position(random), position(random));
+
+    for (auto j = 0; j < 3; ++j){
+      vertices.push_back(center + m::vec3(offset(random), offset(random), offset(random)));
+    }
+  }
+
+  auto rays = std::vector<m::fray>();
+
+  for (auto i = 0; i < ray_count; ++i){
+    const auto target = m::vec3(position(random), position(random), position(random));
+    const auto origin = m::vec3(0.f, 0.f, -30.f);
+
+    rays.push_back(m::fray{ origin, (target - origin).normalized() });
+  }
+
+  bench_triangles<1>(vertices, rays);
+  bench_triangles<4>(vertices, rays);
+  bench_triangles<8>(vertices, rays);
+
+  bench_boxes<1>(vertices, rays);
+  bench_boxes<4>(vertices, rays);
+  bench_boxes<8>(vertices, rays);
+}
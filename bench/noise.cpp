@@ -0,0 +1,85 @@
+//Noise grids: a loop over range({ W, H }) calling perlin() and simplex(),
+//noise_grid() on one thread at every instruction set level the CPU supports,
+//and noise_grid() on every thread, in millions of samples per second.
+//Usage: noise [grid size = 1024] [fbm octaves = 6]
+
+#include "../noise.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto size = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(1024);
+  const auto octaves = argc > 2 ? std::size_t(std::atoll(argv[2])) : std::size_t(6);
+
+  constexpr auto Spacing = 0.01f;
+
+  auto result = std::vector<float>(size * size);
+  auto stages = std::vector<samples>();
+
+  const auto run = [&](const std::string& name, auto noise, auto origin, std::size_t count){
+    const auto settings = m::fbm_settings<float>{ count };
+
+    auto loop = samples{ name + " loop", {} };
+
+    for (auto i = 0; i < 5; ++i){
+      measure(loop, [&]{
+        for (auto [x, y] : m::range({ size, size })){
+          auto offset = decltype(origin)();
+          offset[0] = float(x);
+          offset[1] = float(y);
+          result[y * size + x] = m::fbm(noise, origin + offset * Spacing, settings);
+        }
+      });
+
+      do_not_optimize(result.data());
+    }
+
+    stages.push_back(loop);
+
+    for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+      if (m::force_isa(level) != level) continue;
+
+      auto grid = samples{ name + " " + m::isa_name(level), {} };
+
+      for (auto i = 0; i < 5; ++i){
+        measure(grid, [&]{ m::noise_grid(noise, origin, Spacing, size, size, result.data(), settings, 1); });
+        do_not_optimize(result.data());
+      }
+
+      stages.push_back(grid);
+    }
+
+    auto threaded = samples{ name + " " + m::isa_name(m::active_isa()) + " x" + std::to_string(m::hardware_threads()), {} };
+
+    for (auto i = 0; i < 5; ++i){
+      measure(threaded, [&]{ m::noise_grid(noise, origin, Spacing, size, size, result.data(), settings); });
+      do_not_optimize(result.data());
+    }
+
+    stages.push_back(threaded);
+  };
+
+  run("perlin2", m::perlin_noise(), m::vec2(0.f), 1);
+  run("simplex2", m::simplex_noise(), m::vec2(0.f), 1);
+  run("perlin3", m::perlin_noise(), m::vec3(0.f), 1);
+  run("simplex3", m::simplex_noise(), m::vec3(0.f), 1);
+  run("simplex4", m::simplex_noise(), m::vec4(0.f), 1);
+  run("fbm" + std::to_string(octaves), m::simplex_noise(), m::vec2(0.f), octaves);
+
+  std::cout << size << " x " << size << " samples, supported: " << m::isa_name(m::supported_isa()) << '\n';
+
+  std::cout
+    << std::left << std::setw(24) << "stage"
+    << std::right << std::setw(12) << "median ms"
+    << std::setw(16) << "Msamples/s" << '\n';
+
+  for (const auto& s : stages){
+    std::cout
+      << std::left << std::setw(24) << s.name
+      << std::right << std::fixed << std::setprecision(2)
+      << std::setw(12) << s.median()
+      << std::setw(16) << double(size * size) / s.median() / 1000.0 << '\n';
+  }
+}
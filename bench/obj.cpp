@@ -0,0 +1,103 @@
+//OBJ loading throughput on a generated sphere: istream parsing against
+//load_obj on one thread and on every hardware thread.
+//Usage: obj [subdivisions = 1000] (2 * subdivisions^2 triangles)
+
+#include "../obj.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace m = gf::math;
+
+auto sphere_obj(int subdivisions){
+  auto out = std::ostringstream();
+  out << std::setprecision(9);
+
+  for (auto [u, v] : m::range({ subdivisions + 1, subdivisions + 1 })){
+    const auto theta = float(m::pi * 2.0) * u / subdivisions;
+    const auto phi = float(m::pi) * v / subdivisions;
+    const auto n = m::vec3(std::cos(theta) * std::sin(phi), std::cos(phi), std::sin(theta) * std::sin(phi));
+
+    out << "v " << n.x << ' ' << n.y << ' ' << n.z << '\n';
+    out << "vn " << n.x << ' ' << n.y << ' ' << n.z << '\n';
+  }
+
+  for (auto [u, v] : m::range({ subdivisions, subdivisions })){
+    const auto corner = [&](int du, int dv){
+      const auto index = (v + dv) * (subdivisions + 1) + (u + du) + 1;
+      return std::to_string(index) + "//" + std::to_string(index);
+    };
+
+    out << "f " << corner(0, 0) << ' ' << corner(1, 0) << ' ' << corner(1, 1) << '\n';
+    out << "f " << corner(0, 0) << ' ' << corner(1, 1) << ' ' << corner(0, 1) << '\n';
+  }
+
+  return out.str();
+}
+
+//What loading looked like without obj.hpp:
+auto load_istream(const std::string& path){
+  auto file = std::ifstream(path);
+  auto result = m::mesh();
+  auto line = std::string();
+
+  while (std::getline(file, line)){
+    auto in = std::istringstream(line);
+    auto keyword = std::string();
+    in >> keyword;
+
+    if (keyword == "v" || keyword == "vn"){
+      auto v = m::vec3();
+      in >> v.x >> v.y >> v.z;
+      (keyword == "v" ? result.positions : result.normals).push_back(v);
+    }
+    else if (keyword == "f"){
+      auto corner = std::string();
+
+      while (in >> corner){
+        result.indices.push_back(static_cast<std::uint32_t>(std::stoul(corner) - 1));
+      }
+    }
+  }
+
+  return result;
+}
+
+auto main(int argc, char** argv) -> int{
+  const auto subdivisions = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  const auto path = (std::filesystem::temp_directory_path() / "gf_math_sphere.obj").string();
+  std::ofstream(path) << sphere_obj(subdivisions);
+
+  auto stream = samples{ "istream", {} };
+  auto serial = samples{ "load_obj, 1 thread", {} };
+  auto parallel = samples{ "load_obj", {} };
+
+  auto mesh = m::mesh();
+
+  for (auto i = 0; i < 5; ++i){
+    measure(stream, [&]{
+      do_not_optimize(load_istream(path).indices.size());
+    });
+
+    measure(serial, [&]{
+      m::load_obj(path.c_str(), mesh, 1);
+      do_not_optimize(mesh.indices.data());
+    });
+
+    measure(parallel, [&]{
+      m::load_obj(path.c_str(), mesh);
+      do_not_optimize(mesh.indices.data());
+    });
+  }
+
+  std::cout
+    << mesh.triangle_count() << " triangles, "
+    << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MiB, "
+    << m::hardware_threads() << " threads\n";
+
+  report({ stream, serial, parallel });
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,62 @@
+//Bulk pack/unpack throughput and a streaming transform pass over float and half positions.
+//Usage: packed [vertices = 1000000]
+
+#include "../packed.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+template<typename T>
+auto transform_pass(const std::vector<m::vec<T, 3>>& positions, const m::mat4& transform){
+  auto sum = 0.f;
+
+  for (const auto& p : positions){
+    const auto x = float(p.x), y = float(p.y), z = float(p.z);
+
+    //Only the projected x, enough to keep the pass from being optimized away:
+    sum += transform[0][0] * x + transform[1][0] * y + transform[2][0] * z + transform[3][0];
+  }
+
+  return sum;
+}
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  auto random = std::mt19937(1234);
+  auto coordinate = std::uniform_real_distribution<float>(-1.f, 1.f);
+
+  auto positions = std::vector<m::vec3>(count);
+  auto colors = std::vector<m::vec4>(count);
+
+  for (auto i = 0; i < count; ++i){
+    positions[i] = m::vec3(coordinate(random), coordinate(random), coordinate(random));
+    colors[i] = m::abs(m::vec4(coordinate(random), coordinate(random), coordinate(random), 1.f));
+  }
+
+  const auto halves = m::pack<m::half>(positions);
+  const auto transform = m::translation(m::vec3(1.f, 2.f, 3.f)) * m::scale(m::vec3(2.f));
+
+  auto pack_half = samples{ "pack half", {} };
+  auto unpack_half = samples{ "unpack half", {} };
+  auto pack_unorm8 = samples{ "pack unorm8", {} };
+  auto pack_rgb10a2 = samples{ "pack rgb10a2", {} };
+  auto pack_normals = samples{ "pack normals", {} };
+  auto float_pass = samples{ "pass vec3", {} };
+  auto half_pass = samples{ "pass hvec3", {} };
+
+  for (auto i = 0; i < 10; ++i){
+    measure(pack_half, [&]{ do_not_optimize(m::pack<m::half>(positions).data()); });
+    measure(unpack_half, [&]{ do_not_optimize(m::unpack(halves).data()); });
+    measure(pack_unorm8, [&]{ do_not_optimize(m::pack<m::unorm8>(colors).data()); });
+    measure(pack_rgb10a2, [&]{ do_not_optimize(m::pack_rgb10a2(colors).data()); });
+    measure(pack_normals, [&]{ do_not_optimize(m::pack_normals(positions).data()); });
+    measure(float_pass, [&]{ do_not_optimize(transform_pass(positions, transform)); });
+    measure(half_pass, [&]{ do_not_optimize(transform_pass(halves, transform)); });
+  }
+
+  std::cout << count << " vertices, " << sizeof(m::vec3) << " vs " << sizeof(m::hvec3) << " bytes each\n";
+  report({ pack_half, unpack_half, pack_unorm8, pack_rgb10a2, pack_normals, float_pass, half_pass });
+}
@@ -0,0 +1,73 @@
+//Block sparse matrix-vector products and PCG across thread counts, on a
+//3x3 block 7 point stencil over a cubic grid (an elastic solid's layout).
+//Usage: sparse [grid size = 48] [pcg iterations = 50]
+
+#include "../sparse.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto size = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(48);
+  const auto iterations = argc > 2 ? std::size_t(std::atoll(argv[2])) : std::size_t(50);
+
+  const auto node = [&](std::size_t x, std::size_t y, std::size_t z){
+    return static_cast<std::uint32_t>((z * size + y) * size + x);
+  };
+
+  const auto coupling = m::mat3(
+    1.f, 0.1f, 0.f,
+    0.1f, 1.f, 0.1f,
+    0.f, 0.1f, 1.f
+  );
+  auto triplets = std::vector<m::sparse_triplet<m::mat3>>();
+
+  for (auto [x, y] : m::range({ size, size })){
+    for (auto z : m::range(size)){
+      const auto i = node(x, y, z);
+
+      triplets.push_back({ i, i, 6.5f * coupling });
+      if (x > 0) triplets.push_back({ i, node(x - 1, y, z), -1.f * coupling });
+      if (y > 0) triplets.push_back({ i, node(x, y - 1, z), -1.f * coupling });
+      if (z > 0) triplets.push_back({ i, node(x, y, z - 1), -1.f * coupling });
+      if (x + 1 < size) triplets.push_back({ i, node(x + 1, y, z), -1.f * coupling });
+      if (y + 1 < size) triplets.push_back({ i, node(x, y + 1, z), -1.f * coupling });
+      if (z + 1 < size) triplets.push_back({ i, node(x, y, z + 1), -1.f * coupling });
+    }
+  }
+
+  const auto rows = size * size * size;
+
+  auto assembly = samples{ "assembly", {} };
+  auto a = m::bsr_matrix<float, 3>();
+  measure(assembly, [&]{ a = m::bsr_matrix<float, 3>(rows, rows, triplets); });
+
+  std::cout
+    << rows << " block rows, " << a.nonzeros() << " blocks, assembly "
+    << assembly.median() << " ms\n";
+
+  const auto b = std::vector<m::vec3>(rows, m::vec3(1.f, 0.f, -1.f));
+  auto y = std::vector<m::vec3>();
+
+  for (auto threads = std::size_t(1); threads < m::hardware_threads() * 2; threads *= 2){
+    auto spmv = samples{ "spmv", {} };
+    auto pcg = samples{ "pcg", {} };
+
+    for (auto i = 0; i < 20; ++i){
+      measure(spmv, [&]{ a.multiply(b, y, threads); });
+      do_not_optimize(y.data());
+    }
+
+    for (auto i = 0; i < 3; ++i){
+      auto x = std::vector<m::vec3>();
+
+      measure(pcg, [&]{ m::pcg(a, b, x, { iterations, 0.f }, threads); });
+      do_not_optimize(x.data());
+    }
+
+    std::cout
+      << threads << " threads: spmv " << spmv.median() << " ms, pcg x"
+      << iterations << ' ' << pcg.median() << " ms\n";
+  }
+}
@@ -0,0 +1,65 @@
+//Per-frame spatial_hash rebuild and radius query times.
+//Usage: spatial_hash [objects = 100000] [frames = 20]
+
+#include "../spatial_hash.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::atoi(argv[1]) : 100000;
+  const auto frames = argc > 2 ? std::atoi(argv[2]) : 20;
+
+  auto random = std::mt19937(1234);
+  auto position = std::uniform_real_distribution<float>(-500.f, 500.f);
+  auto velocity = std::uniform_real_distribution<float>(-1.f, 1.f);
+
+  auto positions = std::vector<m::vec3>();
+  auto velocities = std::vector<m::vec3>();
+
+  for (auto i = 0; i < count; ++i){
+    positions.push_back(m::vec3(position(random), position(random), position(random)));
+    velocities.push_back(m::vec3(velocity(random), velocity(random), velocity(random)));
+  }
+
+  auto grid = m::spatial_hash3<float>(8.f);
+
+  auto rebuild = samples{ "rebuild", {} };
+  auto query = samples{ "query 1k", {} };
+  auto insert = samples{ "insert all", {} };
+
+  for (auto frame = 0; frame < frames; ++frame){
+    for (auto i = 0; i < count; ++i){
+      positions[i].x += velocities[i].x;
+      positions[i].y += velocities[i].y;
+      positions[i].z += velocities[i].z;
+    }
+
+    measure(rebuild, [&]{ grid.rebuild(positions); });
+
+    measure(query, [&]{
+      auto found = std::size_t(0);
+
+      for (auto i = 0; i < 1000; ++i){
+        grid.query(positions[i], 8.f, [&](std::uint32_t, const m::vec3&){ ++found; });
+      }
+
+      do_not_optimize(found);
+    });
+  }
+
+  for (auto frame = 0; frame < 3; ++frame){
+    grid.clear();
+
+    measure(insert, [&]{
+      for (auto i = 0; i < count; ++i){
+        grid.insert(static_cast<std::uint32_t>(i), positions[i]);
+      }
+    });
+  }
+
+  std::cout << count << " objects, " << grid.cell_count() << " cells\n";
+  report({ rebuild, query, insert });
+}
@@ -0,0 +1,67 @@
+//Text import/export of vec3 point clouds: iostreams against to_chars/from_chars.
+//Usage: text [points = 1000000]
+
+#include "../text.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  auto random = std::mt19937(1234);
+  auto coordinate = std::uniform_real_distribution<float>(-1000.f, 1000.f);
+
+  auto points = std::vector<m::vec3>(count);
+  for (auto& p : points){
+    p = m::vec3(coordinate(random), coordinate(random), coordinate(random));
+  }
+
+  const auto text = m::format_array(points);
+
+  auto stream_format = samples{ "ostream <<", {} };
+  auto chars_format = samples{ "format_array", {} };
+  auto stream_parse = samples{ "istream >>", {} };
+  auto chars_parse = samples{ "parse_array", {} };
+
+  for (auto i = 0; i < 10; ++i){
+    measure(stream_format, [&]{
+      auto out = std::ostringstream();
+      out << std::setprecision(9);
+
+      for (const auto& p : points){
+        out << p.x << ' ' << p.y << ' ' << p.z << '\n';
+      }
+
+      do_not_optimize(out.str().size());
+    });
+
+    measure(chars_format, [&]{
+      const auto formatted = m::format_array(points);
+      do_not_optimize(formatted.data());
+    });
+
+    measure(stream_parse, [&]{
+      auto in = std::istringstream(text);
+      auto parsed = std::vector<m::vec3>();
+      auto p = m::vec3();
+
+      while (in >> p.x >> p.y >> p.z){
+        parsed.push_back(p);
+      }
+
+      do_not_optimize(parsed.data());
+    });
+
+    measure(chars_parse, [&]{
+      const auto parsed = m::parse_array<m::vec3>(text);
+      do_not_optimize(parsed.data());
+    });
+  }
+
+  std::cout << count << " vec3, " << text.size() / (1024.0 * 1024.0) << " MiB of text\n";
+  report({ stream_format, chars_format, stream_parse, chars_parse });
+}
@@ -0,0 +1,81 @@
+//Batched sin, cos, atan2, exp, log and pow at every instruction set level
+//the CPU supports, against loops over the std:: functions.
+//Usage: transcendental [elements = 1000000]
+
+#include "../batch.hpp"
+#include "bench.hpp"
+#include <cstdlib>
+#include <random>
+
+namespace m = gf::math;
+
+auto main(int argc, char** argv) -> int{
+  const auto count = argc > 1 ? std::size_t(std::atoll(argv[1])) : std::size_t(1000000);
+
+  auto random = std::mt19937(9);
+  auto angle = std::uniform_real_distribution<float>(-10.f, 10.f);
+  auto positive = std::uniform_real_distribution<float>(0.f, 100.f);
+
+  auto angles = std::vector<float>(count);
+  auto values = std::vector<float>(count);
+
+  for (auto i : m::range(count)){
+    angles[i] = angle(random);
+    values[i] = positive(random);
+  }
+
+  auto result = std::vector<float>(count);
+  auto other = std::vector<float>(count);
+
+  auto stages = std::vector<samples>();
+
+  const auto run = [&](const std::string& suffix, auto sin, auto sincos, auto atan2, auto exp, auto log, auto pow){
+    auto s = std::vector<samples>{
+      { "sin " + suffix, {} },
+      { "sincos " + suffix, {} },
+      { "atan2 " + suffix, {} },
+      { "exp " + suffix, {} },
+      { "log " + suffix, {} },
+      { "pow " + suffix, {} }
+    };
+
+    for (auto i = 0; i < 10; ++i){
+      measure(s[0], sin);
+      measure(s[1], sincos);
+      measure(s[2], atan2);
+      measure(s[3], exp);
+      measure(s[4], log);
+      measure(s[5], pow);
+
+      do_not_optimize(result.data());
+      do_not_optimize(other.data());
+    }
+
+    stages.insert(stages.end(), s.begin(), s.end());
+  };
+
+  run("std",
+    [&]{ for (auto i : m::range(count)) result[i] = std::sin(angles[i]); },
+    [&]{ for (auto i : m::range(count)) result[i] = std::sin(angles[i]), other[i] = std::cos(angles[i]); },
+    [&]{ for (auto i : m::range(count)) result[i] = std::atan2(angles[i], values[i]); },
+    [&]{ for (auto i : m::range(count)) result[i] = std::exp(angles[i]); },
+    [&]{ for (auto i : m::range(count)) result[i] = std::log(values[i]); },
+    [&]{ for (auto i : m::range(count)) result[i] = std::pow(values[i], 2.2f); }
+  );
+
+  for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+    if (m::force_isa(level) != level) continue;
+
+    run(m::isa_name(level),
+      [&]{ m::sin(angles.data(), count, result.data()); },
+      [&]{ m::sincos(angles.data(), count, result.data(), other.data()); },
+      [&]{ m::atan2(angles.data(), values.data(), count, result.data()); },
+      [&]{ m::exp(angles.data(), count, result.data()); },
+      [&]{ m::log(values.data(), count, result.data()); },
+      [&]{ m::pow(values.data(), 2.2f, count, result.data()); }
+    );
+  }
+
+  std::cout << count << " elements, supported: " << m::isa_name(m::supported_isa()) << '\n';
+  report(stages);
+}
@@ -0,0 +1,573 @@
+#pragma once
+
+#include "math.hpp"
+#include <cstdio>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GEFEC_MATH_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+//Binary container for arrays of scalars, vectors and matrices. Layout:
+//  64 byte header, every field little-endian:
+//    char     magic[8]     "GFMATH\0\0"
+//    uint32   version      BinaryVersion
+//    uint32   scalar       scalar_kind of the components
+//    uint32   scalar_size  bytes per component
+//    uint32   columns      N for vec<T, N>, W for mat<T, W, H>, 1 for scalars
+//    uint32   rows         1 for vec<T, N>, H for mat<T, W, H>, 1 for scalars
+//    uint32   element_size bytes per element
+//    uint64   count        number of elements
+//    uint64   data_offset  BinaryAlignment aligned offset of the first element
+//    uint32   layout       0 for column-major matrices and everything else, 1 for row-major
+//  count tightly packed elements, little-endian components.
+//    Matrices are stored in their own layout, like mat::data.
+
+namespace gf::math{
+
+inline constexpr auto BinaryVersion = std::uint32_t(1);
+inline constexpr auto BinaryAlignment = std::uint64_t(64);
+
+enum class scalar_kind : std::uint32_t{
+  unknown = 0,
+  int8, uint8, int16, uint16, int32, uint32, int64, uint64,
+  float32, float64
+};
+
+namespace detail{
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+inline constexpr auto LittleEndian = false;
+#else
+inline constexpr auto LittleEndian = true;
+#endif
+
+template<typename T>
+inline constexpr auto scalar_kind_of() noexcept{
+  if constexpr (std::is_same_v<T, float>) return scalar_kind::float32;
+  else if constexpr (std::is_same_v<T, double>) return scalar_kind::float64;
+  else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>){
+    if constexpr (sizeof(T) == 1) return scalar_kind::int8;
+    else if constexpr (sizeof(T) == 2) return scalar_kind::int16;
+    else if constexpr (sizeof(T) == 4) return scalar_kind::int32;
+    else return scalar_kind::int64;
+  }
+  else if constexpr (std::is_integral_v<T>){
+    if constexpr (sizeof(T) == 1) return scalar_kind::uint8;
+    else if constexpr (sizeof(T) == 2) return scalar_kind::uint16;
+    else if constexpr (sizeof(T) == 4) return scalar_kind::uint32;
+    else return scalar_kind::uint64;
+  }
+  else return scalar_kind::unknown;
+}
+
+//Shape of an element type as stored in the header:
+template<typename E>
+struct binary_element{
+  using scalar_type = E;
+  static constexpr auto Columns = std::uint32_t(1);
+  static constexpr auto Rows = std::uint32_t(1);
+  static constexpr auto Layout = std::uint32_t(0);
+};
+
+template<typename T, std::size_t N>
+struct binary_element<vec<T, N>>{
+  using scalar_type = T;
+  static constexpr auto Columns = std::uint32_t(N);
+  static constexpr auto Rows = std::uint32_t(1);
+  static constexpr auto Layout = std::uint32_t(0);
+};
+
+template<typename T, std::size_t W, std::size_t H, typename L>
+struct binary_element<mat<T, W, H, L>>{
+  using scalar_type = T;
+  static constexpr auto Columns = std::uint32_t(W);
+  static constexpr auto Rows = std::uint32_t(H);
+  static constexpr auto Layout = std::uint32_t(std::is_same_v<L, layout::row_major>);
+};
+
+template<typename E>
+inline constexpr auto check_binary_element() noexcept{
+  using element = binary_element<E>;
+  using scalar = typename element::scalar_type;
+
+  static_assert(scalar_kind_of<scalar>() != scalar_kind::unknown, "components must be integers, float or double");
+  static_assert(std::is_trivially_copyable_v<E>, "elements are copied bytewise");
+  static_assert(sizeof(E) == sizeof(scalar) * element::Columns * element::Rows, "elements can't have padding");
+
+  return true;
+}
+
+template<typename T>
+inline auto byteswap(T value) noexcept{
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+
+  for (auto i : range(sizeof(T) / 2)){
+    std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+  }
+
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+//Converts between host and little-endian order, in place:
+template<typename E>
+inline auto swap_components(E* elements, std::size_t count) noexcept{
+  using scalar = typename binary_element<E>::scalar_type;
+  constexpr auto Components = sizeof(E) / sizeof(scalar);
+
+  if constexpr (!LittleEndian && sizeof(scalar) > 1){
+    for (auto i : range(count)){
+      auto* components = reinterpret_cast<scalar*>(elements + i);
+
+      for (auto c : range(Components)){
+        components[c] = byteswap(components[c]);
+      }
+    }
+  }
+}
+
+template<typename T>
+inline auto little_endian(T value) noexcept{
+  if constexpr (LittleEndian) return value;
+  else return byteswap(value);
+}
+
+struct binary_header{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t scalar;
+  std::uint32_t scalar_size;
+  std::uint32_t columns;
+  std::uint32_t rows;
+  std::uint32_t element_size;
+  std::uint64_t count;
+  std::uint64_t data_offset;
+  std::uint32_t layout;
+  unsigned char reserved[12];
+};
+
+static_assert(sizeof(binary_header) == BinaryAlignment);
+
+inline constexpr char BinaryMagic[8] = { 'G', 'F', 'M', 'A', 'T', 'H', 0, 0 };
+
+//Offset of binary_header::count, patched when a writer closes:
+inline constexpr auto BinaryCountOffset = 32;
+
+template<typename E>
+inline auto make_header(std::uint64_t count) noexcept{
+  using element = binary_element<E>;
+
+  auto header = binary_header();
+  std::memcpy(header.magic, BinaryMagic, sizeof(BinaryMagic));
+  header.version = little_endian(BinaryVersion);
+  header.scalar = little_endian(static_cast<std::uint32_t>(scalar_kind_of<typename element::scalar_type>()));
+  header.scalar_size = little_endian(std::uint32_t(sizeof(typename element::scalar_type)));
+  header.columns = little_endian(element::Columns);
+  header.rows = little_endian(element::Rows);
+  header.element_size = little_endian(std::uint32_t(sizeof(E)));
+  header.count = little_endian(count);
+  header.data_offset = little_endian(BinaryAlignment);
+  header.layout = little_endian(element::Layout);
+
+  return header;
+}
+
+//Reads the header from the first bytes of a file and checks that it describes
+//elements of type E. Returns false for other files and versions:
+template<typename E>
+inline auto parse_header(const void* bytes, std::uint64_t file_size, binary_header& header) noexcept{
+  if (file_size < sizeof(binary_header)) return false;
+
+  std::memcpy(&header, bytes, sizeof(binary_header));
+
+  const auto expected = make_header<E>(0);
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) return false;
+  if (header.version != expected.version) return false;
+  if (header.scalar != expected.scalar || header.scalar_size != expected.scalar_size) return false;
+  if (header.columns != expected.columns || header.rows != expected.rows) return false;
+  if (header.element_size != expected.element_size) return false;
+  if (header.layout != expected.layout) return false;
+
+  header.count = little_endian(header.count);
+  header.data_offset = little_endian(header.data_offset);
+
+  if (header.data_offset < sizeof(binary_header) || header.data_offset % BinaryAlignment != 0) return false;
+  if (header.data_offset > file_size) return false;
+
+  //Truncated files are rejected instead of read past the end:
+  return header.count <= (file_size - header.data_offset) / sizeof(E);
+}
+
+inline auto file_size(std::FILE* file) noexcept{
+  auto size = std::uint64_t(0);
+
+#ifdef GEFEC_MATH_MMAP
+  struct stat info;
+  if (::fstat(::fileno(file), &info) == 0) size = static_cast<std::uint64_t>(info.st_size);
+#else
+  const auto position = std::ftell(file);
+  if (std::fseek(file, 0, SEEK_END) == 0) size = static_cast<std::uint64_t>(std::ftell(file));
+  std::fseek(file, position, SEEK_SET);
+#endif
+
+  return size;
+}
+
+} //namespace detail
+
+//Non-owning view of contiguous elements (std::span is C++20):
+template<typename T>
+struct array_view{
+  T* pointer = nullptr;
+  std::size_t count = 0;
+
+  constexpr auto data() const noexcept{ return pointer; }
+  constexpr auto size() const noexcept{ return count; }
+  constexpr auto empty() const noexcept{ return count == 0; }
+
+  constexpr auto begin() const noexcept{ return pointer; }
+  constexpr auto end() const noexcept{ return pointer + count; }
+
+  constexpr auto& operator[](std::size_t i) const noexcept{
+    return pointer[i];
+  }
+
+  //Clamped to the view:
+  constexpr auto subview(std::size_t offset, std::size_t length) const noexcept{
+    offset = math::min(offset, count);
+    return array_view<T>{ pointer + offset, math::min(length, count - offset) };
+  }
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+  constexpr operator std::span<T>() const noexcept{
+    return std::span<T>(pointer, count);
+  }
+#endif
+};
+
+//Streams elements into a file in batches. The element count in the header is
+//written by close() (or the destructor), so it doesn't have to be known up front.
+template<typename E>
+struct binary_writer{
+  static_assert(detail::check_binary_element<E>());
+
+  binary_writer() = default;
+
+  explicit binary_writer(const char* path) noexcept{
+    file = std::fopen(path, "wb");
+    if (file == nullptr) return;
+
+    const auto header = detail::make_header<E>(0);
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) failed = true;
+  }
+
+  binary_writer(const binary_writer&) = delete;
+  auto operator=(const binary_writer&) -> binary_writer& = delete;
+
+  binary_writer(binary_writer&& other) noexcept{
+    (*this) = std::move(other);
+  }
+
+  auto operator=(binary_writer&& other) noexcept -> binary_writer&{
+    close();
+    std::swap(file, other.file);
+    std::swap(written, other.written);
+    std::swap(failed, other.failed);
+    return *this;
+  }
+
+  ~binary_writer(){
+    close();
+  }
+
+  explicit operator bool() const noexcept{
+    return file != nullptr && !failed;
+  }
+
+  auto count() const noexcept{
+    return written;
+  }
+
+  auto write(const E* elements, std::size_t count) noexcept{
+    if (!(*this)) return false;
+
+    if constexpr (detail::LittleEndian){
+      failed = std::fwrite(elements, sizeof(E), count, file) != count;
+    }
+    else{
+      constexpr auto Batch = std::size_t(1024);
+      E buffer[Batch];
+
+      for (auto begin = std::size_t(0); begin < count && !failed; begin += Batch){
+        const auto size = math::min(Batch, count - begin);
+        std::memcpy(buffer, elements + begin, size * sizeof(E));
+        detail::swap_components(buffer, size);
+        failed = std::fwrite(buffer, sizeof(E), size, file) != size;
+      }
+    }
+
+    if (!failed) written += count;
+    return !failed;
+  }
+
+  auto write(const std::vector<E>& elements) noexcept{
+    return write(elements.data(), elements.size());
+  }
+
+  auto write(const E& element) noexcept{
+    return write(&element, 1);
+  }
+
+  //Patches the element count and closes the file, true if everything was written:
+  auto close() noexcept{
+    if (file == nullptr) return false;
+
+    const auto count = detail::little_endian(std::uint64_t(written));
+
+    auto ok = !failed;
+    ok = ok && std::fseek(file, detail::BinaryCountOffset, SEEK_SET) == 0;
+    ok = ok && std::fwrite(&count, sizeof(count), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+
+    file = nullptr;
+    failed = !ok;
+    return ok;
+  }
+
+private:
+  std::FILE* file = nullptr;
+  std::size_t written = 0;
+  bool failed = false;
+};
+
+//Reads elements sequentially in chunks of any size, for files larger than memory:
+template<typename E>
+struct binary_reader{
+  static_assert(detail::check_binary_element<E>());
+
+  binary_reader() = default;
+
+  explicit binary_reader(const char* path) noexcept{
+    file = std::fopen(path, "rb");
+    if (file == nullptr) return;
+
+    unsigned char bytes[sizeof(detail::binary_header)];
+    auto header = detail::binary_header();
+
+    const auto valid =
+      std::fread(bytes, sizeof(bytes), 1, file) == 1 &&
+      detail::parse_header<E>(bytes, detail::file_size(file), header) &&
+      std::fseek(file, static_cast<long>(header.data_offset), SEEK_SET) == 0;
+
+    if (!valid){
+      std::fclose(file);
+      file = nullptr;
+      return;
+    }
+
+    total = header.count;
+  }
+
+  binary_reader(const binary_reader&) = delete;
+  auto operator=(const binary_reader&) -> binary_reader& = delete;
+
+  binary_reader(binary_reader&& other) noexcept{
+    (*this) = std::move(other);
+  }
+
+  auto operator=(binary_reader&& other) noexcept -> binary_reader&{
+    std::swap(file, other.file);
+    std::swap(total, other.total);
+    std::swap(position, other.position);
+    return *this;
+  }
+
+  ~binary_reader(){
+    if (file != nullptr) std::fclose(file);
+  }
+
+  explicit operator bool() const noexcept{
+    return file != nullptr;
+  }
+
+  auto size() const noexcept{
+    return total;
+  }
+
+  auto remaining() const noexcept{
+    return total - position;
+  }
+
+  //Reads up to max_count elements, returns how many were read (0 at the end):
+  auto read(E* elements, std::size_t max_count) noexcept{
+    if (file == nullptr) return std::size_t(0);
+
+    const auto count = std::fread(elements, sizeof(E), math::min(max_count, remaining()), file);
+    detail::swap_components(elements, count);
+
+    position += count;
+    return count;
+  }
+
+  //Resizes chunk to the number of elements read:
+  auto read(std::vector<E>& chunk, std::size_t max_count){
+    chunk.resize(math::min(max_count, remaining()));
+    chunk.resize(read(chunk.data(), chunk.size()));
+    return chunk.size();
+  }
+
+private:
+  std::FILE* file = nullptr;
+  std::size_t total = 0;
+  std::size_t position = 0;
+};
+
+//Read-only view of a whole file. Pages are loaded by the OS on first access;
+//without mmap the file is read into memory instead.
+struct mapped_file{
+  mapped_file() = default;
+
+  explicit mapped_file(const char* path) noexcept{
+#ifdef GEFEC_MATH_MMAP
+    const auto descriptor = ::open(path, O_RDONLY);
+    if (descriptor < 0) return;
+
+    struct stat info;
+    if (::fstat(descriptor, &info) != 0 || info.st_size <= 0){
+      ::close(descriptor);
+      return;
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    auto* memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if (memory == MAP_FAILED) return;
+
+    bytes = array_view<const char>{ static_cast<const char*>(memory), size };
+#else
+    auto* file = std::fopen(path, "rb");
+    if (file == nullptr) return;
+
+    buffer.resize(detail::file_size(file));
+    const auto size = std::fread(buffer.data(), 1, buffer.size(), file);
+    std::fclose(file);
+
+    if (size != 0) bytes = array_view<const char>{ buffer.data(), size };
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  auto operator=(const mapped_file&) -> mapped_file& = delete;
+
+  mapped_file(mapped_file&& other) noexcept{
+    (*this) = std::move(other);
+  }
+
+  auto operator=(mapped_file&& other) noexcept -> mapped_file&{
+    std::swap(buffer, other.buffer);
+    std::swap(bytes, other.bytes);
+    return *this;
+  }
+
+  ~mapped_file(){
+#ifdef GEFEC_MATH_MMAP
+    if (bytes.data() != nullptr) ::munmap(const_cast<char*>(bytes.data()), bytes.size());
+#endif
+  }
+
+  //False for missing and empty files:
+  explicit operator bool() const noexcept{
+    return bytes.data() != nullptr;
+  }
+
+  auto view() const noexcept{ return bytes; }
+  auto data() const noexcept{ return bytes.data(); }
+  auto size() const noexcept{ return bytes.size(); }
+
+private:
+  std::vector<char> buffer;
+  array_view<const char> bytes;
+};
+
+//Maps a whole file and views its elements without copying them. Needs a
+//little-endian host, use binary_reader on others.
+template<typename E>
+struct mapped_array{
+  static_assert(detail::check_binary_element<E>());
+
+  mapped_array() = default;
+
+  explicit mapped_array(const char* path) noexcept{
+    if constexpr (!detail::LittleEndian) return;
+
+    file = mapped_file(path);
+
+    auto header = detail::binary_header();
+    if (!file || !detail::parse_header<E>(file.data(), file.size(), header)) return;
+
+    elements = array_view<const E>{ reinterpret_cast<const E*>(file.data() + header.data_offset), header.count };
+  }
+
+  mapped_array(mapped_array&& other) noexcept{
+    (*this) = std::move(other);
+  }
+
+  auto operator=(mapped_array&& other) noexcept -> mapped_array&{
+    std::swap(file, other.file);
+    std::swap(elements, other.elements);
+    return *this;
+  }
+
+  //False for missing, truncated and foreign files, or files with other element types:
+  explicit operator bool() const noexcept{
+    return elements.data() != nullptr;
+  }
+
+  auto view() const noexcept{ return elements; }
+  auto data() const noexcept{ return elements.data(); }
+  auto size() const noexcept{ return elements.size(); }
+  auto begin() const noexcept{ return elements.begin(); }
+  auto end() const noexcept{ return elements.end(); }
+
+  auto& operator[](std::size_t i) const noexcept{
+    return elements[i];
+  }
+
+  //Elements [offset, offset + count), clamped to the file:
+  auto chunk(std::size_t offset, std::size_t count) const noexcept{
+    return elements.subview(offset, count);
+  }
+
+private:
+  mapped_file file;
+  array_view<const E> elements;
+};
+
+//Whole arrays at once:
+template<typename E>
+inline auto write_binary(const char* path, const std::vector<E>& elements){
+  auto writer = binary_writer<E>(path);
+  return writer.write(elements) && writer.close();
+}
+
+//Empty for unreadable files, check with a binary_reader when that matters:
+template<typename E>
+inline auto read_binary(const char* path){
+  auto reader = binary_reader<E>(path);
+  auto result = std::vector<E>();
+  reader.read(result, reader.size());
+  return result;
+}
+
+} //namespace gf::math
@@ -0,0 +1,625 @@
+#pragma once
+
+#include "intersect.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <vector>
+
+namespace gf::math{
+
+//Flattened binary node. Children of an interior node are allocated as a pair,
+//so the right child of nodes[i] is always nodes[nodes[i].first + 1].
+template<typename T>
+struct bvh_node{
+  aabb<T> bounds;
+  std::uint32_t first = 0; //left child, or leaf index when count != 0
+  std::uint32_t count = 0; //triangles in the leaf, 0 for interior nodes
+
+  constexpr auto is_leaf() const noexcept{
+    return count != 0;
+  }
+};
+
+//Leaf triangles are kept in a packet, so a leaf is tested with one batched call.
+//Unused lanes are degenerate triangles, which never report a hit.
+template<typename T>
+struct bvh_leaf{
+  static constexpr auto Width = std::size_t(4);
+
+  triangle_packet<T, Width> triangles;
+  std::uint32_t ids[Width] = { InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex };
+};
+
+template<typename T>
+struct bvh_hit{
+  std::uint32_t triangle = InvalidIndex;
+  T t = std::numeric_limits<T>::infinity();
+  T u = T(0);
+  T v = T(0);
+
+  constexpr auto hit() const noexcept{
+    return triangle != InvalidIndex;
+  }
+};
+
+namespace detail{
+
+//Triangles given either as a triangle soup (empty indices) or as an index buffer:
+template<typename T>
+struct mesh_ref{
+  const std::vector<vec<T, 3>>& positions;
+  const std::vector<std::uint32_t>& indices;
+
+  auto triangle_count() const noexcept{
+    return (indices.empty() ? positions.size() : indices.size()) / 3;
+  }
+
+  auto vertex(std::size_t triangle, std::size_t n) const noexcept -> const vec<T, 3>&{
+    const auto i = triangle * 3 + n;
+    return positions[indices.empty() ? i : indices[i]];
+  }
+
+  auto bounds(std::size_t triangle) const noexcept{
+    auto result = aabb<T>();
+
+    for (auto n : range(3)){
+      result.extend(vertex(triangle, n));
+    }
+
+    return result;
+  }
+};
+
+template<typename T>
+inline auto fill_leaf(
+  bvh_leaf<T>& leaf,
+  const mesh_ref<T>& mesh,
+  const std::uint32_t* ids,
+  std::size_t count
+){
+  for (auto lane : range(count)){
+    leaf.ids[lane] = ids[lane];
+    leaf.triangles.set(
+      lane,
+      mesh.vertex(ids[lane], 0),
+      mesh.vertex(ids[lane], 1),
+      mesh.vertex(ids[lane], 2)
+    );
+  }
+}
+
+template<typename T>
+inline auto lane_bounds(const bvh_leaf<T>& leaf, std::size_t lane){
+  const auto v0 = leaf.triangles.v0.get(lane);
+
+  return aabb<T>()
+    .extend(v0)
+    .extend(v0 + leaf.triangles.e1.get(lane))
+    .extend(v0 + leaf.triangles.e2.get(lane));
+}
+
+template<typename T>
+inline auto slab(const aabb<T>& box, const vec<T, 3>& origin, const vec<T, 3>& inv_direction, T t_min, T t_max){
+  return slab(
+    origin.x, origin.y, origin.z,
+    inv_direction.x, inv_direction.y, inv_direction.z,
+    box.min.x, box.min.y, box.min.z,
+    box.max.x, box.max.y, box.max.z,
+    t_min, t_max
+  );
+}
+
+//Binned SAH builder. Subtrees larger than ParallelThreshold are built on
+//separate threads, as long as the tree is shallower than max_parallel_depth.
+template<typename T>
+struct bvh_builder{
+  static constexpr auto BinCount = std::size_t(16);
+  static constexpr auto LeafSize = bvh_leaf<T>::Width;
+  static constexpr auto ParallelThreshold = std::size_t(4096);
+  //Beyond this depth nodes are split in the middle, which bounds the traversal stack:
+  static constexpr auto MaxSahDepth = std::size_t(64);
+
+  const mesh_ref<T>& mesh;
+  const std::vector<aabb<T>>& bounds;
+  const std::vector<vec<T, 3>>& centroids;
+  std::vector<std::uint32_t>& ids;
+  std::vector<bvh_node<T>>& nodes;
+  std::vector<bvh_leaf<T>>& leaves;
+  std::size_t max_parallel_depth;
+
+  std::atomic<std::uint32_t> node_count{ 1 };
+  std::atomic<std::uint32_t> leaf_count{ 0 };
+
+  auto make_leaf(bvh_node<T>& node, std::size_t begin, std::size_t end){
+    const auto leaf = leaf_count.fetch_add(1);
+    fill_leaf(leaves[leaf], mesh, ids.data() + begin, end - begin);
+
+    node.first = leaf;
+    node.count = static_cast<std::uint32_t>(end - begin);
+  }
+
+  //Partitions the range and returns the first index of the right half.
+  //Returns `begin` when a leaf is cheaper and `end` when no plane separates the range.
+  auto sah_split(
+    const aabb<T>& node_bounds,
+    const aabb<T>& centroid_bounds,
+    std::size_t axis,
+    std::size_t begin,
+    std::size_t end
+  ){
+    const auto count = end - begin;
+    const auto low = centroid_bounds.min[axis];
+    const auto scale = T(BinCount) / (centroid_bounds.max[axis] - low);
+
+    const auto bin_of = [&](std::uint32_t id){
+      const auto bin = static_cast<std::size_t>((centroids[id][axis] - low) * scale);
+      return bin < BinCount ? bin : BinCount - 1;
+    };
+
+    aabb<T> bin_bounds[BinCount];
+    std::size_t bin_counts[BinCount] = {};
+
+    for (auto i : range(begin, end)){
+      const auto bin = bin_of(ids[i]);
+      bin_bounds[bin].extend(bounds[ids[i]]);
+      ++bin_counts[bin];
+    }
+
+    //Right-to-left sweep first, then the left-to-right sweep evaluates every plane:
+    T right_cost[BinCount] = {};
+    auto right = aabb<T>();
+    auto right_count = std::size_t(0);
+
+    for (auto i = BinCount - 1; i > 0; --i){
+      right.extend(bin_bounds[i]);
+      right_count += bin_counts[i];
+      right_cost[i] = right.surface_area() * T(right_count);
+    }
+
+    auto left = aabb<T>();
+    auto left_count = std::size_t(0);
+    auto best_cost = std::numeric_limits<T>::max();
+    auto best_split = std::size_t(0);
+
+    for (auto i : range(1, BinCount)){
+      left.extend(bin_bounds[i - 1]);
+      left_count += bin_counts[i - 1];
+
+      const auto cost = left.surface_area() * T(left_count) + right_cost[i];
+
+      if (left_count != 0 && left_count != count && cost < best_cost){
+        best_cost = cost;
+        best_split = i;
+      }
+    }
+
+    //Traversal and intersection costs are both taken as 1:
+    const auto area = node_bounds.surface_area();
+    const auto leaf_cost = area * T(count);
+    const auto split_cost = area + best_cost;
+
+    if (best_split == 0){
+      return count <= LeafSize ? begin : end;
+    }
+
+    if (count <= LeafSize && leaf_cost <= split_cost){
+      return begin;
+    }
+
+    const auto middle = std::partition(
+      ids.begin() + begin,
+      ids.begin() + end,
+      [&](std::uint32_t id){ return bin_of(id) < best_split; }
+    );
+
+    return static_cast<std::size_t>(middle - ids.begin());
+  }
+
+  auto build(std::uint32_t index, std::size_t begin, std::size_t end, std::size_t depth) -> void{
+    auto& node = nodes[index];
+    auto centroid_bounds = aabb<T>();
+
+    node.bounds = aabb<T>();
+
+    for (auto i : range(begin, end)){
+      node.bounds.extend(bounds[ids[i]]);
+      centroid_bounds.extend(centroids[ids[i]]);
+    }
+
+    const auto count = end - begin;
+    const auto axis = centroid_bounds.major_axis();
+    const auto flat = centroid_bounds.max[axis] <= centroid_bounds.min[axis];
+
+    if (count == 1 || (flat && count <= LeafSize)){
+      make_leaf(node, begin, end);
+      return;
+    }
+
+    auto median = flat || depth >= MaxSahDepth;
+    auto middle = begin + count / 2;
+
+    if (!median){
+      middle = sah_split(node.bounds, centroid_bounds, axis, begin, end);
+
+      if (middle == begin){
+        make_leaf(node, begin, end);
+        return;
+      }
+
+      if (middle == end){
+        median = true;
+        middle = begin + count / 2;
+      }
+    }
+
+    if (median){
+      std::nth_element(
+        ids.begin() + begin,
+        ids.begin() + middle,
+        ids.begin() + end,
+        [&](std::uint32_t a, std::uint32_t b){ return centroids[a][axis] < centroids[b][axis]; }
+      );
+    }
+
+    const auto children = node_count.fetch_add(2);
+    node.first = children;
+    node.count = 0;
+
+    if (depth < max_parallel_depth && count >= ParallelThreshold){
+      auto left = std::async(std::launch::async, [&, middle]{
+        build(children, begin, middle, depth + 1);
+      });
+
+      build(children + 1, middle, end, depth + 1);
+      left.get();
+    }
+    else{
+      build(children, begin, middle, depth + 1);
+      build(children + 1, middle, end, depth + 1);
+    }
+  }
+};
+
+} //namespace detail
+
+//Bounding volume hierarchy over triangles, built with the binned surface area
+//heuristic. Triangles are read from `positions`, either three vertices per
+//triangle or through `indices`. The mesh isn't stored; pass it again to refit().
+template<typename T>
+struct bvh{
+  std::vector<bvh_node<T>> nodes;
+  std::vector<bvh_leaf<T>> leaves;
+
+  bvh() = default;
+
+  explicit bvh(
+    const std::vector<vec<T, 3>>& positions,
+    const std::vector<std::uint32_t>& indices = {},
+    std::size_t threads = hardware_threads()
+  ){
+    const auto mesh = detail::mesh_ref<T>{ positions, indices };
+    const auto count = mesh.triangle_count();
+
+    if (count == 0) return;
+
+    auto bounds = std::vector<aabb<T>>(count);
+    auto centroids = std::vector<vec<T, 3>>(count);
+    auto ids = std::vector<std::uint32_t>(count);
+
+    std::iota(ids.begin(), ids.end(), std::uint32_t(0));
+
+    parallel_for(count, [&](std::size_t begin, std::size_t end){
+      for (auto i : range(begin, end)){
+        bounds[i] = mesh.bounds(i);
+        centroids[i] = bounds[i].center();
+      }
+    }, threads);
+
+    nodes.resize(count * 2 - 1);
+    leaves.resize(count);
+
+    auto parallel_depth = std::size_t(0);
+    while (threads > 1 && (std::size_t(1) << parallel_depth) < threads * 2){
+      ++parallel_depth;
+    }
+
+    auto builder = detail::bvh_builder<T>{
+      mesh, bounds, centroids, ids, nodes, leaves, parallel_depth
+    };
+
+    builder.build(0, 0, count, 0);
+
+    nodes.resize(builder.node_count);
+    leaves.resize(builder.leaf_count);
+  }
+
+  auto bounds() const{
+    return nodes.empty() ? aabb<T>() : nodes[0].bounds;
+  }
+
+  //Updates vertex positions and node bounds after the mesh has moved, keeping
+  //the topology. Quality degrades with large deformations; rebuild then.
+  auto refit(
+    const std::vector<vec<T, 3>>& positions,
+    const std::vector<std::uint32_t>& indices = {},
+    std::size_t threads = hardware_threads()
+  ){
+    const auto mesh = detail::mesh_ref<T>{ positions, indices };
+
+    parallel_for(leaves.size(), [&](std::size_t begin, std::size_t end){
+      for (auto i : range(begin, end)){
+        auto& leaf = leaves[i];
+        auto count = std::size_t(0);
+
+        while (count < bvh_leaf<T>::Width && leaf.ids[count] != InvalidIndex) ++count;
+
+        detail::fill_leaf(leaf, mesh, leaf.ids, count);
+      }
+    }, threads);
+
+    //Children always come after their parent, so a reverse sweep is bottom-up:
+    for (auto i = nodes.size(); i-- > 0;){
+      auto& node = nodes[i];
+      node.bounds = aabb<T>();
+
+      if (node.is_leaf()){
+        for (auto lane : range(node.count)){
+          node.bounds.extend(mesh.bounds(leaves[node.first].ids[lane]));
+        }
+      }
+      else{
+        node.bounds
+          .extend(nodes[node.first].bounds)
+          .extend(nodes[node.first + 1].bounds);
+      }
+    }
+  }
+
+  //Closest hit along the ray:
+  auto intersect(
+    const ray<T>& r,
+    T t_min = T(0),
+    T t_max = std::numeric_limits<T>::infinity()
+  ) const{
+    auto result = bvh_hit<T>();
+    if (nodes.empty()) return result;
+
+    const auto inv_direction = T(1) / r.direction;
+    const auto root = detail::slab(nodes[0].bounds, r.origin, inv_direction, t_min, t_max);
+    if (!root.hit) return result;
+
+    struct entry{ std::uint32_t node; T t; };
+    entry stack[128];
+    auto size = std::size_t(0);
+
+    stack[size++] = entry{ 0, root.t };
+    result.t = t_max;
+
+    while (size != 0){
+      const auto [index, entry_t] = stack[--size];
+      if (entry_t > result.t) continue;
+
+      const auto& node = nodes[index];
+
+      if (node.is_leaf()){
+        const auto& leaf = leaves[node.first];
+        const auto hits = math::intersect(r, leaf.triangles, t_min, result.t);
+        const auto lane = hits.nearest();
+
+        if (lane != bvh_leaf<T>::Width){
+          result = bvh_hit<T>{ leaf.ids[lane], hits.t[lane], hits.u[lane], hits.v[lane] };
+        }
+
+        continue;
+      }
+
+      const auto left = detail::slab(nodes[node.first].bounds, r.origin, inv_direction, t_min, result.t);
+      const auto right = detail::slab(nodes[node.first + 1].bounds, r.origin, inv_direction, t_min, result.t);
+
+      //The nearer child is pushed last, so it is visited first:
+      if (left.hit && right.hit){
+        const auto left_first = left.t <= right.t;
+
+        stack[size++] = left_first ? entry{ node.first + 1, right.t } : entry{ node.first, left.t };
+        stack[size++] = left_first ? entry{ node.first, left.t } : entry{ node.first + 1, right.t };
+      }
+      else if (left.hit){
+        stack[size++] = entry{ node.first, left.t };
+      }
+      else if (right.hit){
+        stack[size++] = entry{ node.first + 1, right.t };
+      }
+    }
+
+    if (!result.hit()) result.t = std::numeric_limits<T>::infinity();
+    return result;
+  }
+
+  //Calls callable(triangle) for every triangle whose bounds overlap the box:
+  template<typename Callable>
+  auto query(const aabb<T>& box, Callable callable) const{
+    visit(
+      [&](const aabb<T>& bounds){ return overlaps(bounds, box); },
+      callable
+    );
+  }
+
+  //Calls callable(triangle) for every triangle whose bounds may be inside the frustum:
+  template<typename Callable>
+  auto query(const frustum<T>& f, Callable callable) const{
+    visit(
+      [&](const aabb<T>& bounds){ return overlaps(f, bounds); },
+      callable
+    );
+  }
+
+private:
+  template<typename Predicate, typename Callable>
+  auto visit(Predicate predicate, Callable callable) const{
+    if (nodes.empty()) return;
+
+    std::uint32_t stack[128];
+    auto size = std::size_t(0);
+
+    stack[size++] = 0;
+
+    while (size != 0){
+      const auto& node = nodes[stack[--size]];
+      if (!predicate(node.bounds)) continue;
+
+      if (!node.is_leaf()){
+        stack[size++] = node.first + 1;
+        stack[size++] = node.first;
+        continue;
+      }
+
+      const auto& leaf = leaves[node.first];
+
+      for (auto lane : range(node.count)){
+        if (predicate(detail::lane_bounds(leaf, lane))) callable(leaf.ids[lane]);
+      }
+    }
+  }
+};
+
+//Four wide node: the boxes of all four children are tested with one packet call.
+template<typename T>
+struct bvh4_node{
+  box_packet<T, 4> bounds;
+  std::uint32_t children[4] = { InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex };
+  std::uint32_t counts[4] = {}; //triangles of a leaf child, 0 for interior children
+  std::uint32_t valid = 0; //bit mask of the used lanes
+};
+
+//BVH4 collapsed from a binary bvh, for SIMD traversal. Collapse again after refit().
+template<typename T>
+struct bvh4{
+  std::vector<bvh4_node<T>> nodes;
+  std::vector<bvh_leaf<T>> leaves;
+
+  bvh4() = default;
+
+  explicit bvh4(const bvh<T>& tree) : leaves(tree.leaves){
+    if (tree.nodes.empty()) return;
+
+    nodes.reserve(tree.nodes.size() / 2 + 1);
+    collapse(tree, 0);
+  }
+
+  auto intersect(
+    const ray<T>& r,
+    T t_min = T(0),
+    T t_max = std::numeric_limits<T>::infinity()
+  ) const{
+    auto result = bvh_hit<T>();
+    if (nodes.empty()) return result;
+
+    struct entry{ std::uint32_t node; T t; };
+    entry stack[384];
+    auto size = std::size_t(0);
+
+    stack[size++] = entry{ 0, t_min };
+    result.t = t_max;
+
+    while (size != 0){
+      const auto [index, entry_t] = stack[--size];
+      if (entry_t > result.t) continue;
+
+      const auto& node = nodes[index];
+      const auto boxes = math::intersect(r, node.bounds, t_min, result.t);
+      const auto mask = boxes.mask & node.valid;
+
+      entry interior[4];
+      auto interior_count = std::size_t(0);
+
+      for (auto lane : range(4)){
+        if (((mask >> lane) & 1u) == 0) continue;
+
+        if (node.counts[lane] == 0){
+          interior[interior_count++] = entry{ node.children[lane], boxes.t[lane] };
+          continue;
+        }
+
+        const auto& leaf = leaves[node.children[lane]];
+        const auto hits = math::intersect(r, leaf.triangles, t_min, result.t);
+        const auto nearest = hits.nearest();
+
+        if (nearest != bvh_leaf<T>::Width){
+          result = bvh_hit<T>{ leaf.ids[nearest], hits.t[nearest], hits.u[nearest], hits.v[nearest] };
+        }
+      }
+
+      //Farthest first, so the nearest child is popped next:
+      for (auto i = std::size_t(1); i < interior_count; ++i){
+        for (auto j = i; j > 0 && interior[j - 1].t < interior[j].t; --j){
+          std::swap(interior[j - 1], interior[j]);
+        }
+      }
+
+      for (auto i : range(interior_count)){
+        stack[size++] = interior[i];
+      }
+    }
+
+    if (!result.hit()) result.t = std::numeric_limits<T>::infinity();
+    return result;
+  }
+
+private:
+  //Repeatedly opens the largest interior child until four children are gathered:
+  auto collapse(const bvh<T>& tree, std::uint32_t binary) -> std::uint32_t{
+    const auto index = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    const auto& root = tree.nodes[binary];
+
+    std::uint32_t children[4] = { binary };
+    auto count = std::size_t(1);
+
+    if (!root.is_leaf()){
+      children[0] = root.first;
+      children[1] = root.first + 1;
+      count = 2;
+    }
+
+    while (count < 4){
+      auto largest = count;
+      auto largest_area = T(-1);
+
+      for (auto i : range(count)){
+        const auto& child = tree.nodes[children[i]];
+        const auto area = child.bounds.surface_area();
+
+        if (!child.is_leaf() && area > largest_area){
+          largest = i;
+          largest_area = area;
+        }
+      }
+
+      if (largest == count) break;
+
+      const auto first = tree.nodes[children[largest]].first;
+      children[largest] = first;
+      children[count++] = first + 1;
+    }
+
+    for (auto i : range(count)){
+      const auto& child = tree.nodes[children[i]];
+
+      //nodes may reallocate during the recursion, so it is indexed every time:
+      nodes[index].bounds.set(i, child.bounds.min, child.bounds.max);
+      nodes[index].counts[i] = child.count;
+      nodes[index].valid |= 1u << i;
+
+      const auto target = child.is_leaf() ? child.first : collapse(tree, children[i]);
+      nodes[index].children[i] = target;
+    }
+
+    return index;
+  }
+};
+
+} //namespace gf::math
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "math.hpp"
+#include <limits>
+
+//3x3 decompositions for inertia tensors, covariance matrices and shape
+//matching, all built on cyclic Jacobi rotations:
+//  eigen_sym  symmetric a = vectors * diag(values) * vectors^T
+//  svd        a = u * diag(sigma) * v^T
+//  polar      a = rotation * stretch
+//The kernels work on structure of arrays packets of W matrices and run a fixed
+//number of sweeps, every step being one branch-free loop over the lanes, so
+//they vectorize across matrices (the sqrt in the steps only vectorizes when
+//errno can be ignored, e.g. with -fno-math-errno). Single matrices are
+//packets of one lane.
+
+namespace gf::math{
+
+//Lanes per packet used by the array versions:
+inline constexpr auto DecomposeWidth = std::size_t(8);
+
+//values in descending order, the matching unit eigenvectors in the columns
+//of vectors, which is a rotation (det = 1):
+template<typename T>
+struct eigen3{
+  vec<T, 3> values;
+  mat<T, 3, 3> vectors;
+};
+
+//u and v are rotations. The singular values are sorted by magnitude and
+//only sigma.z can be negative, carrying the sign of det(a):
+template<typename T>
+struct svd3{
+  mat<T, 3, 3> u;
+  vec<T, 3> sigma;
+  mat<T, 3, 3> v;
+};
+
+//rotation is the closest rotation to a, stretch is symmetric:
+template<typename T>
+struct polar3{
+  mat<T, 3, 3> rotation;
+  mat<T, 3, 3> stretch;
+};
+
+template<typename T, std::size_t W>
+struct eigen3_packet{
+  vec_packet<T, 3, W> values;
+  mat_packet<T, 3, 3, W> vectors;
+};
+
+template<typename T, std::size_t W>
+struct svd3_packet{
+  mat_packet<T, 3, 3, W> u;
+  vec_packet<T, 3, W> sigma;
+  mat_packet<T, 3, 3, W> v;
+};
+
+template<typename T, std::size_t W>
+struct polar3_packet{
+  mat_packet<T, 3, 3, W> rotation;
+  mat_packet<T, 3, 3, W> stretch;
+};
+
+namespace detail{
+
+//Smallest normal number, added to denominators that are 0 only when their
+//numerators are (a select would be turned back into a branch):
+template<typename T>
+inline constexpr auto Tiny = std::numeric_limits<T>::min();
+
+//Sweeps over the three off-diagonal pairs, enough to converge to the
+//precision of T for any symmetric 3x3 matrix:
+template<typename T>
+inline constexpr auto JacobiSweeps = std::size_t(sizeof(T) > 4 ? 6 : 5);
+
+//Calls f(0), f(1), f(2), so that the lane loops below have no inner loops
+//left to keep them from vectorizing at -O2:
+template<typename Callable>
+inline constexpr auto each3(Callable f) noexcept{
+  f(0);
+  f(1);
+  f(2);
+}
+
+//(a, b) = (c * a - s * b, s * a + c * b)
+template<typename T>
+inline constexpr auto rotate_pair(T& a, T& b, T c, T s) noexcept{
+  const auto a0 = a;
+  a = c * a0 - s * b;
+  b = s * a0 + c * b;
+}
+
+//Jacobi iteration state of W matrices, [x][y][lane] like mat_packet. Every
+//step below is one loop over the lanes:
+template<typename T, std::size_t W>
+struct jacobi_packet{
+  T s[3][3][W]; //Symmetric matrices being diagonalized
+  T v[3][3][W]; //Accumulated rotations
+};
+
+//Zeroes s[P][Q] with the rotation of Numerical Recipes, t = tan(angle)
+//written so that apq = 0 gives the identity instead of a division by zero.
+template<std::size_t P, std::size_t Q, typename T, std::size_t W>
+inline auto jacobi_rotate(jacobi_packet<T, W>& p) noexcept{
+  constexpr auto R = 3 - P - Q;
+
+  for (auto i : range(W)){
+    const auto app = p.s[P][P][i];
+    const auto aqq = p.s[Q][Q][i];
+    const auto apq = p.s[P][Q][i];
+
+    //|d| + h is only 0 when apq is, Tiny keeps t = 0 then:
+    const auto d = aqq - app;
+    const auto h = adl_sqrt(d * d + T(4) * apq * apq);
+    const auto t = T(2) * apq * std::copysign(T(1), d) / (std::fabs(d) + h + Tiny<T>);
+    const auto c = T(1) / adl_sqrt(T(1) + t * t);
+    const auto s = t * c;
+
+    p.s[P][P][i] = app - t * apq;
+    p.s[Q][Q][i] = aqq + t * apq;
+    p.s[P][Q][i] = p.s[Q][P][i] = T(0);
+
+    rotate_pair(p.s[R][P][i], p.s[R][Q][i], c, s);
+    p.s[P][R][i] = p.s[R][P][i];
+    p.s[Q][R][i] = p.s[R][Q][i];
+
+    each3([&](std::size_t k){ rotate_pair(p.v[P][k][i], p.v[Q][k][i], c, s); });
+  }
+}
+
+//Swaps eigenvalues I and J where J is larger, negating one of the columns so
+//that v stays a rotation:
+template<std::size_t I, std::size_t J, typename T, std::size_t W>
+inline constexpr auto jacobi_order(jacobi_packet<T, W>& p) noexcept{
+  for (auto i : range(W)){
+    const auto si = p.s[I][I][i];
+    const auto sj = p.s[J][J][i];
+    const auto swap = sj > si;
+
+    p.s[I][I][i] = std::max(si, sj);
+    p.s[J][J][i] = std::min(si, sj);
+
+    each3([&](std::size_t k){
+      const auto vi = p.v[I][k][i];
+      const auto vj = p.v[J][k][i];
+
+      p.v[I][k][i] = swap ? vj : vi;
+      p.v[J][k][i] = swap ? -vi : vj;
+    });
+  }
+}
+
+//Eigenvalues on the diagonal of s in descending order, eigenvectors in v:
+template<typename T, std::size_t W>
+inline auto jacobi(jacobi_packet<T, W>& p) noexcept{
+  for (const auto& [x, y] : range({ 3, 3 })){
+    for (auto i : range(W)){
+      p.v[x][y][i] = x == y ? T(1) : T(0);
+    }
+  }
+
+  for (auto sweep = std::size_t(0); sweep < JacobiSweeps<T>; ++sweep){
+    jacobi_rotate<0, 1>(p);
+    jacobi_rotate<0, 2>(p);
+    jacobi_rotate<1, 2>(p);
+  }
+
+  jacobi_order<0, 1>(p);
+  jacobi_order<1, 2>(p);
+  jacobi_order<0, 1>(p);
+}
+
+//Givens rotation of rows R1 and R2 of b zeroing b[C][R2], accumulated into u
+//so that u * b stays the same:
+template<std::size_t R1, std::size_t R2, std::size_t C, typename T, std::size_t W>
+inline auto givens(mat_packet<T, 3, 3, W>& b, mat_packet<T, 3, 3, W>& u) noexcept{
+  for (auto i : range(W)){
+    const auto x = b[C][R1][i];
+    const auto y = b[C][R2][i];
+    const auto rho = adl_sqrt(x * x + y * y);
+    const auto inverse = T(1) / (rho + Tiny<T>);
+
+    //x = y = 0 leaves the rows as they are:
+    const auto c = x * inverse + (rho > T(0) ? T(0) : T(1));
+    const auto s = y * inverse;
+
+    each3([&](std::size_t k){ rotate_pair(b[k][R1][i], b[k][R2][i], c, -s); });
+    each3([&](std::size_t k){ rotate_pair(u[R1][k][i], u[R2][k][i], c, -s); });
+  }
+}
+
+//Runs a packet decomposition over an array, DecomposeWidth matrices at a time.
+//The last packet is padded with zero matrices:
+template<typename T, typename L, typename Result, typename Kernel>
+inline auto decompose_array(
+  const mat<T, 3, 3, L>* matrices,
+  std::size_t count,
+  Result* results,
+  Kernel kernel
+) noexcept{
+  for (auto first = std::size_t(0); first < count; first += DecomposeWidth){
+    const auto size = count - first < DecomposeWidth ? count - first : DecomposeWidth;
+    auto packet = mat_packet<T, 3, 3, DecomposeWidth>();
+
+    for (auto i : range(size)){
+      packet.set(i, matrices[first + i]);
+    }
+
+    const auto decomposed = kernel(packet);
+
+    for (auto i : range(size)){
+      results[first + i] = decomposed(i);
+    }
+  }
+}
+
+} //namespace detail
+
+//W matrices at once, one lane per matrix:
+template<typename T, std::size_t W>
+inline auto eigen_sym(const mat_packet<T, 3, 3, W>& a) noexcept{
+  auto p = detail::jacobi_packet<T, W>();
+  std::memcpy(p.s, a.data, sizeof(p.s));
+
+  detail::jacobi(p);
+
+  auto result = eigen3_packet<T, W>();
+  std::memcpy(result.vectors.data, p.v, sizeof(p.v));
+
+  for (auto n : range(3)){
+    for (auto i : range(W)){
+      result.values[n][i] = p.s[n][n][i];
+    }
+  }
+
+  return result;
+}
+
+//v from the eigenvectors of a^T a, then the QR decomposition of a * v with
+//Givens rotations gives u and the singular values (McAdams et al. 2011):
+template<typename T, std::size_t W>
+inline auto svd(const mat_packet<T, 3, 3, W>& a) noexcept{
+  auto p = detail::jacobi_packet<T, W>();
+
+  for (const auto& [x, y] : range({ 3, 3 })){
+    for (auto i : range(W)){
+      p.s[x][y][i] = a[x][0][i] * a[y][0][i] + a[x][1][i] * a[y][1][i] + a[x][2][i] * a[y][2][i];
+    }
+  }
+
+  detail::jacobi(p);
+
+  auto result = svd3_packet<T, W>();
+  auto b = mat_packet<T, 3, 3, W>();
+  std::memcpy(result.v.data, p.v, sizeof(p.v));
+
+  for (const auto& [x, y] : range({ 3, 3 })){
+    for (auto i : range(W)){
+      b[x][y][i] = a[0][y][i] * p.v[x][0][i] + a[1][y][i] * p.v[x][1][i] + a[2][y][i] * p.v[x][2][i];
+      result.u[x][y][i] = x == y ? T(1) : T(0);
+    }
+  }
+
+  detail::givens<0, 1, 0>(b, result.u);
+  detail::givens<0, 2, 0>(b, result.u);
+  detail::givens<1, 2, 1>(b, result.u);
+
+  for (auto n : range(3)){
+    for (auto i : range(W)){
+      result.sigma[n][i] = b[n][n][i];
+    }
+  }
+
+  return result;
+}
+
+//rotation = u * v^T, stretch = v * diag(sigma) * v^T, exactly symmetric:
+template<typename T, std::size_t W>
+inline auto polar(const mat_packet<T, 3, 3, W>& a) noexcept{
+  const auto d = svd(a);
+  auto result = polar3_packet<T, W>();
+
+  for (const auto& [x, y] : range({ 3, 3 })){
+    for (auto i : range(W)){
+      result.rotation[x][y][i] =
+        d.u[0][y][i] * d.v[0][x][i] +
+        d.u[1][y][i] * d.v[1][x][i] +
+        d.u[2][y][i] * d.v[2][x][i];
+
+      result.stretch[x][y][i] =
+        d.sigma[0][i] * (d.v[0][x][i] * d.v[0][y][i]) +
+        d.sigma[1][i] * (d.v[1][x][i] * d.v[1][y][i]) +
+        d.sigma[2][i] * (d.v[2][x][i] * d.v[2][y][i]);
+    }
+  }
+
+  return result;
+}
+
+//Single matrices run the packet code with one lane:
+template<typename T, typename L>
+inline auto eigen_sym(const mat<T, 3, 3, L>& a) noexcept{
+  auto packet = mat_packet<T, 3, 3, 1>();
+  packet.set(0, a);
+
+  const auto decomposed = eigen_sym(packet);
+  return eigen3<T>{ decomposed.values.get(0), decomposed.vectors.get(0) };
+}
+
+template<typename T, typename L>
+inline auto svd(const mat<T, 3, 3, L>& a) noexcept{
+  auto packet = mat_packet<T, 3, 3, 1>();
+  packet.set(0, a);
+
+  const auto decomposed = svd(packet);
+  return svd3<T>{ decomposed.u.get(0), decomposed.sigma.get(0), decomposed.v.get(0) };
+}
+
+template<typename T, typename L>
+inline auto polar(const mat<T, 3, 3, L>& a) noexcept{
+  auto packet = mat_packet<T, 3, 3, 1>();
+  packet.set(0, a);
+
+  const auto decomposed = polar(packet);
+  return polar3<T>{ decomposed.rotation.get(0), decomposed.stretch.get(0) };
+}
+
+//Whole arrays, in packets of DecomposeWidth:
+template<typename T, typename L>
+inline auto eigen_sym(const mat<T, 3, 3, L>* matrices, std::size_t count, eigen3<T>* results) noexcept{
+  detail::decompose_array(matrices, count, results, [](const auto& packet){
+    return [decomposed = eigen_sym(packet)](std::size_t i){
+      return eigen3<T>{ decomposed.values.get(i), decomposed.vectors.get(i) };
+    };
+  });
+}
+
+template<typename T, typename L>
+inline auto svd(const mat<T, 3, 3, L>* matrices, std::size_t count, svd3<T>* results) noexcept{
+  detail::decompose_array(matrices, count, results, [](const auto& packet){
+    return [decomposed = svd(packet)](std::size_t i){
+      return svd3<T>{ decomposed.u.get(i), decomposed.sigma.get(i), decomposed.v.get(i) };
+    };
+  });
+}
+
+template<typename T, typename L>
+inline auto polar(const mat<T, 3, 3, L>* matrices, std::size_t count, polar3<T>* results) noexcept{
+  detail::decompose_array(matrices, count, results, [](const auto& packet){
+    return [decomposed = polar(packet)](std::size_t i){
+      return polar3<T>{ decomposed.rotation.get(i), decomposed.stretch.get(i) };
+    };
+  });
+}
+
+} //namespace gf::math
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "math.hpp"
+#include <vector>
+
+namespace gf::math{
+
+namespace detail{
+
+inline constexpr auto ceil_log2(std::uint32_t x) noexcept{
+  auto result = std::uint32_t(0);
+
+  while (result < 32 && (std::uint64_t(1) << result) < x){
+    ++result;
+  }
+
+  return result;
+}
+
+inline constexpr auto mul_high(std::uint32_t a, std::uint32_t b) noexcept{
+  return static_cast<std::uint32_t>((std::uint64_t(a) * b) >> 32);
+}
+
+//All ones for negative values, zero otherwise:
+inline constexpr auto sign_mask(std::int32_t x) noexcept{
+  return std::uint32_t(0) - (static_cast<std::uint32_t>(x) >> 31);
+}
+
+} //namespace detail
+
+//Division by a value only known at runtime, replaced by a multiply and shifts
+//("round up" method, Hacker's Delight 10-9). Meant for dividing many values by
+//the same divisor; signed values are divided by magnitude and rounded toward
+//zero like the built-in operator. Division by zero is undefined.
+template<typename T>
+struct divisor{
+  static_assert(
+    std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>,
+    "divisor is implemented for 32 bit integers"
+  );
+
+  T value;
+  std::uint32_t magic;
+  std::uint32_t pre_shift; //0 for 1, 1 otherwise
+  std::uint32_t post_shift;
+  std::uint32_t sign; //all ones for negative divisors
+  bool power_of_two;
+
+  explicit constexpr divisor(T d) noexcept
+  : value(d), magic(0), pre_shift(0), post_shift(0), sign(0), power_of_two(false){
+    auto magnitude = static_cast<std::uint32_t>(d);
+
+    if constexpr (std::is_signed_v<T>){
+      sign = detail::sign_mask(d);
+      magnitude = (magnitude ^ sign) - sign;
+    }
+
+    const auto log = detail::ceil_log2(magnitude);
+    const auto high = std::uint64_t(1) << log;
+
+    magic = static_cast<std::uint32_t>(((high - magnitude) << 32) / magnitude + 1);
+    pre_shift = log < 1 ? log : 1;
+    post_shift = log < 1 ? 0 : log - 1;
+    power_of_two = high == magnitude;
+  }
+
+  //Quotient of a non-negative magnitude:
+  constexpr auto divide_magnitude(std::uint32_t n) const noexcept{
+    const auto t = detail::mul_high(magic, n);
+    return (t + ((n - t) >> pre_shift)) >> post_shift;
+  }
+
+  constexpr auto divide(T n) const noexcept{
+    if constexpr (std::is_signed_v<T>){
+      const auto n_sign = detail::sign_mask(n);
+      const auto magnitude = (static_cast<std::uint32_t>(n) ^ n_sign) - n_sign;
+      const auto q_sign = n_sign ^ sign;
+
+      return static_cast<T>((divide_magnitude(magnitude) ^ q_sign) - q_sign);
+    }
+    else{
+      return divide_magnitude(n);
+    }
+  }
+
+  constexpr auto modulo(T n) const noexcept{
+    //Wraps around instead of overflowing, the result always fits:
+    return static_cast<T>(
+      static_cast<std::uint32_t>(n) -
+      static_cast<std::uint32_t>(divide(n)) * static_cast<std::uint32_t>(value)
+    );
+  }
+};
+
+template<typename T>
+inline constexpr auto operator/(T n, const divisor<T>& d) noexcept{
+  return d.divide(n);
+}
+
+template<typename T>
+inline constexpr auto operator%(T n, const divisor<T>& d) noexcept{
+  return d.modulo(n);
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto operator/(const vec<T, N>& v, const divisor<T>& d) noexcept{
+  auto result = vec<T, N>();
+
+  for (auto i : range(N)){
+    result[i] = d.divide(v[i]);
+  }
+
+  return result;
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto operator%(const vec<T, N>& v, const divisor<T>& d) noexcept{
+  auto result = vec<T, N>();
+
+  for (auto i : range(N)){
+    result[i] = d.modulo(v[i]);
+  }
+
+  return result;
+}
+
+namespace detail{
+
+//Batched kernels. The loops are branch free so they auto-vectorize; powers of
+//two are split off once per batch and reduce to shifts.
+template<typename T, std::size_t N>
+inline auto divide_batch(
+  const std::vector<vec<T, N>>& values,
+  const divisor<T>& d,
+  std::vector<vec<T, N>>& quotients
+){
+  quotients.resize(values.size());
+
+  if (d.power_of_two){
+    const auto shift = d.pre_shift + d.post_shift;
+
+    for (auto i : range(values.size())){
+      for (auto n : range(N)){
+        const auto x = values[i][n];
+
+        if constexpr (std::is_signed_v<T>){
+          const auto x_sign = sign_mask(x);
+          const auto magnitude = (static_cast<std::uint32_t>(x) ^ x_sign) - x_sign;
+          const auto q_sign = x_sign ^ d.sign;
+
+          quotients[i][n] = static_cast<T>(((magnitude >> shift) ^ q_sign) - q_sign);
+        }
+        else{
+          quotients[i][n] = x >> shift;
+        }
+      }
+    }
+  }
+  else{
+    for (auto i : range(values.size())){
+      for (auto n : range(N)){
+        quotients[i][n] = d.divide(values[i][n]);
+      }
+    }
+  }
+}
+
+} //namespace detail
+
+template<typename T, std::size_t N>
+inline auto divide(const std::vector<vec<T, N>>& values, const divisor<T>& d){
+  auto result = std::vector<vec<T, N>>();
+  detail::divide_batch(values, d, result);
+  return result;
+}
+
+template<typename T, std::size_t N>
+inline auto modulo(const std::vector<vec<T, N>>& values, const divisor<T>& d){
+  auto result = std::vector<vec<T, N>>();
+  detail::divide_batch(values, d, result);
+
+  for (auto i : range(values.size())){
+    for (auto n : range(N)){
+      result[i][n] = static_cast<T>(
+        static_cast<std::uint32_t>(values[i][n]) -
+        static_cast<std::uint32_t>(result[i][n]) * static_cast<std::uint32_t>(d.value)
+      );
+    }
+  }
+
+  return result;
+}
+
+} //namespace gf::math
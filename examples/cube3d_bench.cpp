@@ -0,0 +1,108 @@
+//Headless variant of cube3d: renders N frames of M cubes into an offscreen
+//buffer and reports per-stage frame times.
+//Usage: cube3d_bench [frames = 500] [cubes = 64] [size = 128]
+
+#include "renderer.hpp"
+#include "../bench/bench.hpp"
+#include <cmath>
+#include <cstdlib>
+
+auto main(int argc, char** argv) -> int{
+  const auto frames = argc > 1 ? std::atoi(argv[1]) : 500;
+  const auto cubes = argc > 2 ? std::atoi(argv[2]) : 64;
+  const auto size = argc > 3 ? std::atoi(argv[3]) : 128;
+
+  if (frames <= 0 || cubes <= 0 || size <= 0){
+    std::cerr << "usage: " << argv[0] << " [frames] [cubes] [size]\n";
+    return 1;
+  }
+
+  auto renderer = Renderer(size, size);
+  const auto sides = cube_sides();
+
+  //Cubes are laid out on a square grid in front of the camera:
+  const auto grid = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(cubes))));
+  const auto spacing = 2.f;
+  const auto extent = grid * spacing;
+
+  auto positions = std::vector<m::vec3>();
+  for (auto i : m::range(cubes)){
+    const auto x = static_cast<float>(i % grid);
+    const auto y = static_cast<float>(i / grid);
+
+    positions.push_back(m::vec3(
+      (x - (grid - 1) / 2.f) * spacing,
+      (y - (grid - 1) / 2.f) * spacing,
+      0.f
+    ));
+  }
+
+  renderer.view = m::translation(m::vec3(0.f, 0.f, extent));
+  renderer.projection = m::perspective(1.f, float(m::pi / 2.0), 0.1f, 1000.f);
+
+  auto transform = samples{ "transform", {} };
+  auto cull = samples{ "cull", {} };
+  auto raster = samples{ "raster", {} };
+  auto present = samples{ "present", {} };
+  auto frame = samples{ "frame", {} };
+
+  auto triangles = std::vector<ProjectedTriangle>();
+  triangles.reserve(cubes * sides.size() * 2);
+
+  auto visible = std::vector<ProjectedTriangle>();
+  visible.reserve(triangles.capacity());
+
+  auto angle = 0.f;
+  auto visible_count = std::size_t(0);
+
+  for (auto f = 0; f < frames; ++f){
+    const auto frame_start = bench_clock::now();
+
+    renderer.clear();
+    angle += 0.1f;
+    if (angle > m::pi * 2.0) angle -= m::pi * 2.0;
+
+    measure(transform, [&]{
+      triangles.clear();
+
+      for (auto i : m::range(cubes)){
+        renderer.model 
+          = m::translation(positions[i])
+          * m::rotation(angle + i, m::vec3(0.f, -3.f, 1.f));
+
+        for (const auto& side : sides){
+          triangles.push_back(renderer.transform_triangle(side[0], side[1], side[2]));
+          triangles.push_back(renderer.transform_triangle(side[2], side[3], side[0]));
+        }
+      }
+    });
+
+    measure(cull, [&]{
+      visible.clear();
+
+      for (const auto& triangle : triangles){
+        if (!Renderer::is_culled(triangle)) visible.push_back(triangle);
+      }
+    });
+
+    measure(raster, [&]{
+      for (const auto& triangle : visible){
+        renderer.raster_triangle(triangle);
+      }
+    });
+
+    measure(present, [&]{
+      do_not_optimize(renderer.present().size());
+    });
+
+    frame.add(bench_clock::now() - frame_start);
+    visible_count += visible.size();
+  }
+
+  std::cout 
+    << frames << " frames, " << cubes << " cubes, " 
+    << size << "x" << size << " buffer, "
+    << visible_count / frames << " visible triangles per frame\n";
+
+  report({ transform, cull, raster, present, frame });
+}
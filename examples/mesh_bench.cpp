@@ -0,0 +1,71 @@
+//Headless renderer benchmark on a mesh loaded from a Wavefront OBJ file,
+//like cube3d_bench but with real geometry.
+//Usage: mesh_bench file.obj [frames = 100] [size = 128]
+
+#include "renderer.hpp"
+#include "../obj.hpp"
+#include "../bench/bench.hpp"
+#include <cstdlib>
+
+auto main(int argc, char** argv) -> int{
+  if (argc < 2){
+    std::cerr << "usage: " << argv[0] << " file.obj [frames] [size]\n";
+    return 1;
+  }
+
+  const auto frames = argc > 2 ? std::atoi(argv[2]) : 100;
+  const auto size = argc > 3 ? std::atoi(argv[3]) : 128;
+
+  auto mesh = m::mesh();
+  auto load = samples{ "load", {} };
+
+  auto loaded = false;
+  measure(load, [&]{ loaded = m::load_obj(argv[1], mesh); });
+
+  if (!loaded || frames <= 0 || size <= 0){
+    std::cerr << "can't load " << argv[1] << '\n';
+    return 1;
+  }
+
+  //The mesh is centered and scaled into the unit cube:
+  auto low = mesh.positions.empty() ? m::vec3(0.f) : mesh.positions[0];
+  auto high = low;
+
+  for (const auto& p : mesh.positions){
+    low = m::min(low, p);
+    high = m::max(high, p);
+  }
+
+  const auto extent = m::max(m::max(high.x - low.x, high.y - low.y), m::max(high.z - low.z, 1e-6f));
+  const auto fit = m::scale(m::vec3(1.f / extent)) * m::translation(-(low + high) / 2.f);
+
+  auto renderer = Renderer(size, size);
+  renderer.view = m::translation(m::vec3(0.f, 0.f, 2.f));
+  renderer.projection = m::perspective(1.f, float(m::pi / 2.0), 0.1f, 1000.f);
+
+  auto draw = samples{ "draw_mesh", {} };
+  auto present = samples{ "present", {} };
+
+  auto angle = 0.f;
+
+  for (auto f = 0; f < frames; ++f){
+    renderer.clear();
+    angle += 0.1f;
+
+    renderer.model = m::rotation(angle, m::vec3(0.f, 1.f, 0.f)) * fit;
+
+    measure(draw, [&]{
+      renderer.draw_mesh(mesh.positions, mesh.indices);
+    });
+
+    measure(present, [&]{
+      do_not_optimize(renderer.present().size());
+    });
+  }
+
+  std::cout
+    << mesh.triangle_count() << " triangles, " << frames << " frames, "
+    << size << "x" << size << " buffer\n";
+
+  report({ load, draw, present });
+}
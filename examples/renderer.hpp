@@ -0,0 +1,287 @@
+#pragma once
+
+#include "../math.hpp"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace m = gf::math;
+
+static constexpr auto PixelWhite = "\u2588\u2588";
+static constexpr auto PixelLightGray = "\u2593\u2593";
+static constexpr auto PixelGray = "\u2592\u2592";
+static constexpr auto PixelDark = "\u2591\u2591";
+
+//Triangle after the transform stage, ready for culling and rasterization:
+struct ProjectedTriangle{
+  m::vec3 normal;
+  m::vec3 view_point;
+  std::array<m::vec2, 3> points;
+};
+
+struct Renderer{
+private:
+  int width = 0, height = 0;
+  std::string buffer;
+  std::string frame;
+  char null;
+
+public:
+  bool debug = false;
+  m::mat4 model = m::mat4(1.f);
+  m::mat4 view = m::mat4(1.f);
+  m::mat4 projection = m::mat4(1.f);
+
+  Renderer(int width, int height) : width(width), height(height){
+    buffer.resize(width * height, ' ');
+  }
+
+  auto& at(const m::ivec2& coords){
+    const auto [x, y] = coords;
+
+    if (y < 0 || y >= height) return null;
+    if (x < 0 || x >= width) return null;
+
+    return buffer[y * width + x];
+  }
+
+  const auto& at(const m::ivec2& coords) const{
+    return const_cast<Renderer*>(this)->at(coords);
+  }
+
+  auto clear(){
+    buffer = std::string(width * height, ' ');
+  }
+
+  auto size() const{
+    return m::ivec2(width, height);
+  }
+
+  //Converts the pixel buffer into printable glyphs, without any terminal I/O:
+  auto present() -> const std::string&{
+    frame.clear();
+
+    for (int y = 0; y < height; ++y){
+      for (int x = 0; x < width; ++x){
+        const auto pixel = at(m::ivec2(x, y));
+
+        if (pixel == '0'){
+          frame += PixelWhite;
+        }
+        else if (pixel == '1'){
+          frame += PixelLightGray;
+        }
+        else if (pixel == '2'){
+          frame += PixelGray;
+        }
+        else if (pixel == '3'){
+          frame += PixelDark;
+        }
+        else frame += "  ";
+      }
+      frame += '\n';
+    }
+
+    return frame;
+  }
+
+  auto render_buffer(){
+    std::cout << present();
+  }
+
+  auto draw_point(const m::vec2& point){
+    const auto center = size() / 2;
+
+    auto position = center + m::ivec2(
+      m::round(m::vec2(center) * point)
+    );
+
+    at(position) = '@';
+  }
+
+  auto make_line(const m::vec2& p1, const m::vec2& p2){
+    auto points = std::vector<m::ivec2>();
+
+    auto origin = m::ivec2(
+      (p1 + 1.f) * m::vec2(width, height) / 2.f
+    );
+
+    auto target = m::ivec2(
+      (p2 + 1.f) * m::vec2(width, height) / 2.f
+    );
+
+    if (origin.x > target.x) std::swap(origin, target);
+
+    const auto [width, height] = m::abs(origin - target);
+    const auto ratio = std::abs(static_cast<float>(width) / height);
+
+    const auto direction = origin.y < target.y ? 1 : -1;
+
+    if (ratio > 1.0){
+      for (int i = 0; i != width; i++){
+        points.push_back(origin + m::ivec2(i, static_cast<int>(i / ratio) * direction));
+      }
+    }
+    else{
+      for (int i = 0; i != height * direction; i += direction){
+        points.push_back(origin + m::ivec2(static_cast<int>(i * ratio) * direction, i));
+      }
+    }
+
+    points.push_back(target);
+
+    return points;
+  }
+
+  auto project_point(const m::vec3& point){
+    //Evaluated right to left, as three matrix-vector products:
+    const auto projected_vec4 = m::chain(projection, view, model, point.as_vec<4>(1.f)).eval();
+    return projected_vec4.xy() / projected_vec4.w;
+  }
+
+  auto draw_line(const m::vec2& p1, const m::vec2& p2){
+    for (const auto& point : make_line(p1, p2)){
+      at(point) = '@';
+    }
+  }
+
+  //Transform stage: face normal, view space position and screen projection.
+  auto transform_triangle(
+    const m::vec3& p1,
+    const m::vec3& p2,
+    const m::vec3& p3
+  ){
+    const auto v1 = model * (p1 - p2).as_vec<4>(1.f);
+    const auto v2 = model * (p1 - p3).as_vec<4>(1.f);
+    const auto normal = m::cross(v1.xyz(), v2.xyz());
+
+    const auto point_3d = m::chain(view, model, p1.as_vec<4>(1.f)).eval();
+
+    return ProjectedTriangle{
+      normal,
+      point_3d.xyz(),
+      std::array{
+        project_point(p1),
+        project_point(p2),
+        project_point(p3)
+      }
+    };
+  }
+
+  //Cull stage: back faces are skipped.
+  static auto is_culled(const ProjectedTriangle& triangle){
+    return m::dot(triangle.view_point, triangle.normal) > 0.f;
+  }
+
+  //Raster stage: scanline fill of the projected triangle.
+  auto raster_triangle(const ProjectedTriangle& triangle){
+    const auto& projected = triangle.points;
+
+    const auto l1 = make_line(projected[0], projected[1]);
+    const auto l2 = make_line(projected[1], projected[2]);
+    const auto l3 = make_line(projected[2], projected[0]);
+
+    auto fill = std::unordered_map<int, std::vector<int>>();
+
+    for (auto [x, y] : l1){
+      fill[y].push_back(x);
+    }
+
+    for (auto [x, y] : l2){
+      fill[y].push_back(x);
+    }
+
+    for (auto [x, y] : l3){
+      fill[y].push_back(x);
+    }
+
+    const auto camera = m::vec3(0.0, 0.0, 1.0);
+    const auto shade_color = m::abs(m::dot(camera, triangle.normal.normalized()));
+
+    auto pixel = '0';
+    if (shade_color < 0.75) pixel = '1';
+    if (shade_color < 0.50) pixel = '2';
+    if (shade_color < 0.25) pixel = '3';
+
+    for (auto y : m::range(height)){
+      if (fill.find(y) == fill.end()) continue;
+      const auto& row = fill[y];
+
+      const auto [fill_from, fill_to] = std::minmax_element(row.begin(), row.end());
+
+      for (auto i : m::range(*fill_from, *fill_to)){
+        at(m::ivec2(i, y)) = pixel;
+      }
+    }
+  }
+
+  auto draw_triangle(
+    const m::vec3& p1,
+    const m::vec3& p2,
+    const m::vec3& p3
+  ){
+    const auto triangle = transform_triangle(p1, p2, p3);
+    if (is_culled(triangle)) return;
+
+    raster_triangle(triangle);
+  }
+
+  //Indexed triangles, e.g. a mesh loaded with obj.hpp:
+  auto draw_mesh(
+    const std::vector<m::vec3>& positions,
+    const std::vector<std::uint32_t>& indices
+  ){
+    for (auto i : m::range(indices.size() / 3)){
+      draw_triangle(
+        positions[indices[i * 3]],
+        positions[indices[i * 3 + 1]],
+        positions[indices[i * 3 + 2]]
+      );
+    }
+  }
+};
+
+inline auto cube_sides(){
+  return std::array{
+    std::array{ //FRONT
+      m::vec3(-0.5, -0.5, 0.5),
+      m::vec3(0.5, -0.5, 0.5),
+      m::vec3(0.5, 0.5, 0.5),
+      m::vec3(-0.5, 0.5, 0.5)
+    },
+    std::array{ //BACK
+      m::vec3(-0.5, 0.5, -0.5),
+      m::vec3(0.5, 0.5, -0.5),
+      m::vec3(0.5, -0.5, -0.5),
+      m::vec3(-0.5, -0.5, -0.5)
+    },
+    std::array{ //LEFT
+      m::vec3(-0.5, 0.5, 0.5),
+      m::vec3(-0.5, 0.5, -0.5),
+      m::vec3(-0.5, -0.5, -0.5),
+      m::vec3(-0.5, -0.5, 0.5)
+    },
+    std::array{ //RIGHT
+      m::vec3(0.5, -0.5, 0.5),
+      m::vec3(0.5, -0.5, -0.5),
+      m::vec3(0.5, 0.5, -0.5),
+      m::vec3(0.5, 0.5, 0.5)
+    },
+    std::array{ //TOP
+      m::vec3(-0.5, -0.5, -0.5),
+      m::vec3(0.5, -0.5, -0.5),
+      m::vec3(0.5, -0.5, 0.5),
+      m::vec3(-0.5, -0.5, 0.5)
+    },
+    std::array{ //BOTTOM
+      m::vec3(-0.5, 0.5, 0.5),
+      m::vec3(0.5, 0.5, 0.5),
+      m::vec3(0.5, 0.5, -0.5),
+      m::vec3(-0.5, 0.5, -0.5)
+    },
+  };
+}
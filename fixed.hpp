@@ -0,0 +1,279 @@
+#pragma once
+
+#include "math.hpp"
+#include <limits>
+#include <vector>
+
+namespace gf::math{
+
+namespace detail{
+
+#ifdef __SIZEOF_INT128__
+using int128 = __int128;
+using uint128 = unsigned __int128;
+inline constexpr auto HasInt128 = true;
+#else
+using int128 = std::int64_t;
+using uint128 = std::uint64_t;
+inline constexpr auto HasInt128 = false;
+#endif
+
+//Digit by digit square root, exact floor(sqrt(n)):
+template<typename U>
+inline constexpr auto isqrt(U n) noexcept{
+  auto result = U(0);
+  auto bit = U(1) << (sizeof(U) * 8 - 2);
+
+  while (bit > n) bit >>= 2;
+
+  while (bit != 0){
+    if (n >= result + bit){
+      n -= result + bit;
+      result = (result >> 1) + bit;
+    }
+    else{
+      result >>= 1;
+    }
+
+    bit >>= 2;
+  }
+
+  return result;
+}
+
+} //namespace detail
+
+//Signed fixed point number with IntBits integer bits (sign included) and
+//FracBits fractional bits. Every operation is done on integers, so results are
+//bit identical on every platform. Up to 32 bits are stored in int32_t with
+//int64_t intermediates, up to 64 bits need a compiler with __int128.
+//Overflow wraps around; multiplication rounds down, division toward zero.
+template<int IntBits, int FracBits>
+struct fixed{
+  static constexpr auto Bits = IntBits + FracBits;
+
+  static_assert(IntBits > 0 && FracBits >= 0 && Bits <= 64, "fixed holds at most 64 bits");
+  static_assert(Bits <= 32 || detail::HasInt128, "fixed wider than 32 bits needs __int128");
+
+  using storage_type = std::conditional_t<Bits <= 32, std::int32_t, std::int64_t>;
+  using unsigned_type = std::make_unsigned_t<storage_type>;
+  using wide_type = std::conditional_t<Bits <= 32, std::int64_t, detail::int128>;
+  using unsigned_wide_type = std::conditional_t<Bits <= 32, std::uint64_t, detail::uint128>;
+
+  static constexpr auto One = storage_type(1) << FracBits;
+
+  storage_type raw;
+
+  fixed() = default;
+
+  template<typename Int, typename = std::enable_if_t<std::is_integral_v<Int>>>
+  constexpr fixed(Int value) noexcept
+  : raw(static_cast<storage_type>(static_cast<unsigned_type>(value) * static_cast<unsigned_type>(One))) {}
+
+  //Rounds to the nearest representable value:
+  explicit constexpr fixed(double value) noexcept
+  : raw(static_cast<storage_type>(value * One + (value >= 0.0 ? 0.5 : -0.5))) {}
+
+  //Dropped fractional bits round down:
+  template<int I2, int F2>
+  explicit constexpr fixed(fixed<I2, F2> other) noexcept : raw(0){
+    using wide = std::int64_t;
+
+    if constexpr (F2 >= FracBits){
+      raw = static_cast<storage_type>(wide(other.raw) >> (F2 - FracBits));
+    }
+    else{
+      raw = static_cast<storage_type>(std::uint64_t(wide(other.raw)) << (FracBits - F2));
+    }
+  }
+
+  static constexpr auto from_raw(storage_type raw) noexcept{
+    auto result = fixed();
+    result.raw = raw;
+    return result;
+  }
+
+  explicit constexpr operator double() const noexcept{
+    return double(raw) / One;
+  }
+
+  explicit constexpr operator float() const noexcept{
+    return float(double(*this));
+  }
+
+  //Rounds toward negative infinity:
+  constexpr auto to_int() const noexcept{
+    return static_cast<storage_type>(raw >> FracBits);
+  }
+
+  friend constexpr auto operator+(fixed a, fixed b) noexcept{
+    return from_raw(static_cast<storage_type>(unsigned_type(a.raw) + unsigned_type(b.raw)));
+  }
+
+  friend constexpr auto operator-(fixed a, fixed b) noexcept{
+    return from_raw(static_cast<storage_type>(unsigned_type(a.raw) - unsigned_type(b.raw)));
+  }
+
+  friend constexpr auto operator-(fixed a) noexcept{
+    return from_raw(static_cast<storage_type>(unsigned_type(0) - unsigned_type(a.raw)));
+  }
+
+  friend constexpr auto operator*(fixed a, fixed b) noexcept{
+    return from_raw(static_cast<storage_type>((wide_type(a.raw) * b.raw) >> FracBits));
+  }
+
+  friend constexpr auto operator/(fixed a, fixed b) noexcept{
+    return from_raw(static_cast<storage_type>((wide_type(a.raw) * One) / b.raw));
+  }
+
+  friend constexpr auto operator==(fixed a, fixed b) noexcept{ return a.raw == b.raw; }
+  friend constexpr auto operator!=(fixed a, fixed b) noexcept{ return a.raw != b.raw; }
+  friend constexpr auto operator<(fixed a, fixed b) noexcept{ return a.raw < b.raw; }
+  friend constexpr auto operator<=(fixed a, fixed b) noexcept{ return a.raw <= b.raw; }
+  friend constexpr auto operator>(fixed a, fixed b) noexcept{ return a.raw > b.raw; }
+  friend constexpr auto operator>=(fixed a, fixed b) noexcept{ return a.raw >= b.raw; }
+
+  constexpr auto& operator+=(fixed other) noexcept{ return (*this) = (*this) + other; }
+  constexpr auto& operator-=(fixed other) noexcept{ return (*this) = (*this) - other; }
+  constexpr auto& operator*=(fixed other) noexcept{ return (*this) = (*this) * other; }
+  constexpr auto& operator/=(fixed other) noexcept{ return (*this) = (*this) / other; }
+};
+
+using fixed16 = fixed<16, 16>;
+using fixed32 = fixed<32, 32>;
+
+template<int I, int F>
+inline constexpr auto abs(fixed<I, F> x) noexcept{
+  return x.raw < 0 ? -x : x;
+}
+
+template<int I, int F>
+inline constexpr auto floor(fixed<I, F> x) noexcept{
+  using type = fixed<I, F>;
+  return type::from_raw(static_cast<typename type::storage_type>(x.raw & ~(type::One - 1)));
+}
+
+template<int I, int F>
+inline constexpr auto ceil(fixed<I, F> x) noexcept{
+  return -math::floor(-x);
+}
+
+template<int I, int F>
+inline constexpr auto trunc(fixed<I, F> x) noexcept{
+  return x.raw < 0 ? math::ceil(x) : math::floor(x);
+}
+
+//Halfway cases round away from zero, like std::round:
+template<int I, int F>
+inline constexpr auto round(fixed<I, F> x) noexcept{
+  using type = fixed<I, F>;
+  const auto half = type::from_raw(type::One / 2);
+  return x.raw < 0 ? -math::floor(-x + half) : math::floor(x + half);
+}
+
+//Exact: the largest representable value not above the real square root. Negative values give 0.
+template<int I, int F>
+inline constexpr auto sqrt(fixed<I, F> x) noexcept{
+  using type = fixed<I, F>;
+  using wide = typename type::unsigned_wide_type;
+
+  if (x.raw <= 0) return type(0);
+
+  const auto root = detail::isqrt(wide(x.raw) << F);
+  return type::from_raw(static_cast<typename type::storage_type>(root));
+}
+
+//Taylor series on [-pi/2, pi/2], evaluated in fixed point. Needs at least 4 integer bits.
+template<int I, int F>
+inline constexpr auto sin(fixed<I, F> x) noexcept{
+  using type = fixed<I, F>;
+
+  const auto half_turn = type(math::pi);
+  const auto quarter_turn = type(math::pi / 2.0);
+  const auto turn = type(math::pi * 2.0);
+
+  //Into [-pi, pi]:
+  x = x - turn * math::round(x / turn);
+
+  //Into [-pi/2, pi/2], sin(pi - x) = sin(x):
+  if (x > quarter_turn) x = half_turn - x;
+  if (x < -quarter_turn) x = -half_turn - x;
+
+  const auto x2 = x * x;
+
+  auto result = type(1) - x2 / type(110);
+  for (auto d : { 72, 42, 20, 6 }){
+    result = type(1) - x2 / type(d) * result;
+  }
+
+  return x * result;
+}
+
+template<int I, int F>
+inline constexpr auto cos(fixed<I, F> x) noexcept{
+  using type = fixed<I, F>;
+  return math::sin(x + type(math::pi / 2.0));
+}
+
+namespace detail{
+
+//The widened accumulator of a fixed point number has 32 more integer bits, as far as 64 bits go:
+template<int I, int F>
+struct wider<fixed<I, F>>{
+  using type = fixed<(I + F + 32 <= 64 ? I + 32 : 64 - F), F>;
+};
+
+} //namespace detail
+
+//Batched kernels on the raw integers, plain loops that vectorize:
+
+//positions[i] += velocities[i] * dt, the usual integration step:
+template<int I, int F, std::size_t N>
+inline auto mul_add(
+  std::vector<vec<fixed<I, F>, N>>& positions,
+  const std::vector<vec<fixed<I, F>, N>>& velocities,
+  fixed<I, F> dt
+){
+  using type = fixed<I, F>;
+  using wide = typename type::wide_type;
+  using storage = typename type::storage_type;
+  using unsigned_type = typename type::unsigned_type;
+
+  for (auto i : range(positions.size())){
+    for (auto n : range(N)){
+      const auto step = static_cast<storage>((wide(velocities[i][n].raw) * dt.raw) >> F);
+      positions[i][n].raw = static_cast<storage>(unsigned_type(positions[i][n].raw) + unsigned_type(step));
+    }
+  }
+}
+
+//Affine transform of points (w = 1), same results as transform * point.as_vec<4>(1):
+template<int I, int F>
+inline auto transform(
+  const mat<fixed<I, F>, 4, 4>& transform,
+  const std::vector<vec<fixed<I, F>, 3>>& points
+){
+  using type = fixed<I, F>;
+  using wide = typename type::wide_type;
+  using storage = typename type::storage_type;
+  using unsigned_type = typename type::unsigned_type;
+
+  auto result = std::vector<vec<type, 3>>(points.size());
+
+  for (auto i : range(points.size())){
+    for (auto row : range(3)){
+      //Every product is rounded on its own, exactly like the scalar code:
+      auto sum = unsigned_type(transform[3][row].raw);
+
+      for (auto column : range(3)){
+        sum += unsigned_type(static_cast<storage>((wide(transform[column][row].raw) * points[i][column].raw) >> F));
+      }
+
+      result[i][row].raw = static_cast<storage>(sum);
+    }
+  }
+
+  return result;
+}
+
+} //namespace gf::math
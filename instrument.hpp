@@ -0,0 +1,304 @@
+#pragma once
+
+//Instrumentation of math.hpp: define GEFEC_MATH_INSTRUMENT before including
+//it and every operator and function family counts its calls, per thread,
+//and can check its results for NaN and infinity. Only the outermost call is
+//counted: normalized() is one normalize, not a length and a division.
+//Without the define math.hpp doesn't include this and nothing is traced.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace gf::math::instrument{
+
+enum class op{
+  vec_add,        //+ and - of vectors and scalars, negation, += and -=
+  vec_multiply,   //* and *= of vectors and scalars
+  vec_divide,     //division and % of vectors and scalars, /=
+  dot,
+  cross,
+  length,         //len(), len_squared() and distance_squared()
+  normalize,
+  sum,
+  compare,        //==, !=, less() ... nearly_equal(), compare() and select()
+  component,      //abs, round, trunc, floor, ceil, min, max and clamp of vectors and matrices
+  transcendental, //sin, cos, sincos, tan, atan2, exp, log and pow of vectors and matrices
+  mat_add,        //+ and - of matrices and scalars, negation, += and -=
+  mat_scale,      //products with and divisions by scalars, *= and /= by scalars
+  mat_multiply,   //matrix products and divisions, *= and /= by matrices
+  mat_vec,        //matrix-vector products and divisions, v *= m and v /= m
+  transpose,
+  det,
+  transform       //translation, scale, rotation, perspective and ortho
+};
+
+inline constexpr auto OpCount = std::size_t(op::transform) + 1;
+
+inline constexpr auto op_name(op family) noexcept{
+  constexpr const char* Names[OpCount] = {
+    "vec_add", "vec_multiply", "vec_divide", "dot", "cross", "length", "normalize", "sum",
+    "compare", "component", "transcendental", "mat_add", "mat_scale", "mat_multiply", "mat_vec", "transpose",
+    "det", "transform"
+  };
+
+  return Names[std::size_t(family)];
+}
+
+//A place in the program, recorded by checkpoint():
+struct location{
+  const char* label = "";
+  const char* file = "";
+  unsigned line = 0;
+};
+
+//Calls of each family, and how many of them returned NaN or infinity:
+struct counts{
+  std::uint64_t calls[OpCount] = {};
+  std::uint64_t non_finite[OpCount] = {};
+
+  auto operator[](op family) const noexcept{
+    return calls[std::size_t(family)];
+  }
+
+  auto& operator+=(const counts& other) noexcept{
+    for (auto i = std::size_t(0); i < OpCount; ++i){
+      calls[i] += other.calls[i];
+      non_finite[i] += other.non_finite[i];
+    }
+
+    return *this;
+  }
+};
+
+//A result with a NaN or infinite component. call is the number of calls of
+//the family the thread had made, checkpoint the thread's last checkpoint:
+struct non_finite_event{
+  op family;
+  std::uint64_t call;
+  location checkpoint;
+};
+
+using non_finite_handler = void(*)(const non_finite_event&);
+
+namespace detail{
+
+struct thread_state;
+
+//Every thread that has traced something, and the counts of finished threads:
+struct registry{
+  std::mutex mutex;
+  std::vector<thread_state*> threads;
+  counts finished;
+  std::optional<non_finite_event> first;
+  std::atomic<bool> check_finite{ false };
+  std::atomic<non_finite_handler> handler{ nullptr };
+};
+
+inline auto global() -> registry&{
+  static auto r = registry();
+  return r;
+}
+
+//Only the owning thread writes its counters; the relaxed atomics let other
+//threads read them for a report without a lock or a locked add:
+inline auto increment(std::atomic<std::uint64_t>& counter) noexcept{
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+struct thread_state{
+  std::atomic<std::uint64_t> calls[OpCount] = {};
+  std::atomic<std::uint64_t> non_finite[OpCount] = {};
+  std::size_t depth = 0;
+  location checkpoint;
+
+  thread_state(){
+    auto& r = global();
+    const auto lock = std::lock_guard(r.mutex);
+    r.threads.push_back(this);
+  }
+
+  ~thread_state(){
+    auto& r = global();
+    const auto lock = std::lock_guard(r.mutex);
+
+    r.finished += snapshot();
+
+    for (auto& t : r.threads){
+      if (t == this){
+        t = r.threads.back();
+        r.threads.pop_back();
+        break;
+      }
+    }
+  }
+
+  auto snapshot() const noexcept -> counts{
+    auto result = counts();
+
+    for (auto i = std::size_t(0); i < OpCount; ++i){
+      result.calls[i] = calls[i].load(std::memory_order_relaxed);
+      result.non_finite[i] = non_finite[i].load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+  auto clear() noexcept{
+    for (auto i = std::size_t(0); i < OpCount; ++i){
+      calls[i].store(0, std::memory_order_relaxed);
+      non_finite[i].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+inline auto state() -> thread_state&{
+  thread_local auto s = thread_state();
+  return s;
+}
+
+//True when this is the outermost traced call, the one that is counted:
+inline auto enter(op family) -> bool{
+  auto& s = state();
+  if (s.depth++ != 0) return false;
+
+  increment(s.calls[std::size_t(family)]);
+  return true;
+}
+
+inline auto leave() noexcept{
+  --state().depth;
+}
+
+inline auto checking() noexcept{
+  return global().check_finite.load(std::memory_order_relaxed);
+}
+
+inline auto report_non_finite(op family){
+  auto& s = state();
+  increment(s.non_finite[std::size_t(family)]);
+
+  const auto event = non_finite_event{
+    family, s.calls[std::size_t(family)].load(std::memory_order_relaxed), s.checkpoint
+  };
+
+  auto& r = global();
+
+  {
+    const auto lock = std::lock_guard(r.mutex);
+    if (!r.first) r.first = event;
+  }
+
+  if (const auto handler = r.handler.load()) handler(event);
+}
+
+} //namespace detail
+
+//Counts of the calling thread:
+inline auto thread_counts() -> counts{
+  return detail::state().snapshot();
+}
+
+//Counts of every thread, running or finished:
+inline auto total_counts() -> counts{
+  auto& r = detail::global();
+  const auto lock = std::lock_guard(r.mutex);
+
+  auto result = r.finished;
+
+  for (const auto* t : r.threads){
+    result += t->snapshot();
+  }
+
+  return result;
+}
+
+//Zeroes every counter and forgets the first non-finite result; checkpoints
+//are kept. Calls that other threads make at the same time may survive it:
+inline auto reset(){
+  auto& r = detail::global();
+  const auto lock = std::lock_guard(r.mutex);
+
+  r.finished = counts();
+  r.first.reset();
+
+  for (auto* t : r.threads){
+    t->clear();
+  }
+}
+
+//Checks every traced result for NaN and infinity, off by default:
+inline auto check_finite(bool enabled) noexcept{
+  detail::global().check_finite.store(enabled);
+}
+
+//Operators can't take a source location, so non-finite results report the
+//last checkpoint of their thread; put checkpoints around suspect code:
+inline auto checkpoint(
+  const char* label = "",
+  const char* file = __builtin_FILE(),
+  unsigned line = __builtin_LINE()
+){
+  detail::state().checkpoint = location{ label, file, line };
+}
+
+inline auto first_non_finite() -> std::optional<non_finite_event>{
+  auto& r = detail::global();
+  const auto lock = std::lock_guard(r.mutex);
+  return r.first;
+}
+
+//Called on every non-finite result (on the thread that produced it), e.g.
+//to stop in a debugger at the first NaN. nullptr removes the handler:
+inline auto on_non_finite(non_finite_handler handler) noexcept{
+  detail::global().handler.store(handler);
+}
+
+//A table of every family called so far on any thread, the busiest first:
+inline auto report(std::ostream& out) -> std::ostream&{
+  const auto totals = total_counts();
+
+  std::size_t order[OpCount];
+
+  for (auto i = std::size_t(0); i < OpCount; ++i){
+    order[i] = i;
+  }
+
+  for (auto i = std::size_t(1); i < OpCount; ++i){
+    for (auto j = i; j > 0 && totals.calls[order[j]] > totals.calls[order[j - 1]]; --j){
+      std::swap(order[j], order[j - 1]);
+    }
+  }
+
+  out
+    << std::left << std::setw(16) << "family"
+    << std::right << std::setw(16) << "calls"
+    << std::setw(16) << "non-finite" << '\n';
+
+  for (auto i : order){
+    if (totals.calls[i] == 0) continue;
+
+    out
+      << std::left << std::setw(16) << op_name(op(i))
+      << std::right << std::setw(16) << totals.calls[i]
+      << std::setw(16) << totals.non_finite[i] << '\n';
+  }
+
+  if (const auto first = first_non_finite()){
+    const auto& at = first->checkpoint;
+    out << "first non-finite: " << op_name(first->family) << " call " << first->call;
+
+    if (at.line == 0) out << ", no checkpoint before it\n";
+    else out << ", after checkpoint \"" << at.label << "\" at " << at.file << ':' << at.line << '\n';
+  }
+
+  return out;
+}
+
+} //namespace gf::math::instrument
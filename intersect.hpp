@@ -0,0 +1,512 @@
+#pragma once
+
+#include "math.hpp"
+#include <limits>
+
+namespace gf::math{
+
+namespace detail{
+
+//Plain ternaries, so that the packet loops below lower to min/max instructions:
+template<typename T>
+inline constexpr auto lane_min(T a, T b) noexcept{
+  return a < b ? a : b;
+}
+
+template<typename T>
+inline constexpr auto lane_max(T a, T b) noexcept{
+  return a > b ? a : b;
+}
+
+//Per-lane hit flags are kept as integers of the same width as T, so that the
+//flag stores don't limit the vector width of the packet loops:
+template<typename T>
+using lane_flag = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+
+template<typename F, std::size_t W>
+inline constexpr auto to_mask(const F (&lanes)[W]) noexcept{
+  static_assert(W <= 32, "hit masks hold at most 32 lanes");
+
+  auto mask = std::uint32_t(0);
+
+  for (auto i : range(W)){
+    mask |= static_cast<std::uint32_t>(lanes[i] != 0) << i;
+  }
+
+  return mask;
+}
+
+template<std::size_t W, typename T>
+inline constexpr auto nearest_lane(std::uint32_t mask, const T (&t)[W]) noexcept{
+  auto best = W;
+
+  for (auto i : range(W)){
+    if (((mask >> i) & 1u) && (best == W || t[i] < t[best])){
+      best = i;
+    }
+  }
+
+  return best;
+}
+
+} //namespace detail
+
+template<typename T>
+struct ray{
+  vec<T, 3> origin;
+  vec<T, 3> direction;
+
+  constexpr auto at(T t) const noexcept{
+    return origin + direction * t;
+  }
+};
+
+using fray = ray<float>;
+using dray = ray<double>;
+
+//Axis aligned bounding box. A default constructed box is empty (min > max),
+//so extending it with the first point or box yields that point or box.
+template<typename T>
+struct aabb{
+  vec<T, 3> min = vec<T, 3>(std::numeric_limits<T>::max());
+  vec<T, 3> max = vec<T, 3>(std::numeric_limits<T>::lowest());
+
+  constexpr auto is_empty() const noexcept{
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+  }
+
+  //Spelled out per component, builders call these millions of times:
+  constexpr auto& extend(const vec<T, 3>& point) noexcept{
+    for (auto i : range(3)){
+      min[i] = detail::lane_min(min[i], point[i]);
+      max[i] = detail::lane_max(max[i], point[i]);
+    }
+
+    return *this;
+  }
+
+  constexpr auto& extend(const aabb& other) noexcept{
+    for (auto i : range(3)){
+      min[i] = detail::lane_min(min[i], other.min[i]);
+      max[i] = detail::lane_max(max[i], other.max[i]);
+    }
+
+    return *this;
+  }
+
+  constexpr auto size() const noexcept{
+    return max - min;
+  }
+
+  constexpr auto center() const noexcept{
+    return (min + max) / T(2);
+  }
+
+  constexpr auto surface_area() const noexcept{
+    if (is_empty()) return T(0);
+
+    const auto x = max.x - min.x;
+    const auto y = max.y - min.y;
+    const auto z = max.z - min.z;
+
+    return T(2) * (x * y + y * z + z * x);
+  }
+
+  //Index of the longest axis:
+  constexpr auto major_axis() const noexcept{
+    const auto x = max.x - min.x;
+    const auto y = max.y - min.y;
+    const auto z = max.z - min.z;
+
+    if (x >= y && x >= z) return std::size_t(0);
+    return y >= z ? std::size_t(1) : std::size_t(2);
+  }
+
+  constexpr auto contains(const vec<T, 3>& point) const noexcept{
+    return
+      point.x >= min.x && point.x <= max.x &&
+      point.y >= min.y && point.y <= max.y &&
+      point.z >= min.z && point.z <= max.z;
+  }
+};
+
+template<typename T>
+inline constexpr auto overlaps(const aabb<T>& a, const aabb<T>& b) noexcept{
+  return
+    a.min.x <= b.max.x && a.max.x >= b.min.x &&
+    a.min.y <= b.max.y && a.max.y >= b.min.y &&
+    a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+//View frustum as six inward facing planes (xyz = normal, w = distance),
+//extracted from a projection * view matrix that maps column vectors to clip
+//space with -w <= x, y <= w and 0 <= z <= w:
+template<typename T>
+struct frustum{
+  vec<T, 4> planes[6];
+
+  constexpr frustum() noexcept = default;
+
+  template<typename L>
+  explicit constexpr frustum(const mat<T, 4, 4, L>& view_projection) noexcept{
+    const auto x = view_projection.row(0);
+    const auto y = view_projection.row(1);
+    const auto z = view_projection.row(2);
+    const auto w = view_projection.row(3);
+
+    planes[0] = w + x;
+    planes[1] = w - x;
+    planes[2] = w + y;
+    planes[3] = w - y;
+    planes[4] = z;
+    planes[5] = w - z;
+  }
+};
+
+//Conservative test: may report boxes near the frustum corners as visible.
+template<typename T>
+inline constexpr auto overlaps(const frustum<T>& f, const aabb<T>& box) noexcept{
+  for (const auto& plane : f.planes){
+    const auto farthest = vec<T, 3>(
+      plane.x >= T(0) ? box.max.x : box.min.x,
+      plane.y >= T(0) ? box.max.y : box.min.y,
+      plane.z >= T(0) ? box.max.z : box.min.z
+    );
+
+    if (dot(plane.xyz(), farthest) + plane.w < T(0)) return false;
+  }
+
+  return true;
+}
+
+//W rays, with inverse directions precomputed for the slab test:
+template<typename T, std::size_t W>
+struct ray_packet{
+  vec_packet<T, 3, W> origin;
+  vec_packet<T, 3, W> direction;
+  vec_packet<T, 3, W> inv_direction;
+
+  constexpr auto set(std::size_t lane, const ray<T>& r) noexcept{
+    origin.set(lane, r.origin);
+    direction.set(lane, r.direction);
+    inv_direction.set(lane, T(1) / r.direction);
+  }
+
+  constexpr auto get(std::size_t lane) const noexcept{
+    return ray<T>{ origin.get(lane), direction.get(lane) };
+  }
+};
+
+//W triangles stored as first vertex and two edges (Moller-Trumbore layout):
+template<typename T, std::size_t W>
+struct triangle_packet{
+  vec_packet<T, 3, W> v0;
+  vec_packet<T, 3, W> e1;
+  vec_packet<T, 3, W> e2;
+
+  constexpr auto set(
+    std::size_t lane,
+    const vec<T, 3>& a,
+    const vec<T, 3>& b,
+    const vec<T, 3>& c
+  ) noexcept{
+    v0.set(lane, a);
+    e1.set(lane, b - a);
+    e2.set(lane, c - a);
+  }
+};
+
+template<typename T, std::size_t W>
+struct box_packet{
+  vec_packet<T, 3, W> min;
+  vec_packet<T, 3, W> max;
+
+  constexpr auto set(std::size_t lane, const vec<T, 3>& lo, const vec<T, 3>& hi) noexcept{
+    min.set(lane, lo);
+    max.set(lane, hi);
+  }
+};
+
+//Bit i of mask is set when lane i hit; t, u and v are only meaningful for those lanes.
+template<typename T, std::size_t W>
+struct triangle_hits{
+  std::uint32_t mask = 0;
+  T t[W] = {};
+  T u[W] = {};
+  T v[W] = {};
+
+  constexpr auto any() const noexcept{
+    return mask != 0;
+  }
+
+  //Lane of the closest hit, or W when nothing was hit:
+  constexpr auto nearest() const noexcept{
+    return detail::nearest_lane(mask, t);
+  }
+};
+
+//t holds the entry distance of every lane that hit its box.
+template<typename T, std::size_t W>
+struct box_hits{
+  std::uint32_t mask = 0;
+  T t[W] = {};
+
+  constexpr auto any() const noexcept{
+    return mask != 0;
+  }
+
+  constexpr auto nearest() const noexcept{
+    return detail::nearest_lane(mask, t);
+  }
+};
+
+namespace detail{
+
+template<typename T>
+struct triangle_lane{
+  bool hit;
+  T t, u, v;
+};
+
+//Moller-Trumbore for a single lane, written without branches so that the
+//loops calling it vectorize:
+template<typename T>
+inline constexpr auto moller_trumbore(
+  T ox, T oy, T oz,
+  T dx, T dy, T dz,
+  T v0x, T v0y, T v0z,
+  T e1x, T e1y, T e1z,
+  T e2x, T e2y, T e2z,
+  T t_min, T t_max
+) noexcept{
+  const auto px = dy * e2z - dz * e2y;
+  const auto py = dz * e2x - dx * e2z;
+  const auto pz = dx * e2y - dy * e2x;
+
+  const auto det = e1x * px + e1y * py + e1z * pz;
+  const auto inv_det = T(1) / det;
+
+  const auto tx = ox - v0x;
+  const auto ty = oy - v0y;
+  const auto tz = oz - v0z;
+
+  const auto u = (tx * px + ty * py + tz * pz) * inv_det;
+
+  const auto qx = ty * e1z - tz * e1y;
+  const auto qy = tz * e1x - tx * e1z;
+  const auto qz = tx * e1y - ty * e1x;
+
+  const auto v = (dx * qx + dy * qy + dz * qz) * inv_det;
+  const auto t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+  const bool hit =
+    (det != T(0)) &
+    (u >= T(0)) &
+    (v >= T(0)) &
+    (u + v <= T(1)) &
+    (t > t_min) &
+    (t < t_max);
+
+  return triangle_lane<T>{ hit, t, u, v };
+}
+
+template<typename T>
+struct box_lane{
+  bool hit;
+  T t;
+};
+
+template<typename T>
+inline constexpr auto slab(
+  T ox, T oy, T oz,
+  T idx, T idy, T idz,
+  T min_x, T min_y, T min_z,
+  T max_x, T max_y, T max_z,
+  T t_min, T t_max
+) noexcept{
+  const auto t0x = (min_x - ox) * idx;
+  const auto t1x = (max_x - ox) * idx;
+  const auto t0y = (min_y - oy) * idy;
+  const auto t1y = (max_y - oy) * idy;
+  const auto t0z = (min_z - oz) * idz;
+  const auto t1z = (max_z - oz) * idz;
+
+  const auto t_near = lane_max(
+    lane_max(lane_min(t0x, t1x), lane_min(t0y, t1y)),
+    lane_max(lane_min(t0z, t1z), t_min)
+  );
+
+  const auto t_far = lane_min(
+    lane_min(lane_max(t0x, t1x), lane_max(t0y, t1y)),
+    lane_min(lane_max(t0z, t1z), t_max)
+  );
+
+  return box_lane<T>{ t_near <= t_far, t_near };
+}
+
+} //namespace detail
+
+//One ray against W triangles:
+template<typename T, std::size_t W>
+inline constexpr auto intersect(
+  const ray<T>& r,
+  const triangle_packet<T, W>& triangles,
+  T t_min = T(0),
+  T t_max = std::numeric_limits<T>::infinity()
+) noexcept{
+  auto result = triangle_hits<T, W>();
+  detail::lane_flag<T> hits[W] = {};
+
+  const auto [ox, oy, oz] = r.origin;
+  const auto [dx, dy, dz] = r.direction;
+  const auto& [v0, e1, e2] = triangles;
+
+  for (auto i : range(W)){
+    const auto lane = detail::moller_trumbore(
+      ox, oy, oz,
+      dx, dy, dz,
+      v0[0][i], v0[1][i], v0[2][i],
+      e1[0][i], e1[1][i], e1[2][i],
+      e2[0][i], e2[1][i], e2[2][i],
+      t_min, t_max
+    );
+
+    hits[i] = lane.hit;
+    result.t[i] = lane.t;
+    result.u[i] = lane.u;
+    result.v[i] = lane.v;
+  }
+
+  result.mask = detail::to_mask(hits);
+  return result;
+}
+
+//W rays against one triangle:
+template<typename T, std::size_t W>
+inline constexpr auto intersect(
+  const ray_packet<T, W>& rays,
+  const vec<T, 3>& a,
+  const vec<T, 3>& b,
+  const vec<T, 3>& c,
+  T t_min = T(0),
+  T t_max = std::numeric_limits<T>::infinity()
+) noexcept{
+  auto result = triangle_hits<T, W>();
+  detail::lane_flag<T> hits[W] = {};
+
+  const auto& o = rays.origin;
+  const auto& d = rays.direction;
+  const auto e1 = b - a;
+  const auto e2 = c - a;
+
+  for (auto i : range(W)){
+    const auto lane = detail::moller_trumbore(
+      o[0][i], o[1][i], o[2][i],
+      d[0][i], d[1][i], d[2][i],
+      a.x, a.y, a.z,
+      e1.x, e1.y, e1.z,
+      e2.x, e2.y, e2.z,
+      t_min, t_max
+    );
+
+    hits[i] = lane.hit;
+    result.t[i] = lane.t;
+    result.u[i] = lane.u;
+    result.v[i] = lane.v;
+  }
+
+  result.mask = detail::to_mask(hits);
+  return result;
+}
+
+//One ray against W boxes (slab method):
+template<typename T, std::size_t W>
+inline constexpr auto intersect(
+  const ray<T>& r,
+  const box_packet<T, W>& boxes,
+  T t_min = T(0),
+  T t_max = std::numeric_limits<T>::infinity()
+) noexcept{
+  auto result = box_hits<T, W>();
+  detail::lane_flag<T> hits[W] = {};
+
+  const auto [ox, oy, oz] = r.origin;
+  const auto [idx, idy, idz] = T(1) / r.direction;
+  const auto& lo = boxes.min;
+  const auto& hi = boxes.max;
+
+  for (auto i : range(W)){
+    const auto lane = detail::slab(
+      ox, oy, oz,
+      idx, idy, idz,
+      lo[0][i], lo[1][i], lo[2][i],
+      hi[0][i], hi[1][i], hi[2][i],
+      t_min, t_max
+    );
+
+    hits[i] = lane.hit;
+    result.t[i] = lane.t;
+  }
+
+  result.mask = detail::to_mask(hits);
+  return result;
+}
+
+//W rays against one box (slab method):
+template<typename T, std::size_t W>
+inline constexpr auto intersect(
+  const ray_packet<T, W>& rays,
+  const vec<T, 3>& lo,
+  const vec<T, 3>& hi,
+  T t_min = T(0),
+  T t_max = std::numeric_limits<T>::infinity()
+) noexcept{
+  auto result = box_hits<T, W>();
+  detail::lane_flag<T> hits[W] = {};
+
+  const auto& o = rays.origin;
+  const auto& id = rays.inv_direction;
+
+  for (auto i : range(W)){
+    const auto lane = detail::slab(
+      o[0][i], o[1][i], o[2][i],
+      id[0][i], id[1][i], id[2][i],
+      lo.x, lo.y, lo.z,
+      hi.x, hi.y, hi.z,
+      t_min, t_max
+    );
+
+    hits[i] = lane.hit;
+    result.t[i] = lane.t;
+  }
+
+  result.mask = detail::to_mask(hits);
+  return result;
+}
+
+//One ray against one box:
+template<typename T>
+inline constexpr auto intersect(
+  const ray<T>& r,
+  const aabb<T>& box,
+  T t_min = T(0),
+  T t_max = std::numeric_limits<T>::infinity()
+) noexcept{
+  const auto inv_direction = T(1) / r.direction;
+
+  const auto lane = detail::slab(
+    r.origin.x, r.origin.y, r.origin.z,
+    inv_direction.x, inv_direction.y, inv_direction.z,
+    box.min.x, box.min.y, box.min.z,
+    box.max.x, box.max.y, box.max.z,
+    t_min, t_max
+  );
+
+  auto result = box_hits<T, 1>();
+  result.mask = lane.hit;
+  result.t[0] = lane.t;
+
+  return result;
+}
+
+} //namespace gf::math
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "parallel.hpp"
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace gf::math{
+
+template<typename T>
+struct kd_neighbor{
+  std::uint32_t index = InvalidIndex; //index into the original point array
+  T distance_squared = std::numeric_limits<T>::infinity();
+
+  constexpr auto found() const noexcept{
+    return index != InvalidIndex;
+  }
+};
+
+namespace detail{
+
+template<typename T>
+inline auto closer(const kd_neighbor<T>& a, const kd_neighbor<T>& b) noexcept{
+  return a.distance_squared < b.distance_squared;
+}
+
+} //namespace detail
+
+//Static k-d tree over points. The tree is implicit: the node of the range
+//[begin, end) is the point at (begin + end) / 2, its children are the ranges
+//on either side, so only the points and their split axes are stored.
+template<typename T, std::size_t N>
+struct kd_tree{
+  //Ranges smaller than this are built on the current thread:
+  static constexpr auto ParallelThreshold = std::size_t(1 << 16);
+
+  std::vector<vec<T, N>> points;
+  std::vector<std::uint32_t> ids;
+  std::vector<std::uint8_t> axes;
+
+  kd_tree() = default;
+
+  explicit kd_tree(
+    const std::vector<vec<T, N>>& source,
+    std::size_t threads = hardware_threads()
+  ) : points(source.size()), ids(source.size()), axes(source.size()){
+    std::iota(ids.begin(), ids.end(), std::uint32_t(0));
+
+    auto parallel_depth = std::size_t(0);
+    while (threads > 1 && (std::size_t(1) << parallel_depth) < threads * 2){
+      ++parallel_depth;
+    }
+
+    build(source, 0, source.size(), parallel_depth);
+
+    for (auto i : range(source.size())){
+      points[i] = source[ids[i]];
+    }
+  }
+
+  auto size() const noexcept{
+    return points.size();
+  }
+
+  auto nearest(const vec<T, N>& query) const{
+    auto best = kd_neighbor<T>();
+    search_nearest(query, 0, points.size(), best);
+    return best;
+  }
+
+  //The k nearest points, closest first. Fewer are returned when the tree is smaller than k.
+  auto nearest(const vec<T, N>& query, std::size_t k) const{
+    auto heap = std::vector<kd_neighbor<T>>();
+    heap.reserve(k + 1);
+
+    if (k != 0) search_k_nearest(query, k, 0, points.size(), heap);
+
+    std::sort_heap(heap.begin(), heap.end(), detail::closer<T>);
+    return heap;
+  }
+
+  //Calls callable(kd_neighbor) for every point within the radius, in no particular order:
+  template<typename Callable>
+  auto within(const vec<T, N>& query, T radius, Callable callable) const{
+    search_within(query, radius * radius, 0, points.size(), callable);
+  }
+
+  auto within(const vec<T, N>& query, T radius) const{
+    auto result = std::vector<kd_neighbor<T>>();
+    within(query, radius, [&](const kd_neighbor<T>& n){ result.push_back(n); });
+    return result;
+  }
+
+  //Batched queries, split across threads:
+  auto nearest_batch(
+    const std::vector<vec<T, N>>& queries,
+    std::size_t threads = hardware_threads()
+  ) const{
+    auto result = std::vector<kd_neighbor<T>>(queries.size());
+
+    parallel_for(queries.size(), [&](std::size_t begin, std::size_t end){
+      for (auto i : range(begin, end)){
+        result[i] = nearest(queries[i]);
+      }
+    }, threads);
+
+    return result;
+  }
+
+  //k results per query, stored contiguously; missing neighbors are left unfound.
+  auto k_nearest_batch(
+    const std::vector<vec<T, N>>& queries,
+    std::size_t k,
+    std::size_t threads = hardware_threads()
+  ) const{
+    auto result = std::vector<kd_neighbor<T>>(queries.size() * k);
+
+    parallel_for(queries.size(), [&](std::size_t begin, std::size_t end){
+      auto heap = std::vector<kd_neighbor<T>>();
+      heap.reserve(k + 1);
+
+      for (auto i : range(begin, end)){
+        heap.clear();
+        if (k != 0) search_k_nearest(queries[i], k, 0, points.size(), heap);
+
+        std::sort_heap(heap.begin(), heap.end(), detail::closer<T>);
+        std::copy(heap.begin(), heap.end(), result.begin() + i * k);
+      }
+    }, threads);
+
+    return result;
+  }
+
+private:
+  //Orders ids into the implicit layout; points are gathered afterwards.
+  auto build(
+    const std::vector<vec<T, N>>& source,
+    std::size_t begin,
+    std::size_t end,
+    std::size_t parallel_depth
+  ) -> void{
+    if (end - begin <= 1) return;
+
+    //Split along the axis with the largest spread:
+    auto low = source[ids[begin]];
+    auto high = low;
+
+    for (auto i : range(begin + 1, end)){
+      const auto& point = source[ids[i]];
+
+      for (auto n : range(N)){
+        low[n] = point[n] < low[n] ? point[n] : low[n];
+        high[n] = point[n] > high[n] ? point[n] : high[n];
+      }
+    }
+
+    auto axis = std::size_t(0);
+    for (auto n : range(1, N)){
+      if (high[n] - low[n] > high[axis] - low[axis]) axis = n;
+    }
+
+    const auto middle = (begin + end) / 2;
+
+    std::nth_element(
+      ids.begin() + begin,
+      ids.begin() + middle,
+      ids.begin() + end,
+      [&](std::uint32_t a, std::uint32_t b){ return source[a][axis] < source[b][axis]; }
+    );
+
+    axes[middle] = static_cast<std::uint8_t>(axis);
+
+    if (parallel_depth != 0 && end - begin >= ParallelThreshold){
+      auto left = std::async(std::launch::async, [&]{
+        build(source, begin, middle, parallel_depth - 1);
+      });
+
+      build(source, middle + 1, end, parallel_depth - 1);
+      left.get();
+    }
+    else{
+      build(source, begin, middle, 0);
+      build(source, middle + 1, end, 0);
+    }
+  }
+
+  auto search_nearest(
+    const vec<T, N>& query,
+    std::size_t begin,
+    std::size_t end,
+    kd_neighbor<T>& best
+  ) const -> void{
+    if (begin >= end) return;
+
+    const auto middle = (begin + end) / 2;
+    const auto& point = points[middle];
+    const auto distance = math::distance_squared(query, point);
+
+    if (distance < best.distance_squared){
+      best = kd_neighbor<T>{ ids[middle], distance };
+    }
+
+    const auto axis = axes[middle];
+    const auto offset = query[axis] - point[axis];
+
+    //Nearer side first; the far side only when the splitting plane is closer than the best match:
+    if (offset < T(0)){
+      search_nearest(query, begin, middle, best);
+      if (offset * offset < best.distance_squared) search_nearest(query, middle + 1, end, best);
+    }
+    else{
+      search_nearest(query, middle + 1, end, best);
+      if (offset * offset < best.distance_squared) search_nearest(query, begin, middle, best);
+    }
+  }
+
+  //heap is a max-heap on distance holding at most k neighbors:
+  auto search_k_nearest(
+    const vec<T, N>& query,
+    std::size_t k,
+    std::size_t begin,
+    std::size_t end,
+    std::vector<kd_neighbor<T>>& heap
+  ) const -> void{
+    if (begin >= end) return;
+
+    const auto middle = (begin + end) / 2;
+    const auto& point = points[middle];
+    const auto distance = math::distance_squared(query, point);
+
+    if (heap.size() < k || distance < heap.front().distance_squared){
+      heap.push_back(kd_neighbor<T>{ ids[middle], distance });
+      std::push_heap(heap.begin(), heap.end(), detail::closer<T>);
+
+      if (heap.size() > k){
+        std::pop_heap(heap.begin(), heap.end(), detail::closer<T>);
+        heap.pop_back();
+      }
+    }
+
+    const auto axis = axes[middle];
+    const auto offset = query[axis] - point[axis];
+
+    const auto worst = [&]{
+      return heap.size() < k ? std::numeric_limits<T>::infinity() : heap.front().distance_squared;
+    };
+
+    if (offset < T(0)){
+      search_k_nearest(query, k, begin, middle, heap);
+      if (offset * offset < worst()) search_k_nearest(query, k, middle + 1, end, heap);
+    }
+    else{
+      search_k_nearest(query, k, middle + 1, end, heap);
+      if (offset * offset < worst()) search_k_nearest(query, k, begin, middle, heap);
+    }
+  }
+
+  template<typename Callable>
+  auto search_within(
+    const vec<T, N>& query,
+    T radius_squared,
+    std::size_t begin,
+    std::size_t end,
+    Callable& callable
+  ) const -> void{
+    if (begin >= end) return;
+
+    const auto middle = (begin + end) / 2;
+    const auto& point = points[middle];
+    const auto distance = math::distance_squared(query, point);
+
+    if (distance <= radius_squared){
+      callable(kd_neighbor<T>{ ids[middle], distance });
+    }
+
+    const auto axis = axes[middle];
+    const auto offset = query[axis] - point[axis];
+
+    if (offset <= T(0) || offset * offset <= radius_squared){
+      search_within(query, radius_squared, begin, middle, callable);
+    }
+
+    if (offset >= T(0) || offset * offset <= radius_squared){
+      search_within(query, radius_squared, middle + 1, end, callable);
+    }
+  }
+};
+
+template<typename T>
+using kd_tree2 = kd_tree<T, 2>;
+
+template<typename T>
+using kd_tree3 = kd_tree<T, 3>;
+
+} //namespace gf::math
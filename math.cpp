@@ -0,0 +1,19 @@
+//Explicit instantiations of the standard vec and mat aliases. Compile this
+//file into the program and define GEFEC_MATH_EXTERN_TEMPLATES everywhere
+//else, so that their members are compiled once instead of in every
+//translation unit that includes math.hpp.
+
+#include "math.hpp"
+
+namespace gf::math{
+
+#define GEFEC_MATH_INSTANTIATE(T, N) \
+  template struct vec<T, N>; \
+  template struct mat_base<T, N, N, layout::column_major>; \
+  template struct mat<T, N, N>;
+
+GEFEC_MATH_FOR_EACH_ALIAS(GEFEC_MATH_INSTANTIATE)
+
+#undef GEFEC_MATH_INSTANTIATE
+
+} //namespace gf::math
@@ -0,0 +1,26 @@
+//The gf.math module: import gf.math; instead of #include "math.hpp".
+//g++ -std=c++20 -fmodules-ts -c -x c++ math.cppm builds it (GCC 11+),
+//clang++ -std=c++20 --precompile -x c++-module math.cppm with Clang 16+.
+//Defining GEFEC_MATH_DEBUG while building the module exports the stream
+//operators too.
+
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <functional>
+
+#ifdef GEFEC_MATH_DEBUG
+#include <iostream>
+#endif
+
+export module gf.math;
+
+#define GEFEC_MATH_EXPORT export
+#include "math.hpp"
@@ -5,18 +5,39 @@
 #include <tuple>
 #include <utility>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <type_traits>
 #include <functional>
 
-namespace gf::math{
+//Empty, except in math.cppm where it exports everything for import gf.math:
+#ifndef GEFEC_MATH_EXPORT
+#define GEFEC_MATH_EXPORT
+#endif
+
+//GEFEC_MATH_TRACE(family, expression) counts and checks the expression as
+//a call of the family when GEFEC_MATH_INSTRUMENT is defined (see
+//instrument.hpp), and is just the expression otherwise:
+#ifdef GEFEC_MATH_INSTRUMENT
+#include "instrument.hpp"
+#define GEFEC_MATH_TRACE(family, ...) \
+  ::gf::math::detail::traced( \
+    ::gf::math::instrument::op::family, [&]() -> decltype(auto){ return __VA_ARGS__; } \
+  )
+#else
+#define GEFEC_MATH_TRACE(family, ...) (__VA_ARGS__)
+#endif
+
+GEFEC_MATH_EXPORT namespace gf::math{
 
 namespace detail{
 
 inline constexpr auto NotSpecialized = false;
 
+//Every Targs converts implicitly to T:
 template<typename T, typename... Targs>
 using all_convertible = std::enable_if_t<
-  std::conjunction_v<std::is_convertible<T, Targs>...>
+  std::conjunction_v<std::is_convertible<Targs, T>...>
 >;
 
 template<typename T>
@@ -25,10 +46,55 @@ using arithmetic = std::enable_if_t<std::is_arithmetic_v<T>>;
 template<typename T>
 using not_arithmetic = std::enable_if_t<!std::is_arithmetic_v<T>>;
 
+//Unqualified calls, so that number types outside of std (fixed point) are found by ADL:
+template<typename T>
+inline constexpr auto adl_sqrt(const T& x) noexcept{
+  using std::sqrt;
+  return sqrt(x);
+}
+
+template<typename T>
+inline constexpr auto adl_sin(const T& x) noexcept{
+  using std::sin;
+  return sin(x);
+}
+
+template<typename T>
+inline constexpr auto adl_cos(const T& x) noexcept{
+  using std::cos;
+  return cos(x);
+}
+
+//Index of a swizzle component name (x, y, z or w):
+inline constexpr auto component_index(const char* name) noexcept{
+  switch (name[0]){
+    case 'x': return std::size_t(0);
+    case 'y': return std::size_t(1);
+    case 'z': return std::size_t(2);
+    default: return std::size_t(3);
+  }
+}
+
+template<std::size_t... I>
+inline constexpr auto distinct_indices() noexcept{
+  constexpr std::size_t indices[] = { I... };
+
+  for (auto i = std::size_t(0); i < sizeof...(I); ++i){
+    for (auto j = i + 1; j < sizeof...(I); ++j){
+      if (indices[i] == indices[j]) return false;
+    }
+  }
+
+  return true;
+}
+
 } //namespace detail
 
 inline constexpr auto pi = 3.141592653589793238462643;
 
+//Marks unused slots in index based structures:
+inline constexpr auto InvalidIndex = std::uint32_t(-1);
+
 template<typename T>
 struct range_base{
   T min;
@@ -125,9 +191,216 @@ inline constexpr auto range(const std::pair<std::size_t, std::size_t>& max) noex
   return range({ 0, 0 }, max);
 }
 
-template<typename T, std::size_t W, std::size_t H>
+namespace detail{
+
+template<typename T>
+struct wider{ using type = T; };
+
+template<> struct wider<float>{ using type = double; };
+template<> struct wider<double>{ using type = long double; };
+template<> struct wider<std::int8_t>{ using type = std::int64_t; };
+template<> struct wider<std::int16_t>{ using type = std::int64_t; };
+template<> struct wider<std::int32_t>{ using type = std::int64_t; };
+template<> struct wider<std::uint8_t>{ using type = std::uint64_t; };
+template<> struct wider<std::uint16_t>{ using type = std::uint64_t; };
+template<> struct wider<std::uint32_t>{ using type = std::uint64_t; };
+
+//The type sums and products of T are accumulated in: T, except for storage
+//formats that compute in another type (half in float, see packed.hpp):
+template<typename T>
+struct accumulated{ using type = T; };
+
+} //namespace detail
+
+//Accumulation policies for sums and products of many terms (len_squared, dot, det, sum).
+//Every policy has an accumulator type and sum/product over the terms term(0) ... term(count - 1).
+namespace precision{
+
+//Accumulates in T, in order. The default, keeps float code in float:
+struct native{
+  template<typename T>
+  using type = typename detail::accumulated<T>::type;
+
+  template<typename A, typename Callable>
+  static constexpr auto sum(std::size_t count, Callable term) noexcept{
+    auto result = A();
+
+    for (auto i : range(count)){
+      result += term(i);
+    }
+
+    return result;
+  }
+
+  template<typename A, typename Callable>
+  static constexpr auto product(std::size_t count, Callable term) noexcept{
+    auto result = A(1);
+
+    for (auto i : range(count)){
+      result *= term(i);
+    }
+
+    return result;
+  }
+};
+
+//Accumulates in the next wider type (float in double, int32_t in int64_t):
+struct widened : native{
+  template<typename T>
+  using type = typename detail::wider<T>::type;
+};
+
+//Compensated (Kahan-Babuska) summation in T; products are accumulated like native.
+//Has no effect when compiled with -ffast-math.
+struct kahan : native{
+  template<typename A, typename Callable>
+  static constexpr auto sum(std::size_t count, Callable term) noexcept{
+    auto result = A();
+    auto compensation = A();
+
+    for (auto i : range(count)){
+      const auto x = term(i);
+      const auto t = result + x;
+
+      if constexpr (std::is_floating_point_v<A>){
+        compensation += std::abs(result) >= std::abs(x) ? (result - t) + x : (x - t) + result;
+      }
+
+      result = t;
+    }
+
+    return result + compensation;
+  }
+};
+
+//Pairwise (tree) summation in T, error grows with log(count) instead of count:
+struct pairwise : native{
+  static constexpr auto BlockSize = std::size_t(8);
+
+  template<typename A, typename Callable>
+  static constexpr auto sum(std::size_t count, Callable term) noexcept{
+    return sum_range<A>(0, count, term);
+  }
+
+  template<typename A, typename Callable>
+  static constexpr auto product(std::size_t count, Callable term) noexcept{
+    return product_range<A>(0, count, term);
+  }
+
+private:
+  template<typename A, typename Callable>
+  static constexpr auto sum_range(std::size_t begin, std::size_t end, Callable& term) noexcept -> A{
+    if (end - begin <= BlockSize){
+      auto result = A();
+      for (auto i = begin; i < end; ++i) result += term(i);
+      return result;
+    }
+
+    const auto middle = begin + (end - begin) / 2;
+    return sum_range<A>(begin, middle, term) + sum_range<A>(middle, end, term);
+  }
+
+  template<typename A, typename Callable>
+  static constexpr auto product_range(std::size_t begin, std::size_t end, Callable& term) noexcept -> A{
+    if (end - begin <= BlockSize){
+      auto result = A(1);
+      for (auto i = begin; i < end; ++i) result *= term(i);
+      return result;
+    }
+
+    const auto middle = begin + (end - begin) / 2;
+    return product_range<A>(begin, middle, term) * product_range<A>(middle, end, term);
+  }
+};
+
+} //namespace precision
+
+//Storage order of mat elements. Indexing is m[column][row] in both layouts,
+//only the memory order changes: column_major keeps each column contiguous
+//(T[W][H]), row_major each row (T[H][W]), e.g. for uploads in the consumer's order.
+namespace layout{
+
+struct column_major{
+  template<typename T, std::size_t W, std::size_t H>
+  using storage = T[W][H];
+
+  template<typename Storage>
+  static constexpr auto& at(Storage& data, std::size_t x, std::size_t y) noexcept{
+    return data[x][y];
+  }
+};
+
+struct row_major{
+  template<typename T, std::size_t W, std::size_t H>
+  using storage = T[H][W];
+
+  template<typename Storage>
+  static constexpr auto& at(Storage& data, std::size_t x, std::size_t y) noexcept{
+    return data[y][x];
+  }
+};
+
+} //namespace layout
+
+template<typename T, std::size_t W, std::size_t H, typename Layout = layout::column_major>
 struct mat;
 
+template<typename T, std::size_t N>
+struct vec;
+
+#ifdef GEFEC_MATH_INSTRUMENT
+
+namespace detail{
+
+template<typename T>
+inline auto finite(const T& value) noexcept{
+  if constexpr (std::is_floating_point_v<T>) return std::isfinite(value);
+  else return true;
+}
+
+template<typename T, typename U>
+inline auto finite(const std::pair<T, U>& p) noexcept{
+  return finite(p.first) && finite(p.second);
+}
+
+template<typename T, std::size_t N>
+inline auto finite(const vec<T, N>& v) noexcept{
+  for (auto i : range(N)){
+    if (!finite(v[i])) return false;
+  }
+
+  return true;
+}
+
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline auto finite(const mat<T, W, H, L>& m) noexcept{
+  for (const auto& [x, y] : range({ W, H })){
+    if (!finite(m.at(x, y))) return false;
+  }
+
+  return true;
+}
+
+//Constant evaluation isn't traced:
+template<typename Callable>
+inline constexpr decltype(auto) traced(instrument::op family, Callable callable){
+  if (__builtin_is_constant_evaluated()) return callable();
+
+  const auto outermost = instrument::detail::enter(family);
+  decltype(auto) result = callable();
+  instrument::detail::leave();
+
+  if (outermost && instrument::detail::checking() && !finite(result)){
+    instrument::detail::report_non_finite(family);
+  }
+
+  return result;
+}
+
+} //namespace detail
+
+#endif
+
 template<typename T, std::size_t N>
 struct vec_props{
   T dims[N];
@@ -270,59 +543,204 @@ struct vec : vec_props<T, N>{
     return true;
   }
 
+  template<typename Policy = precision::native>
   constexpr auto len_squared() const noexcept{
-    auto sum = 0.0;
+    using A = typename Policy::template type<T>;
 
-    for (auto i : range(N)){
-      const auto& e = (*this)[i];
-      sum += e * e;
-    }
-
-    return sum;
+    return GEFEC_MATH_TRACE(length, Policy::template sum<A>(N, [&](std::size_t i){
+      const auto e = static_cast<A>((*this)[i]);
+      return e * e;
+    }));
   }
 
+  template<typename Policy = precision::native>
   constexpr auto len() const noexcept{
-    return std::sqrt(len_squared());
+    return GEFEC_MATH_TRACE(length, detail::adl_sqrt(len_squared<Policy>()));
   }
 
   constexpr auto normalized() const noexcept{
-    return vec<T, N>((*this / static_cast<T>(len())));
+    return GEFEC_MATH_TRACE(normalize, vec<T, N>((*this / static_cast<T>(len()))));
   }
 
+  //Compound operators update the components in place and round exactly
+  //like the binary operators (division multiplies by the reciprocal for
+  //floating point, like operator/):
   constexpr auto& operator+=(const vec& other) noexcept{
-    return (*this) = (*this) + other;
+    for (auto i : range(N)){
+      (*this)[i] = (*this)[i] + other[i];
+    }
+
+    return GEFEC_MATH_TRACE(vec_add, *this);
   }
 
   constexpr auto& operator+=(const T& x) noexcept{
-    return (*this) = (*this) + x;
+    for (auto i : range(N)){
+      (*this)[i] = (*this)[i] + x;
+    }
+
+    return GEFEC_MATH_TRACE(vec_add, *this);
   }
 
   constexpr auto& operator-=(const vec& other) noexcept{
-    return (*this) = (*this) - other;
+    for (auto i : range(N)){
+      (*this)[i] = (*this)[i] + (-other[i]);
+    }
+
+    return GEFEC_MATH_TRACE(vec_add, *this);
   }
 
   constexpr auto& operator-=(const T& x) noexcept{
-    return (*this) = (*this) - x;
+    return GEFEC_MATH_TRACE(vec_add, (*this) += -x);
   }
 
   constexpr auto& operator*=(const vec& other) noexcept{
-    return (*this) = (*this) * other;
+    for (auto i : range(N)){
+      (*this)[i] = (*this)[i] * other[i];
+    }
+
+    return GEFEC_MATH_TRACE(vec_multiply, *this);
   }
 
   constexpr auto& operator*=(const T& x) noexcept{
-    return (*this) = (*this) * x;
+    for (auto i : range(N)){
+      (*this)[i] = (*this)[i] * x;
+    }
+
+    return GEFEC_MATH_TRACE(vec_multiply, *this);
   }
 
   constexpr auto& operator/=(const vec& other) noexcept{
-    return (*this) = (*this) / other;
+    for (auto i : range(N)){
+      if constexpr (std::is_floating_point_v<T>) (*this)[i] = (*this)[i] * (T(1) / other[i]);
+      else (*this)[i] = (*this)[i] / other[i];
+    }
+
+    return GEFEC_MATH_TRACE(vec_divide, *this);
   }
 
   constexpr auto& operator/=(const T& x) noexcept{
-    return (*this) = (*this) / x;
+    if constexpr (std::is_floating_point_v<T>) return GEFEC_MATH_TRACE(vec_divide, (*this) *= T(1) / x);
+    else{
+      for (auto i : range(N)){
+        (*this)[i] = static_cast<T>((*this)[i] / x);
+      }
+
+      return GEFEC_MATH_TRACE(vec_divide, *this);
+    }
   }
 
-  constexpr auto operator*=(const mat<T, N, N>& mat) noexcept -> vec<T, N>&;
-  constexpr auto operator/=(const mat<T, N, N>& mat) noexcept -> vec<T, N>&;
+  template<typename L>
+  constexpr auto operator*=(const mat<T, N, N, L>& mat) noexcept -> vec<T, N>&;
+  template<typename L>
+  constexpr auto operator/=(const mat<T, N, N, L>& mat) noexcept -> vec<T, N>&;
+
+  //Swizzling, v.swizzle<2, 1, 0>() is the same as v.zyx():
+  template<std::size_t... I>
+  constexpr auto swizzle() const noexcept{
+    static_assert(((I < N) && ...), "swizzle component out of range");
+    return vec<T, sizeof...(I)>((*this)[I]...);
+  }
+
+  //Writes values into the given components; v.assign<0, 2>(u) is the same as v.set_xz(u):
+  template<std::size_t... I>
+  constexpr auto& assign(const vec<T, sizeof...(I)>& values) noexcept{
+    static_assert(((I < N) && ...), "swizzle component out of range");
+    static_assert(detail::distinct_indices<I...>(), "a component can only be written once");
+
+    constexpr std::size_t indices[] = { I... };
+
+    for (auto i : range(sizeof...(I))){
+      (*this)[indices[i]] = values[i];
+    }
+
+    return *this;
+  }
+
+//Named swizzles, xy() ... wwww() and set_xy() ... set_wzyx(). They are
+//templates, so only the ones that are used get instantiated (even when the
+//whole vec is, see math.cpp) and vec2 simply can't call xz().
+#define GEFEC_MATH_SWIZZLE2(a, b) \
+  template<typename = void> \
+  constexpr auto a##b() const noexcept{ \
+    return swizzle<detail::component_index(#a), detail::component_index(#b)>(); \
+  } \
+  template<typename = void> \
+  constexpr auto& set_##a##b(const vec<T, 2>& values) noexcept{ \
+    return assign<detail::component_index(#a), detail::component_index(#b)>(values); \
+  }
+
+#define GEFEC_MATH_SWIZZLE3(a, b, c) \
+  template<typename = void> \
+  constexpr auto a##b##c() const noexcept{ \
+    return swizzle< \
+      detail::component_index(#a), detail::component_index(#b), detail::component_index(#c) \
+    >(); \
+  } \
+  template<typename = void> \
+  constexpr auto& set_##a##b##c(const vec<T, 3>& values) noexcept{ \
+    return assign< \
+      detail::component_index(#a), detail::component_index(#b), detail::component_index(#c) \
+    >(values); \
+  }
+
+#define GEFEC_MATH_SWIZZLE4(a, b, c, d) \
+  template<typename = void> \
+  constexpr auto a##b##c##d() const noexcept{ \
+    return swizzle< \
+      detail::component_index(#a), detail::component_index(#b), \
+      detail::component_index(#c), detail::component_index(#d) \
+    >(); \
+  } \
+  template<typename = void> \
+  constexpr auto& set_##a##b##c##d(const vec<T, 4>& values) noexcept{ \
+    return assign< \
+      detail::component_index(#a), detail::component_index(#b), \
+      detail::component_index(#c), detail::component_index(#d) \
+    >(values); \
+  }
+
+#define GEFEC_MATH_SWIZZLE2_FROM(a) \
+  GEFEC_MATH_SWIZZLE2(a, x) GEFEC_MATH_SWIZZLE2(a, y) \
+  GEFEC_MATH_SWIZZLE2(a, z) GEFEC_MATH_SWIZZLE2(a, w)
+
+#define GEFEC_MATH_SWIZZLE3_FROM2(a, b) \
+  GEFEC_MATH_SWIZZLE3(a, b, x) GEFEC_MATH_SWIZZLE3(a, b, y) \
+  GEFEC_MATH_SWIZZLE3(a, b, z) GEFEC_MATH_SWIZZLE3(a, b, w)
+
+#define GEFEC_MATH_SWIZZLE3_FROM(a) \
+  GEFEC_MATH_SWIZZLE3_FROM2(a, x) GEFEC_MATH_SWIZZLE3_FROM2(a, y) \
+  GEFEC_MATH_SWIZZLE3_FROM2(a, z) GEFEC_MATH_SWIZZLE3_FROM2(a, w)
+
+#define GEFEC_MATH_SWIZZLE4_FROM3(a, b, c) \
+  GEFEC_MATH_SWIZZLE4(a, b, c, x) GEFEC_MATH_SWIZZLE4(a, b, c, y) \
+  GEFEC_MATH_SWIZZLE4(a, b, c, z) GEFEC_MATH_SWIZZLE4(a, b, c, w)
+
+#define GEFEC_MATH_SWIZZLE4_FROM2(a, b) \
+  GEFEC_MATH_SWIZZLE4_FROM3(a, b, x) GEFEC_MATH_SWIZZLE4_FROM3(a, b, y) \
+  GEFEC_MATH_SWIZZLE4_FROM3(a, b, z) GEFEC_MATH_SWIZZLE4_FROM3(a, b, w)
+
+#define GEFEC_MATH_SWIZZLE4_FROM(a) \
+  GEFEC_MATH_SWIZZLE4_FROM2(a, x) GEFEC_MATH_SWIZZLE4_FROM2(a, y) \
+  GEFEC_MATH_SWIZZLE4_FROM2(a, z) GEFEC_MATH_SWIZZLE4_FROM2(a, w)
+
+#define GEFEC_MATH_SWIZZLE_FROM(a) \
+  GEFEC_MATH_SWIZZLE2_FROM(a) GEFEC_MATH_SWIZZLE3_FROM(a) GEFEC_MATH_SWIZZLE4_FROM(a)
+
+  GEFEC_MATH_SWIZZLE_FROM(x)
+  GEFEC_MATH_SWIZZLE_FROM(y)
+  GEFEC_MATH_SWIZZLE_FROM(z)
+  GEFEC_MATH_SWIZZLE_FROM(w)
+
+#undef GEFEC_MATH_SWIZZLE_FROM
+#undef GEFEC_MATH_SWIZZLE4_FROM
+#undef GEFEC_MATH_SWIZZLE4_FROM2
+#undef GEFEC_MATH_SWIZZLE4_FROM3
+#undef GEFEC_MATH_SWIZZLE3_FROM
+#undef GEFEC_MATH_SWIZZLE3_FROM2
+#undef GEFEC_MATH_SWIZZLE2_FROM
+#undef GEFEC_MATH_SWIZZLE4
+#undef GEFEC_MATH_SWIZZLE3
+#undef GEFEC_MATH_SWIZZLE2
 };
 
 template<typename T>
@@ -344,97 +762,300 @@ inline constexpr auto zip(const vec<T, N>& v1, const vec<T, N>& v2) noexcept{
   return result;
 }
 
+template<typename T>
+inline constexpr T Epsilon = T();
+
+template<>
+inline constexpr auto Epsilon<float> = 0.00001f;
+
+template<>
+inline constexpr auto Epsilon<double> = 0.000'000'000'001;
+
+//Result of a component-wise comparison, one bit per component:
+template<std::size_t N>
+struct vmask{
+  static_assert(N <= 64, "vmask holds at most 64 components");
+
+  static constexpr auto Full = N == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << N) - 1;
+
+  std::uint64_t bits = 0;
+
+  constexpr auto operator[](std::size_t n) const noexcept{
+    return ((bits >> n) & 1) != 0;
+  }
+
+  constexpr auto set(std::size_t n, bool value) noexcept{
+    bits = (bits & ~(std::uint64_t(1) << n)) | (std::uint64_t(value) << n);
+  }
+};
+
+template<std::size_t N>
+inline constexpr auto operator&(vmask<N> lhs, vmask<N> rhs) noexcept{
+  return vmask<N>{ lhs.bits & rhs.bits };
+}
+
+template<std::size_t N>
+inline constexpr auto operator|(vmask<N> lhs, vmask<N> rhs) noexcept{
+  return vmask<N>{ lhs.bits | rhs.bits };
+}
+
+template<std::size_t N>
+inline constexpr auto operator^(vmask<N> lhs, vmask<N> rhs) noexcept{
+  return vmask<N>{ lhs.bits ^ rhs.bits };
+}
+
+template<std::size_t N>
+inline constexpr auto operator~(vmask<N> mask) noexcept{
+  return vmask<N>{ ~mask.bits & vmask<N>::Full };
+}
+
+template<std::size_t N>
+inline constexpr auto operator==(vmask<N> lhs, vmask<N> rhs) noexcept{
+  return lhs.bits == rhs.bits;
+}
+
+template<std::size_t N>
+inline constexpr auto operator!=(vmask<N> lhs, vmask<N> rhs) noexcept{
+  return lhs.bits != rhs.bits;
+}
+
+template<std::size_t N>
+inline constexpr auto any(vmask<N> mask) noexcept{
+  return mask.bits != 0;
+}
+
+template<std::size_t N>
+inline constexpr auto all(vmask<N> mask) noexcept{
+  return mask.bits == vmask<N>::Full;
+}
+
+template<std::size_t N>
+inline constexpr auto none(vmask<N> mask) noexcept{
+  return mask.bits == 0;
+}
+
+//Bit n is set when component n passed, like SSE movemask:
+template<std::size_t N>
+inline constexpr auto movemask(vmask<N> mask) noexcept{
+  return mask.bits;
+}
+
+namespace detail{
+
+template<typename T, std::size_t N, typename Callable>
+inline constexpr auto compare_lanes(
+  const vec<T, N>& lhs,
+  const vec<T, N>& rhs,
+  Callable callable
+) noexcept{
+  auto bits = std::uint64_t(0);
+
+  for (auto i : range(N)){
+    bits |= std::uint64_t(callable(lhs[i], rhs[i])) << i;
+  }
+
+  return vmask<N>{ bits };
+}
+
+} //namespace detail
+
+template<typename T, std::size_t N>
+inline constexpr auto less(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a < b; }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto less_equal(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a <= b; }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto greater(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a > b; }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto greater_equal(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a >= b; }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto equal(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a == b; }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto not_equal(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [](const T& a, const T& b){ return a != b; }));
+}
+
+//Per component version of compare():
+template<typename T, std::size_t N>
+inline constexpr auto nearly_equal(
+  const vec<T, N>& lhs,
+  const vec<T, N>& rhs,
+  T epsilon = Epsilon<T>
+) noexcept{
+  return GEFEC_MATH_TRACE(compare, detail::compare_lanes(lhs, rhs, [&](const T& a, const T& b){
+    return a >= b - epsilon && a <= b + epsilon;
+  }));
+}
+
+//Takes the component of a where the mask is set and of b elsewhere, without branching:
+template<typename T, std::size_t N>
+inline constexpr auto select(vmask<N> mask, const vec<T, N>& a, const vec<T, N>& b) noexcept{
+  auto result = vec<T, N>();
+
+  for (auto i : range(N)){
+    result[i] = mask[i] ? a[i] : b[i];
+  }
+
+  return GEFEC_MATH_TRACE(compare, result);
+}
+
 template<typename T, std::size_t N>
 inline constexpr auto operator-(const vec<T, N>& v) noexcept{
-  return v.map([&](const auto& e) { return -e; });
+  return GEFEC_MATH_TRACE(vec_add, v.map([&](const auto& e) { return -e; }));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator==(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return zip(lhs, rhs).every([](const auto& p){
-    return p.first == p.second;
-  });
+  return GEFEC_MATH_TRACE(compare, all(equal(lhs, rhs)));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator!=(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return !(lhs == rhs);
+  return GEFEC_MATH_TRACE(compare, !(lhs == rhs));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator+(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return zip(lhs, rhs).map([&](const auto& p){
+  return GEFEC_MATH_TRACE(vec_add, zip(lhs, rhs).map([&](const auto& p){
     return p.first + p.second;
-  });
+  }));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator*(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return zip(lhs, rhs).map([&](const auto& p){
+  return GEFEC_MATH_TRACE(vec_multiply, zip(lhs, rhs).map([&](const auto& p){
     return p.first * p.second;
-  });
+  }));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator/(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return lhs * (T(1) / rhs);
+  //The reciprocal would truncate to 0 or 1 for integers (and lose precision for fixed point):
+  if constexpr (!std::is_floating_point_v<T>){
+    auto result = vec<T, N>();
+
+    for (auto i : range(N)){
+      result[i] = lhs[i] / rhs[i];
+    }
+
+    return GEFEC_MATH_TRACE(vec_divide, result);
+  }
+  else{
+    return GEFEC_MATH_TRACE(vec_divide, lhs * (T(1) / rhs));
+  }
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator*(const vec<T, N>& v, T x) noexcept{
-  return v.map([&](const auto& e){ return e * x; });
+  return GEFEC_MATH_TRACE(vec_multiply, v.map([&](const auto& e){ return e * x; }));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator-(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
-  return lhs + (-rhs);
+  return GEFEC_MATH_TRACE(vec_add, lhs + (-rhs));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator+(const vec<T, N>& v, T x) noexcept{
-  return v + vec<T, N>(x);
+  return GEFEC_MATH_TRACE(vec_add, v + vec<T, N>(x));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator+(T x, const vec<T, N>& v) noexcept{
-  return v + x;
+  return GEFEC_MATH_TRACE(vec_add, v + x);
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator-(T x, const vec<T, N>& v) noexcept{
-  return -v + x;
+  return GEFEC_MATH_TRACE(vec_add, -v + x);
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator-(const vec<T, N>& v, T x) noexcept{
-  return v + (-x);
+  return GEFEC_MATH_TRACE(vec_add, v + (-x));
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator*(T x, const vec<T, N>& v) noexcept{
-  return v * x;
+  return GEFEC_MATH_TRACE(vec_multiply, v * x);
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator/(const vec<T, N>& v, T x) noexcept{
-  return v * (T(1) / x);
+  if constexpr (!std::is_floating_point_v<T>){
+    return GEFEC_MATH_TRACE(vec_divide, v.map([&](const auto& e){ return static_cast<T>(e / x); }));
+  }
+  else{
+    return GEFEC_MATH_TRACE(vec_divide, v * (T(1) / x));
+  }
 }
 
 template<typename T, std::size_t N>
 inline constexpr auto operator/(T x, const vec<T, N>& v) noexcept{
-  return v.map([&](const auto& e){
+  return GEFEC_MATH_TRACE(vec_divide, v.map([&](const auto& e){
     return x / e; 
-  });
+  }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto operator%(const vec<T, N>& lhs, const vec<T, N>& rhs) noexcept{
+  auto result = vec<T, N>();
+
+  for (auto i : range(N)){
+    result[i] = lhs[i] % rhs[i];
+  }
+
+  return GEFEC_MATH_TRACE(vec_divide, result);
 }
 
 template<typename T, std::size_t N>
+inline constexpr auto operator%(const vec<T, N>& v, T x) noexcept{
+  return GEFEC_MATH_TRACE(vec_divide, v.map([&](const auto& e){ return static_cast<T>(e % x); }));
+}
+
+template<typename Policy = precision::native, typename T, std::size_t N>
 inline constexpr auto dot(const vec<T, N>& v1, const vec<T, N>& v2) noexcept{
+  using A = typename Policy::template type<T>;
+
+  return GEFEC_MATH_TRACE(dot, Policy::template sum<A>(N, [&](std::size_t i){
+    return static_cast<A>(v1[i]) * static_cast<A>(v2[i]);
+  }));
+}
+
+//Sum of a whole array (anything with size() and operator[]) of numbers:
+template<typename Policy = precision::native, typename Container>
+inline constexpr auto sum(const Container& values) noexcept{
+  using T = std::decay_t<decltype(values[0])>;
+  using A = typename Policy::template type<T>;
+
+  return GEFEC_MATH_TRACE(sum, Policy::template sum<A>(values.size(), [&](std::size_t i){
+    return static_cast<A>(values[i]);
+  }));
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto distance_squared(const vec<T, N>& v1, const vec<T, N>& v2) noexcept{
   auto result = T{};
   for (auto i : range(N)){
-    result += v1[i] * v2[i];
+    const auto d = v1[i] - v2[i];
+    result += d * d;
   }
 
-  return result;
+  return GEFEC_MATH_TRACE(length, result);
 }
 
 template<typename T>
@@ -442,11 +1063,11 @@ inline constexpr auto cross(const vec<T, 3>& v1, const vec<T, 3>& v2) noexcept{
   const auto [a1, a2, a3] = v1;
   const auto [b1, b2, b3] = v2;
 
-  return vec<T, 3>(
+  return GEFEC_MATH_TRACE(cross, vec<T, 3>(
     a2 * b3 - a3 * b2,
     a3 * b1 - a1 * b3,
     a1 * b2 - a2 * b1
-  );
+  ));
 }
 
 template<typename T, std::size_t N>
@@ -466,16 +1087,342 @@ using vec4 = vec<float, 4>;
 using dvec4 = vec<double, 4>;
 using ivec4 = vec<std::int32_t, 4>;
 
-template<typename T, std::size_t W, std::size_t H>
+//W vectors stored as structure of arrays (data[component][lane]),
+//so that batched kernels can process one component of all lanes at once:
+template<typename T, std::size_t N, std::size_t W>
+struct vec_packet{
+  using value_type = T;
+  static constexpr auto Width = W;
+
+  T data[N][W];
+
+  constexpr vec_packet() noexcept : data{} {}
+
+  explicit constexpr vec_packet(const vec<T, N>& v) noexcept : data{} {
+    for (auto i : range(W)){
+      set(i, v);
+    }
+  }
+
+  constexpr auto& operator[](std::size_t n) noexcept{
+    return data[n];
+  }
+
+  constexpr const auto& operator[](std::size_t n) const noexcept{
+    return data[n];
+  }
+
+  constexpr auto get(std::size_t lane) const noexcept{
+    auto result = vec<T, N>();
+
+    for (auto n : range(N)){
+      result[n] = data[n][lane];
+    }
+
+    return result;
+  }
+
+  constexpr auto set(std::size_t lane, const vec<T, N>& v) noexcept{
+    for (auto n : range(N)){
+      data[n][lane] = v[n];
+    }
+  }
+};
+
+//W Columns x Rows matrices stored as structure of arrays (data[x][y][lane]):
+template<typename T, std::size_t Columns, std::size_t Rows, std::size_t W>
+struct mat_packet{
+  using value_type = T;
+  static constexpr auto Width = W;
+
+  T data[Columns][Rows][W];
+
+  constexpr mat_packet() noexcept : data{} {}
+
+  constexpr auto& operator[](std::size_t x) noexcept{
+    return data[x];
+  }
+
+  constexpr const auto& operator[](std::size_t x) const noexcept{
+    return data[x];
+  }
+
+  constexpr auto get(std::size_t lane) const noexcept{
+    auto result = mat<T, Columns, Rows>();
+
+    for (const auto& [x, y] : range({ Columns, Rows })){
+      result[x][y] = data[x][y][lane];
+    }
+
+    return result;
+  }
+
+  template<typename L>
+  constexpr auto set(std::size_t lane, const mat<T, Columns, Rows, L>& m) noexcept{
+    for (const auto& [x, y] : range({ Columns, Rows })){
+      data[x][y][lane] = m.at(x, y);
+    }
+  }
+};
+
+//Row (Row = true) or column of a matrix viewed in place. Elements are read
+//and written through the view without copies; it converts to vec, so it can
+//be passed wherever a vec is taken. Valid as long as the matrix is.
+template<typename T, std::size_t W, std::size_t H, typename Layout, bool Row>
+struct line_view{
+  using value_type = std::remove_const_t<T>;
+  static constexpr auto Size = Row ? W : H;
+  using vec_type = vec<value_type, Size>;
+  using storage_type = std::conditional_t<
+    std::is_const_v<T>,
+    const typename Layout::template storage<value_type, W, H>,
+    typename Layout::template storage<value_type, W, H>
+  >;
+
+  storage_type* data;
+  std::size_t index;
+
+  constexpr line_view(storage_type* data, std::size_t index) noexcept : data(data), index(index) {}
+  constexpr line_view(const line_view&) = default;
+
+  constexpr auto& operator[](std::size_t i) const noexcept{
+    if constexpr (Row) return Layout::at(*data, i, index);
+    else return Layout::at(*data, index, i);
+  }
+
+  constexpr auto size() const noexcept{
+    return Size;
+  }
+
+  constexpr auto eval() const noexcept{
+    auto result = vec_type();
+
+    for (auto i : range(Size)){
+      result[i] = (*this)[i];
+    }
+
+    return result;
+  }
+
+  constexpr operator vec_type() const noexcept{
+    return eval();
+  }
+
+  //Assignment writes the elements, it never rebinds the view:
+  constexpr auto& operator=(const vec_type& v) noexcept{
+    for (auto i : range(Size)){
+      (*this)[i] = v[i];
+    }
+
+    return *this;
+  }
+
+  constexpr auto& operator=(const line_view& other) noexcept{
+    return (*this) = other.eval();
+  }
+
+#define GEFEC_MATH_VIEW_COMPOUND(op)                                  \
+  constexpr auto& operator op##=(const vec_type& v) noexcept{         \
+    for (auto i : range(Size)){                                       \
+      (*this)[i] op##= v[i];                                          \
+    }                                                                 \
+    return *this;                                                     \
+  }                                                                   \
+  constexpr auto& operator op##=(const value_type& x) noexcept{       \
+    for (auto i : range(Size)){                                       \
+      (*this)[i] op##= x;                                             \
+    }                                                                 \
+    return *this;                                                     \
+  }
+
+  GEFEC_MATH_VIEW_COMPOUND(+)
+  GEFEC_MATH_VIEW_COMPOUND(-)
+  GEFEC_MATH_VIEW_COMPOUND(*)
+  GEFEC_MATH_VIEW_COMPOUND(/)
+
+#undef GEFEC_MATH_VIEW_COMPOUND
+
+  //Binary operators evaluate the view and return a vec:
+#define GEFEC_MATH_VIEW_OPERATOR(op)                                                          \
+  template<typename T2, std::size_t W2, std::size_t H2, typename L2, bool Row2>              \
+  friend constexpr auto operator op(                                                          \
+    const line_view& a, const line_view<T2, W2, H2, L2, Row2>& b                              \
+  ) noexcept{                                                                                 \
+    return a.eval() op b.eval();                                                              \
+  }                                                                                           \
+  friend constexpr auto operator op(const line_view& a, const vec_type& b) noexcept{          \
+    return a.eval() op b;                                                                     \
+  }                                                                                           \
+  friend constexpr auto operator op(const vec_type& a, const line_view& b) noexcept{          \
+    return a op b.eval();                                                                     \
+  }                                                                                           \
+  friend constexpr auto operator op(const line_view& a, const value_type& b) noexcept{        \
+    return a.eval() op b;                                                                     \
+  }                                                                                           \
+  friend constexpr auto operator op(const value_type& a, const line_view& b) noexcept{        \
+    return a op b.eval();                                                                     \
+  }
+
+  GEFEC_MATH_VIEW_OPERATOR(+)
+  GEFEC_MATH_VIEW_OPERATOR(-)
+  GEFEC_MATH_VIEW_OPERATOR(*)
+  GEFEC_MATH_VIEW_OPERATOR(/)
+
+#undef GEFEC_MATH_VIEW_OPERATOR
+
+  friend constexpr auto operator-(const line_view& v) noexcept{
+    return -v.eval();
+  }
+
+  friend constexpr auto operator==(const line_view& a, const vec_type& b) noexcept{
+    for (auto i : range(Size)){
+      if (a[i] != b[i]) return false;
+    }
+
+    return true;
+  }
+
+  friend constexpr auto operator!=(const line_view& a, const vec_type& b) noexcept{
+    return !(a == b);
+  }
+};
+
+template<typename T, std::size_t W, std::size_t H, typename Layout = layout::column_major>
+using row_view = line_view<T, W, H, Layout, true>;
+
+template<typename T, std::size_t W, std::size_t H, typename Layout = layout::column_major>
+using col_view = line_view<T, W, H, Layout, false>;
+
+//mat<T, W, H> viewed as its H x W transpose, in place. Products read the
+//original storage, so m.t_ref() * v doesn't build the transposed matrix.
+template<typename T, std::size_t W, std::size_t H, typename Layout = layout::column_major>
+struct transpose_view{
+  using value_type = std::remove_const_t<T>;
+  using mat_type = mat<value_type, H, W, Layout>;
+  using storage_type = typename row_view<T, W, H, Layout>::storage_type;
+
+  storage_type* data;
+
+  constexpr transpose_view(storage_type* data) noexcept : data(data) {}
+  constexpr transpose_view(const transpose_view&) = default;
+
+  //Column x of the transpose is row x of the matrix:
+  constexpr auto operator[](std::size_t x) const noexcept{
+    return row_view<T, W, H, Layout>(data, x);
+  }
+
+  constexpr auto row_ref(std::size_t n) const noexcept{
+    return col_view<T, W, H, Layout>(data, n);
+  }
+
+  constexpr auto col_ref(std::size_t n) const noexcept{
+    return row_view<T, W, H, Layout>(data, n);
+  }
+
+  //Element x, y of the transpose:
+  constexpr auto& at(std::size_t x, std::size_t y) const noexcept{
+    return Layout::at(*data, y, x);
+  }
+
+  constexpr auto eval() const noexcept{
+    auto result = mat_type();
+
+    for (const auto& [x, y] : range({ W, H })){
+      result[y][x] = at(y, x);
+    }
+
+    return result;
+  }
+
+  constexpr operator mat_type() const noexcept{
+    return eval();
+  }
+
+  constexpr auto& operator=(const mat_type& m) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      at(y, x) = m[y][x];
+    }
+
+    return *this;
+  }
+
+  constexpr auto& operator=(const transpose_view& other) noexcept{
+    return (*this) = other.eval();
+  }
+
+  friend constexpr auto operator==(const transpose_view& a, const mat_type& b) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      if (a.at(y, x) != b[y][x]) return false;
+    }
+
+    return true;
+  }
+
+  friend constexpr auto operator!=(const transpose_view& a, const mat_type& b) noexcept{
+    return !(a == b);
+  }
+
+  template<std::size_t K, typename L2>
+  friend constexpr auto operator*(const transpose_view& a, const mat<value_type, K, H, L2>& b) noexcept{
+    auto result = mat<value_type, K, W, Layout>();
+
+    for (const auto& [x, y] : range({ K, W })){
+      for (auto i : range(H)){
+        result[x][y] += a.at(i, y) * b[x][i];
+      }
+    }
+
+    return GEFEC_MATH_TRACE(mat_multiply, result);
+  }
+
+  template<std::size_t K, typename L2>
+  friend constexpr auto operator*(const mat<value_type, W, K, L2>& a, const transpose_view& b) noexcept{
+    auto result = mat<value_type, H, K, L2>();
+
+    for (const auto& [x, y] : range({ H, K })){
+      for (auto i : range(W)){
+        result[x][y] += a[i][y] * b.at(x, i);
+      }
+    }
+
+    return GEFEC_MATH_TRACE(mat_multiply, result);
+  }
+
+  friend constexpr auto operator*(const transpose_view& a, const vec<value_type, H>& v) noexcept{
+    auto result = vec<value_type, W>();
+
+    for (auto y : range(W)){
+      for (auto i : range(H)){
+        result[y] += a.at(i, y) * v[i];
+      }
+    }
+
+    return GEFEC_MATH_TRACE(mat_vec, result);
+  }
+
+  friend constexpr auto operator*(const vec<value_type, W>& v, const transpose_view& b) noexcept{
+    auto result = vec<value_type, H>();
+
+    for (auto x : range(H)){
+      for (auto i : range(W)){
+        result[x] += v[i] * b.at(x, i);
+      }
+    }
+
+    return GEFEC_MATH_TRACE(mat_vec, result);
+  }
+};
+
+template<typename T, std::size_t W, std::size_t H, typename Layout>
 struct mat_base{
-  T data[W][H];
+  typename Layout::template storage<T, W, H> data;
 
   constexpr mat_base() noexcept : data{} {}
 
-  template<typename T2, typename = detail::all_convertible<T, T2>>
-  explicit constexpr mat_base(const mat<T2, W, H>& other){
+  template<typename T2, typename L2, typename = detail::all_convertible<T, T2>>
+  explicit constexpr mat_base(const mat<T2, W, H, L2>& other){
     for (const auto& [x, y] : range({ W, H })){
-      (*this)[x][y] = static_cast<T>(other[x][y]);
+      at(x, y) = static_cast<T>(other.at(x, y));
     }
   }
 
@@ -484,34 +1431,46 @@ struct mat_base{
     T array[] = { args... };
 
     for (const auto& [x, y] : range({ W, H })){
-      this->data[x][y] = array[y * W + x];
+      at(x, y) = array[y * W + x];
     }
   }
 
-  constexpr auto& operator=(const mat<T, W, H>& m){
+  constexpr auto& operator=(const mat<T, W, H, Layout>& m){
     for (const auto& [x, y] : range({ W, H })){
-      data[x][y] = m.data[x][y];
+      at(x, y) = m.at(x, y);
     }
 
     return *this;
   }
 
-  constexpr const auto& operator[](std::size_t x) const noexcept{
-    return data[x];
+  //Element in column x, row y, whatever the layout:
+  constexpr const auto& at(std::size_t x, std::size_t y) const noexcept{
+    return Layout::at(data, x, y);
   }
 
-  constexpr auto& operator[](std::size_t x) noexcept{
-    return data[x];
+  constexpr auto& at(std::size_t x, std::size_t y) noexcept{
+    return Layout::at(data, x, y);
+  }
+
+  //Column x, a plain array in column-major storage and a col_view otherwise:
+  constexpr decltype(auto) operator[](std::size_t x) const noexcept{
+    if constexpr (std::is_same_v<Layout, layout::column_major>) return (data[x]);
+    else return col_ref(x);
+  }
+
+  constexpr decltype(auto) operator[](std::size_t x) noexcept{
+    if constexpr (std::is_same_v<Layout, layout::column_major>) return (data[x]);
+    else return col_ref(x);
   }
 
   template<typename Callable>
   constexpr auto map(Callable callable) const noexcept{
     using item_type = decltype(callable(std::declval<T&>()));
 
-    auto result = mat<item_type, W, H>();
+    auto result = mat<item_type, W, H, Layout>();
 
     for (const auto& [x, y] : range({ W, H })){
-      result[x][y] = callable(data[x][y]);
+      result.at(x, y) = callable(at(x, y));
     }
 
     return result;
@@ -520,161 +1479,221 @@ struct mat_base{
   template<typename Callable>
   constexpr auto every(Callable callable) const noexcept{
     for (const auto& [x, y] : range({ W, H })){
-      if (!callable(data[x][y])) return false;
+      if (!callable(at(x, y))) return false;
     }
 
     return true;
   }
 
   constexpr auto t() const noexcept{
-    auto result = mat<T, H, W>();
+    auto result = mat<T, H, W, Layout>();
 
     for (const auto& [x, y] : range({ W, H })){
-      result[y][x] = data[x][y];
+      result.at(y, x) = at(x, y);
     }
     
-    return result;
+    return GEFEC_MATH_TRACE(transpose, result);
+  }
+
+  //Views of the storage, see row_view, col_view and transpose_view:
+  constexpr auto row_ref(std::size_t n) noexcept{
+    return row_view<T, W, H, Layout>(&data, n);
+  }
+
+  constexpr auto row_ref(std::size_t n) const noexcept{
+    return row_view<const T, W, H, Layout>(&data, n);
+  }
+
+  constexpr auto col_ref(std::size_t n) noexcept{
+    return col_view<T, W, H, Layout>(&data, n);
+  }
+
+  constexpr auto col_ref(std::size_t n) const noexcept{
+    return col_view<const T, W, H, Layout>(&data, n);
+  }
+
+  constexpr auto t_ref() noexcept{
+    return transpose_view<T, W, H, Layout>(&data);
+  }
+
+  constexpr auto t_ref() const noexcept{
+    return transpose_view<const T, W, H, Layout>(&data);
   }
 
   constexpr auto row(std::size_t n) const noexcept{
-    auto result = vec<T, W>();
+    return row_ref(n).eval();
+  }
+
+  constexpr auto col(std::size_t n) const noexcept{
+    return col_ref(n).eval();
+  }
+
+  constexpr auto set_row(std::size_t n, const vec<T, W>& v) noexcept{
+    row_ref(n) = v;
+  }
+
+  constexpr auto set_col(std::size_t n, const vec<T, H>& v) noexcept{
+    col_ref(n) = v;
+  }
 
+  constexpr auto swap_rows(std::size_t r1, std::size_t r2) noexcept{
     for (auto i : range(W)){
-      result[i] = data[i][n];
+      const auto t = at(i, r1);
+      at(i, r1) = at(i, r2);
+      at(i, r2) = t;
     }
+  }
 
-    return result;
+  constexpr auto is_any_row_zero() const noexcept{
+    for (auto y : range(H)){
+      if (row_ref(y) == vec<T, W>(T())) return true;
+    }
+
+    return false;
   }
 
-  constexpr auto col(std::size_t n) const noexcept{
-    auto result = vec<T, H>();
+  constexpr auto is_any_column_zero() const noexcept{
+    for (auto x : range(W)){
+      if (col_ref(x) == vec<T, H>(T())) return true;
+    }
 
-    for (auto i : range(H)){
-      result[i] = data[n][i];
+    return false;
+  }; 
+
+  //Compound operators work in place, rounding like the binary operators:
+  constexpr auto& operator+=(const mat<T, W, H, Layout>& other) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      at(x, y) = at(x, y) + other.at(x, y);
     }
 
-    return result;
+    return GEFEC_MATH_TRACE(mat_add, self());
   }
 
-  constexpr auto set_row(std::size_t n, const vec<T, W>& v) noexcept{
-    for (auto i : range(W)){
-      data[i][n] = v[i];
+  constexpr auto& operator+=(const T& value) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      at(x, y) = at(x, y) + value;
     }
+
+    return GEFEC_MATH_TRACE(mat_add, self());
   }
 
-  constexpr auto set_col(std::size_t n, const vec<T, H>& v) noexcept{
-    for (auto i : range(H)){
-      data[n][i] = v[i];
+  constexpr auto& operator-=(const mat<T, W, H, Layout>& other) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      at(x, y) = at(x, y) + (-other.at(x, y));
     }
+
+    return GEFEC_MATH_TRACE(mat_add, self());
   }
 
-  constexpr auto swap_rows(std::size_t r1, std::size_t r2) noexcept{
-    const auto temp = row(r1);
-    set_row(r1, row(r2));
-    set_row(r2, temp);
+  constexpr auto& operator-=(const T& value) noexcept{
+    return GEFEC_MATH_TRACE(mat_add, (*this) += -value);
   }
 
-  constexpr auto is_any_row_zero() const noexcept{
-    for (auto i : range(W)){
-      if (row(i) != vec<T, W>(static_cast<T>(0))) return false;
+  constexpr auto& operator*=(const T& value) noexcept{
+    for (const auto& [x, y] : range({ W, H })){
+      at(x, y) = at(x, y) * value;
     }
 
-    return true;
-  }; 
-
-  constexpr auto is_any_column_zero() const noexcept{
-    for (auto i : range(H)){
-      if (col(i) != vec<T, H>(static_cast<T>(0))) return false;
-    }
+    return GEFEC_MATH_TRACE(mat_scale, self());
+  }
 
-    return true;
-  }; 
+  constexpr auto& operator/=(const T& value) noexcept{
+    return GEFEC_MATH_TRACE(mat_scale, (*this) *= static_cast<T>(1.0) / value);
+  }
 
-};
+  //m *= b is m = m * b, one row at a time: row y of the product only needs
+  //row y of m, so a single row is buffered. b is copied first when it is m:
+  template<typename L2>
+  constexpr auto operator*=(const mat<T, W, W, L2>& other) noexcept -> mat<T, W, H, Layout>&{
+    if (static_cast<const void*>(&other) == static_cast<const void*>(this)){
+      const auto copy = other;
+      return (*this) *= copy;
+    }
 
-template<typename T, std::size_t W, std::size_t H>
-struct mat : mat_base<T, W, H>{
-  using value_type = T;
+    for (auto y : range(H)){
+      T row[W];
 
-  constexpr mat() noexcept : mat_base<T, W, H>() {}
+      for (auto i : range(W)){
+        row[i] = at(i, y);
+      }
 
-  template<typename T2>
-  explicit constexpr mat(const mat<T2, W, H>& mat)
-  : mat_base<T, W, H>(mat) {}
+      for (auto x : range(W)){
+        auto e = T();
 
-  template<typename... Targs, typename = detail::all_convertible<T, Targs...>>
-  constexpr mat(const Targs&... args) noexcept 
-  : mat_base<T, W, H>(args...) {}
+        for (auto i : range(W)){
+          e += row[i] * other.at(x, i);
+        }
 
-  constexpr auto& operator+=(const mat& other) noexcept{
-    return (*this) = (*this) + other;
-  }
+        at(x, y) = e;
+      }
+    }
 
-  constexpr auto& operator+=(const T& x) noexcept{
-    return (*this) = (*this) + x;
+    return GEFEC_MATH_TRACE(mat_multiply, self());
   }
 
-  constexpr auto& operator-=(const mat& other) noexcept{
-    return (*this) = (*this) - other;
+  template<typename L2>
+  constexpr auto& operator/=(const mat<T, W, W, L2>& other) noexcept{
+    return GEFEC_MATH_TRACE(mat_multiply, (*this) *= static_cast<T>(1.0) / other);
   }
 
-  constexpr auto& operator-=(const T& x) noexcept{
-    return (*this) = (*this) - x;
+private:
+  constexpr auto& self() noexcept{
+    return static_cast<mat<T, W, H, Layout>&>(*this);
   }
+};
 
-  constexpr auto& operator*=(const vec<T, W>& other) noexcept{
-    return (*this) = (*this) * other;
-  }
+template<typename T, std::size_t W, std::size_t H, typename Layout>
+struct mat : mat_base<T, W, H, Layout>{
+  using value_type = T;
+  using layout_type = Layout;
 
-  constexpr auto& operator*=(const T& x) noexcept{
-    return (*this) = (*this) * x;
-  }
+  constexpr mat() noexcept : mat_base<T, W, H, Layout>() {}
 
-  constexpr auto& operator/=(const vec<T, W>& other) noexcept{
-    return (*this) = (*this) / other;
-  }
+  template<typename T2, typename L2>
+  explicit constexpr mat(const mat<T2, W, H, L2>& mat)
+  : mat_base<T, W, H, Layout>(mat) {}
 
-  constexpr auto& operator/=(const T& x) noexcept{
-    return (*this) = (*this) / x;
-  }
+  template<typename... Targs, typename = detail::all_convertible<T, Targs...>>
+  constexpr mat(const Targs&... args) noexcept 
+  : mat_base<T, W, H, Layout>(args...) {}
 };
 
-template<typename T, std::size_t N>
-struct mat<T, N, N> : mat_base<T, N, N>{
+template<typename T, std::size_t N, typename Layout>
+struct mat<T, N, N, Layout> : mat_base<T, N, N, Layout>{
   using value_type = T;
+  using layout_type = Layout;
 
   static constexpr auto filled(const T& value){
     return mat().map([&](auto){ return value; });
   }
 
-  constexpr mat() noexcept : mat_base<T, N, N>() {}
-  template<typename T2>
-  explicit constexpr mat(const mat<T2, N, N>& mat)
-  : mat_base<T, N, N>(mat) {}
+  constexpr mat() noexcept : mat_base<T, N, N, Layout>() {}
+  template<typename T2, typename L2>
+  explicit constexpr mat(const mat<T2, N, N, L2>& mat)
+  : mat_base<T, N, N, Layout>(mat) {}
 
   template<typename... Targs, typename = detail::all_convertible<T, Targs...>>
   constexpr mat(const Targs&... args) noexcept 
-  : mat_base<T, N, N>(args...) {}
+  : mat_base<T, N, N, Layout>(args...) {}
 
   constexpr mat(T value) noexcept : mat() {
     for (auto i : range(N)){
-      this->data[i][i] = value;
+      this->at(i, i) = value;
     }
   }
 
+  template<typename Policy = precision::native>
   constexpr auto diagonal_product() const noexcept{
-    auto result = 1.0;
+    using A = typename Policy::template type<T>;
 
-    for (auto i : range(N)){
-      result *= this->data[i][i];
-    }
-
-    return result;
+    return Policy::template product<A>(N, [&](std::size_t i){
+      return static_cast<A>(this->at(i, i));
+    });
   }
 
   constexpr auto is_diagonal_zero() const noexcept{
     for (auto i : range(N)){
-      if (this->data[i][i] != 0.0) return false;
+      if (this->at(i, i) != T()) return false;
     }
 
     return true;
@@ -683,7 +1702,7 @@ struct mat<T, N, N> : mat_base<T, N, N>{
   constexpr auto is_upper_triangular() const noexcept{
     for (auto x : range(N - 1)){
       for (auto y : range(x + 1, N)){
-        if (this->data[x][y] != 0.0) return false;
+        if (this->at(x, y) != T()) return false;
       }
     }
 
@@ -693,7 +1712,7 @@ struct mat<T, N, N> : mat_base<T, N, N>{
   constexpr auto is_lower_triangular() const noexcept{
     for (auto x : range(1, N)){
       for (auto y : range(x)){
-        if (this->data[x][y] != 0.0) return false;
+        if (this->at(x, y) != T()) return false;
       }
     }
 
@@ -708,81 +1727,56 @@ struct mat<T, N, N> : mat_base<T, N, N>{
     return is_upper_triangular() && is_lower_triangular();
   }
 
-  constexpr auto det() const noexcept -> T{
-    auto mat = (*this);
-    auto sign = 1;
-
-    for (auto x : range(N - 1)){
-      if (mat.is_any_row_zero() || mat.is_any_column_zero() || mat.is_diagonal_zero()) return T();
-
-      if (mat.is_triangular()){
-        return sign * mat.diagonal_product();
-      }
+  //The elimination runs in the policy's accumulator type. It is traced as a
+  //whole, the row operations it is made of aren't counted:
+  template<typename Policy = precision::native>
+  constexpr auto det() const noexcept{
+    using A = typename Policy::template type<T>;
 
-      if (mat[x][x] == T()){
-        for (auto y : range(N)){
-          if (mat[x][y] != T() && mat[y][x] != T()){
-            sign = -sign;
-            mat.swap_rows(x, y);
-            break;
-          }
-        }
-      }
+    return GEFEC_MATH_TRACE(det, [&]{
+      auto mat = math::mat<A, N, N>();
+      auto sign = A(1);
 
-      for (auto y : range(x + 1, N)){
-        mat.set_row(y, mat.row(y) - mat.row(x) * mat[x][y] / mat[x][x]);
+      for (auto [x, y] : range({ N, N })){
+        mat[x][y] = static_cast<A>(this->at(x, y));
       }
-    }
-    return sign * mat.diagonal_product();
-  }
-
-  constexpr auto& operator+=(const mat& other) noexcept{
-    return (*this) = (*this) + other;
-  }
 
-  constexpr auto& operator+=(const T& x) noexcept{
-    return (*this) = (*this) + x;
-  }
-
-  constexpr auto& operator-=(const mat& other) noexcept{
-    return (*this) = (*this) - other;
-  }
+      const auto diagonal_product = [&]{
+        return Policy::template product<A>(N, [&](std::size_t i){ return mat[i][i]; });
+      };
 
-  constexpr auto& operator-=(const T& x) noexcept{
-    return (*this) = (*this) - x;
-  }
-
-  constexpr auto& operator*=(const vec<T, N>& other) noexcept{
-    return (*this) = (*this) * other;
-  }
+      for (auto x : range(N - 1)){
+        if (mat.is_any_row_zero() || mat.is_any_column_zero() || mat.is_diagonal_zero()) return A();
 
-  constexpr auto& operator*=(const T& x) noexcept{
-    return (*this) = (*this) * x;
-  }
+        if (mat.is_triangular()){
+          return sign * diagonal_product();
+        }
 
-  constexpr auto& operator/=(const vec<T, N>& other) noexcept{
-    return (*this) = (*this) / other;
-  }
+        if (mat[x][x] == A()){
+          for (auto y : range(N)){
+            if (mat[x][y] != A() && mat[y][x] != A()){
+              sign = -sign;
+              mat.swap_rows(x, y);
+              break;
+            }
+          }
+        }
 
-  constexpr auto& operator/=(const T& x) noexcept{
-    return (*this) = (*this) / x;
+        for (auto y : range(x + 1, N)){
+          mat.row_ref(y) -= mat.row_ref(x) * mat[x][y] / mat[x][x];
+        }
+      }
+      return sign * diagonal_product();
+    }());
   }
 };
 
-template<typename T>
-inline constexpr T Epsilon = T();
-
-template<>
-inline constexpr auto Epsilon<float> = 0.00001f;
-
-template<>
-inline constexpr auto Epsilon<double> = 0.000'000'000'001;
-
 template<typename T>
 auto compare(const T& a, const T& b, T epsilon = Epsilon<T>){
-  return
+  return GEFEC_MATH_TRACE(compare,
     a >= b - epsilon &&
-    a <= b + epsilon;
+    a <= b + epsilon
+  );
 }
 
 template<typename T, std::size_t N>
@@ -791,17 +1785,12 @@ auto compare(
   const vec<T, N>& b, 
   T epsilon = Epsilon<T>
 ){
-  return zip(a, b).every([&](const auto& p){
-    const auto [a, b] = p;
-    return 
-      a >= b - epsilon &&
-      a <= b + epsilon;
-  });
+  return GEFEC_MATH_TRACE(compare, all(nearly_equal(a, b, epsilon)));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto zip(const mat<T, W, H>& m1, const mat<T, W, H>& m2) noexcept{
-  auto result = mat<std::pair<T, T>, W, H>();
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto zip(const mat<T, W, H, L>& m1, const mat<T, W, H, L>& m2) noexcept{
+  auto result = mat<std::pair<T, T>, W, H, L>();
 
   for (const auto& [x, y] : range({ W, H })){
     result[x][y] = std::make_pair(m1[x][y], m2[x][y]);
@@ -821,13 +1810,13 @@ inline constexpr auto to_mat(const vec<T, N>& vec) noexcept{
   return result;
 }
 
-template<typename T>
-inline constexpr auto to_vec(const mat<T, 1, 1>& mat) noexcept{
+template<typename T, typename L>
+inline constexpr auto to_vec(const mat<T, 1, 1, L>& mat) noexcept{
   return vec<T, 1>(mat[0][0]);
 }
 
-template<typename T, std::size_t N>
-inline constexpr auto to_vec(const mat<T, N, 1>& mat) noexcept{
+template<typename T, std::size_t N, typename L>
+inline constexpr auto to_vec(const mat<T, N, 1, L>& mat) noexcept{
   auto result = vec<T, N>();
 
   for (auto i : range(N)){
@@ -837,138 +1826,332 @@ inline constexpr auto to_vec(const mat<T, N, 1>& mat) noexcept{
   return result;
 }
 
-template<typename T, std::size_t N>
-inline constexpr auto to_vec(const mat<T, 1, N>& mat) noexcept{
+template<typename T, std::size_t N, typename L>
+inline constexpr auto to_vec(const mat<T, 1, N, L>& mat) noexcept{
   return to_vec(mat.t());
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator==(const mat<T, W, H>& m1, const mat<T, W, H>& m2) noexcept{
-  return zip(m1, m2).every([](const auto& p){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator==(const mat<T, W, H, L>& m1, const mat<T, W, H, L>& m2) noexcept{
+  return GEFEC_MATH_TRACE(compare, zip(m1, m2).every([](const auto& p){
     return p.first == p.second;
-  });
+  }));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator!=(const mat<T, W, H>& m1, const mat<T, W, H>& m2) noexcept{
-  return !(m1 == m2);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator!=(const mat<T, W, H, L>& m1, const mat<T, W, H, L>& m2) noexcept{
+  return GEFEC_MATH_TRACE(compare, !(m1 == m2));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator+(const mat<T, W, H>& m1, const mat<T, W, H>& m2) noexcept{
-  return zip(m1, m2).map([](const auto& p){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator+(const mat<T, W, H, L>& m1, const mat<T, W, H, L>& m2) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, zip(m1, m2).map([](const auto& p){
     return p.first + p.second;
-  });
+  }));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator+(const mat<T, W, H>& mat, T value) noexcept{
-  return mat.map([&](const auto& e){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator+(const mat<T, W, H, L>& mat, T value) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, mat.map([&](const auto& e){
     return e + value;
-  });
+  }));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator+(T value, const mat<T, W, H>& mat) noexcept{
-  return mat + value;
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator+(T value, const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, mat + value);
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator-(const mat<T, W, H>& mat) noexcept{
-  return mat.map([](const auto& e){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator-(const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, mat.map([](const auto& e){
     return -e;
-  });
+  }));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator-(const mat<T, W, H>& m1, const mat<T, W, H>& m2) noexcept{
-  return m1 + (-m2);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator-(const mat<T, W, H, L>& m1, const mat<T, W, H, L>& m2) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, m1 + (-m2));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator-(const mat<T, W, H>& mat, T value) noexcept{
-  return mat + (-value);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator-(const mat<T, W, H, L>& mat, T value) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, mat + (-value));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator-(T value, const mat<T, W, H>& mat) noexcept{
-  return value + (-mat);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator-(T value, const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_add, value + (-mat));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator*(const mat<T, W, H>& mat, T value) noexcept{
-  return mat.map([&](const auto& e){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator*(const mat<T, W, H, L>& mat, T value) noexcept{
+  return GEFEC_MATH_TRACE(mat_scale, mat.map([&](const auto& e){
     return e * value;
-  });
+  }));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator*(T value, const mat<T, W, H>& mat) noexcept{
-  return mat * value;
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator*(T value, const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_scale, mat * value);
 }
 
-template<typename T, std::size_t W, std::size_t H, std::size_t W2>
-inline constexpr auto operator*(const mat<T, W, H>& m1, const mat<T, W2, W>& m2) noexcept{
-  auto result = mat<T, W2, H>();
+//The product takes the left operand's layout. Row-major results are filled
+//row by row so the innermost loop walks contiguous memory; each element
+//still sums over i in the same order, so both layouts give identical results.
+template<typename T, std::size_t W, std::size_t H, std::size_t W2, typename L1, typename L2>
+inline constexpr auto operator*(const mat<T, W, H, L1>& m1, const mat<T, W2, W, L2>& m2) noexcept{
+  auto result = mat<T, W2, H, L1>();
 
-  for (const auto& [x, y] : range({ W2, H })){
-    for (auto i : range(W)){
-      result[x][y] += m1[i][y] * m2[x][i];
+  if constexpr (std::is_same_v<L1, layout::row_major>){
+    for (auto y : range(H)){
+      for (auto i : range(W)){
+        for (auto x : range(W2)){
+          result.at(x, y) += m1.at(i, y) * m2.at(x, i);
+        }
+      }
+    }
+  }
+  else{
+    for (const auto& [x, y] : range({ W2, H })){
+      for (auto i : range(W)){
+        result.at(x, y) += m1.at(i, y) * m2.at(x, i);
+      }
     }
   }
 
-  return result;
+  return GEFEC_MATH_TRACE(mat_multiply, result);
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator*(const vec<T, H>& vec, const mat<T, W, H>& mat) noexcept{
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator*(const vec<T, H>& vec, const mat<T, W, H, L>& mat) noexcept{
   const auto vec_mat = to_mat(vec);
 
-  return to_vec(vec_mat * mat);
+  return GEFEC_MATH_TRACE(mat_vec, to_vec(vec_mat * mat));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator*(const mat<T, W, H>& mat, const vec<T, W>& vec) noexcept{
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator*(const mat<T, W, H, L>& mat, const vec<T, W>& vec) noexcept{
   const auto vec_mat = to_mat(vec);
 
-  return to_vec(mat * vec_mat.t());
+  return GEFEC_MATH_TRACE(mat_vec, to_vec(mat * vec_mat.t()));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator/(const mat<T, W, H>& mat, T value) noexcept{
-  return mat * (static_cast<T>(1.0) / value);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator/(const mat<T, W, H, L>& mat, T value) noexcept{
+  return GEFEC_MATH_TRACE(mat_scale, mat * (static_cast<T>(1.0) / value));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator/(T value, const mat<T, W, H>& mat) noexcept{
-  return mat.map([&](const auto& e){
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator/(T value, const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_scale, mat.map([&](const auto& e){
     return value / e;
-  });
+  }));
+}
+
+template<typename T, std::size_t W, std::size_t H, std::size_t W2, typename L1, typename L2>
+inline constexpr auto operator/(const mat<T, W, H, L1>& m1, const mat<T, W2, W, L2>& m2) noexcept{
+  return GEFEC_MATH_TRACE(mat_multiply, m1 * (static_cast<T>(1.0) / m2));
 }
 
-template<typename T, std::size_t W, std::size_t H, std::size_t W2>
-inline constexpr auto operator/(const mat<T, W, H>& m1, const mat<T, W2, W>& m2) noexcept{
-  return m1 * (static_cast<T>(1.0) / m2);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator/(const vec<T, H>& vec, const mat<T, W, H, L>& mat) noexcept{
+  return GEFEC_MATH_TRACE(mat_vec, vec * (static_cast<T>(1.0) / mat));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator/(const vec<T, H>& vec, const mat<T, W, H>& mat) noexcept{
-  return vec * (static_cast<T>(1.0) / mat);
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto operator/(const mat<T, W, H, L>& mat, const vec<T, W>& vec) noexcept{
+  return GEFEC_MATH_TRACE(mat_vec, mat * (static_cast<T>(1.0) / vec));
 }
 
-template<typename T, std::size_t W, std::size_t H>
-inline constexpr auto operator/(const mat<T, W, H>& mat, const vec<T, W>& vec) noexcept{
-  return mat * (static_cast<T>(1.0) / vec);
+//v *= m is v = v * m; every component of the product needs all of v, so v
+//is buffered instead of going through to_mat and to_vec:
+template<typename T, std::size_t N>
+template<typename L>
+constexpr auto vec<T, N>::operator*=(const mat<T, N, N, L>& m) noexcept -> vec&{
+  const auto v = *this;
+
+  for (auto x : range(N)){
+    auto e = T();
+
+    for (auto i : range(N)){
+      e += v[i] * m.at(x, i);
+    }
+
+    (*this)[x] = e;
+  }
+
+  return GEFEC_MATH_TRACE(mat_vec, *this);
 }
 
+//v /= m is v = v / m, the product with the element-wise reciprocal of m:
 template<typename T, std::size_t N>
-constexpr auto vec<T, N>::operator*=(const mat<T, N, N>& m) noexcept -> vec&{
-  return (*this) = (*this) * m;
+template<typename L>
+constexpr auto vec<T, N>::operator/=(const mat<T, N, N, L>& m) noexcept -> vec&{
+  const auto v = *this;
+
+  for (auto x : range(N)){
+    auto e = T();
+
+    for (auto i : range(N)){
+      e += v[i] * (static_cast<T>(1.0) / m.at(x, i));
+    }
+
+    (*this)[x] = e;
+  }
+
+  return GEFEC_MATH_TRACE(mat_vec, *this);
 }
 
+namespace detail{
+
+//Rows and columns of a product chain operand. A vector is a row at the
+//front of the chain (like vec * mat) and a column anywhere else:
+template<typename Operand, bool First>
+struct chain_shape;
+
+template<typename T, std::size_t W, std::size_t H, typename L, bool First>
+struct chain_shape<mat<T, W, H, L>, First>{
+  static constexpr auto Rows = H;
+  static constexpr auto Columns = W;
+
+  static constexpr auto as_mat(const mat<T, W, H, L>& m) noexcept{
+    return m;
+  }
+};
+
+template<typename T, std::size_t N, bool First>
+struct chain_shape<vec<T, N>, First>{
+  static constexpr auto Rows = First ? std::size_t(1) : N;
+  static constexpr auto Columns = First ? N : std::size_t(1);
+
+  static constexpr auto as_mat(const vec<T, N>& v) noexcept{
+    if constexpr (First) return to_mat(v);
+    else return to_mat(v).t();
+  }
+};
+
+template<typename Operand>
+inline constexpr auto is_vec_operand = false;
+
 template<typename T, std::size_t N>
-constexpr auto vec<T, N>::operator/=(const mat<T, N, N>& mat) noexcept -> vec&{
-  return (*this) = (*this) * mat;
+inline constexpr auto is_vec_operand<vec<T, N>> = true;
+
+//Cheapest parenthesization of a chain of N matrices, operand i being
+//dims[i] x dims[i + 1]. split[i][j] is the last operand of the left
+//factor of the product of operands i..j. Equal costs keep the leftmost split.
+template<std::size_t N>
+struct chain_order{
+  std::size_t dims[N + 1] = {};
+  std::size_t split[N][N] = {};
+  std::size_t cost[N][N] = {};
+
+  constexpr chain_order(const std::size_t (&shape)[N + 1]) noexcept{
+    for (auto i = std::size_t(0); i < N + 1; ++i){
+      dims[i] = shape[i];
+    }
+
+    for (auto length = std::size_t(2); length <= N; ++length){
+      for (auto i = std::size_t(0); i + length <= N; ++i){
+        const auto j = i + length - 1;
+        cost[i][j] = std::size_t(-1);
+
+        for (auto k = i; k < j; ++k){
+          const auto c = cost[i][k] + cost[k + 1][j] + dims[i] * dims[k + 1] * dims[j + 1];
+
+          if (c < cost[i][j]){
+            cost[i][j] = c;
+            split[i][j] = k;
+          }
+        }
+      }
+    }
+  }
+
+  //Multiply-adds of the whole product:
+  constexpr auto total_cost() const noexcept{
+    return cost[0][N - 1];
+  }
+};
+
+} //namespace detail
+
+//Lazy product of matrices (and vectors at its ends). Operands are stored by
+//value, the product is evaluated in the order with the fewest multiply-adds,
+//chosen at compile time from the shapes: M * M * M * v becomes three
+//matrix-vector products instead of two matrix-matrix products and one matrix-vector product.
+template<typename... Operands>
+struct product_chain{
+  static constexpr auto Count = sizeof...(Operands);
+
+  std::tuple<Operands...> operands;
+
+private:
+  template<std::size_t I>
+  using operand_type = std::tuple_element_t<I, std::tuple<Operands...>>;
+
+  template<std::size_t I>
+  using shape = detail::chain_shape<operand_type<I>, I == 0>;
+
+  template<std::size_t... I>
+  static constexpr auto make_order(std::index_sequence<I...>) noexcept{
+    constexpr std::size_t dims[] = { shape<I>::Rows..., shape<Count - 1>::Columns };
+    return detail::chain_order<Count>(dims);
+  }
+
+  template<std::size_t... I>
+  static constexpr auto shapes_match(std::index_sequence<I...>) noexcept{
+    return ((shape<I>::Columns == shape<I + 1>::Rows) && ...);
+  }
+
+  static_assert(Count > 0, "empty product");
+  static_assert(shapes_match(std::make_index_sequence<Count - 1>()), "operand shapes don't match (vectors can only start or end a chain)");
+
+  template<std::size_t I, std::size_t J>
+  constexpr auto evaluate() const noexcept{
+    if constexpr (I == J){
+      return shape<I>::as_mat(std::get<I>(operands));
+    }
+    else{
+      constexpr auto K = Order.split[I][J];
+      return evaluate<I, K>() * evaluate<K + 1, J>();
+    }
+  }
+
+public:
+  static constexpr auto Order = make_order(std::make_index_sequence<Count>());
+
+  constexpr product_chain(const Operands&... operands) noexcept : operands(operands...) {}
+
+  constexpr product_chain(const std::tuple<Operands...>& operands) noexcept : operands(operands) {}
+
+  //A matrix, a vector when the chain starts or ends with one, a scalar when both ends are vectors:
+  constexpr auto eval() const noexcept{
+    constexpr auto Front = detail::is_vec_operand<operand_type<0>>;
+    constexpr auto Back = detail::is_vec_operand<operand_type<Count - 1>>;
+
+    const auto result = evaluate<0, Count - 1>();
+
+    if constexpr (Front && Back && Count > 1) return result[0][0];
+    else if constexpr (Front || Back) return to_vec(result);
+    else return result;
+  }
+
+  template<typename Result, typename = std::enable_if_t<std::is_same_v<Result, decltype(std::declval<product_chain>().eval())>>>
+  constexpr operator Result() const noexcept{
+    return eval();
+  }
+
+  template<typename Operand>
+  constexpr auto operator*(const Operand& operand) const noexcept{
+    return product_chain<Operands..., Operand>(std::tuple_cat(operands, std::tuple<Operand>(operand)));
+  }
+};
+
+//Starts a lazy product: m::chain(projection) * view * model * point, or m::chain(projection, view, model, point).
+template<typename... Operands>
+inline constexpr auto chain(const Operands&... operands) noexcept{
+  return product_chain<Operands...>(operands...);
 }
 
 using mat2 = mat<float, 2, 2>;
@@ -989,7 +2172,7 @@ inline constexpr auto translation(const vec<T, N>& v) noexcept{
     m[N][i] = v[i];
   }
 
-  return m;
+  return GEFEC_MATH_TRACE(transform, m);
 }
 
 template<typename T, std::size_t N>
@@ -1000,7 +2183,7 @@ inline constexpr auto scale(const vec<T, N>& v) noexcept{
     m[i][i] = v[i];
   }
 
-  return m;
+  return GEFEC_MATH_TRACE(transform, m);
 }
 
 template<typename T, std::size_t N>
@@ -1010,15 +2193,17 @@ inline constexpr auto rotation(T radians, const vec<T, N>& v) noexcept{
   const auto x2 = x * x;
   const auto y2 = y * y;
   const auto z2 = z * z;
-  const auto sin = std::sin(radians);
-  const auto cos = std::cos(radians);
+  const auto sin = detail::adl_sin(radians);
+  const auto cos = detail::adl_cos(radians);
+  const auto one = T(1);
+  const auto zero = T(0);
 
-  return mat<T, N + 1, N + 1>(
-    cos + x2 * (1 - cos), x * y * (1 - cos) - z * sin, x * z * (1 - cos) + y * sin, 0.f, 
-    y * x * (1 - cos) + z * sin, cos + y2 * (1 - cos), y * z * (1 - cos) - x * sin, 0.f, 
-    z * z * (1 - cos) - y * sin, y * z * (1 - cos) + x * sin, cos + z2 * (1 - cos), 0.f,
-    0.f, 0.f, 0.f, 1.f
-  ).t();
+  return GEFEC_MATH_TRACE(transform, mat<T, N + 1, N + 1>(
+    cos + x2 * (one - cos), x * y * (one - cos) - z * sin, x * z * (one - cos) + y * sin, zero, 
+    y * x * (one - cos) + z * sin, cos + y2 * (one - cos), y * z * (one - cos) - x * sin, zero, 
+    z * x * (one - cos) - y * sin, y * z * (one - cos) + x * sin, cos + z2 * (one - cos), zero,
+    zero, zero, zero, one
+  ).t());
 }
 
 template<typename T>
@@ -1038,22 +2223,22 @@ inline constexpr auto rotation_z(T radians) noexcept{
 
 template<typename T>
 inline constexpr auto perspective(T aspect_ratio, T fov, T z_near, T z_far){
-  return mat<T, 4, 4>(
+  return GEFEC_MATH_TRACE(transform, mat<T, 4, 4>(
     aspect_ratio / std::tan(fov / 2.f), 0.f, 0.f, 0.f,
     0.f, 1.f / std::tan(fov / 2.f), 0.f, 0.f,
     0.f, 0.f, z_far / (z_far - z_near), 1.f,
     0.f, 0.f, -z_far * z_near / (z_far - z_near), 0.f
-  );
+  ));
 }
 
 template<typename T>
 inline constexpr auto ortho(T left, T right, T top, T bottom, T z_near, T z_far){
-  return mat<T, 4, 4>(
+  return GEFEC_MATH_TRACE(transform, mat<T, 4, 4>(
     2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
     0.f, 2.f / (top - bottom), 0.f, -(bottom + top) / (top - bottom),
     0.f, 0.f, -2.f / (z_far - z_near), -(z_far - z_near) / (z_far - z_near),
     0.f, 0.f, 0.f, 1.f
-  );
+  ));
 }
 
 //MAX:
@@ -1073,9 +2258,9 @@ inline constexpr auto max(
     const T& b,
     Callable callable
 ) noexcept{
-  return zip(a, b).map([&](const auto& p){
+  return GEFEC_MATH_TRACE(component, zip(a, b).map([&](const auto& p){
     return std::max(p.first, p.second, callable);
-  });
+  }));
 }
 
 template<typename T, typename = detail::not_arithmetic<T>>
@@ -1103,9 +2288,9 @@ inline constexpr auto min(
     const T& b,
     Callable callable
 ) noexcept{
-  return zip(a, b).map([&](const auto& p){
+  return GEFEC_MATH_TRACE(component, zip(a, b).map([&](const auto& p){
     return std::min(p.first, p.second, callable);
-  });
+  }));
 }
 
 template<typename T, typename = detail::not_arithmetic<T>>
@@ -1134,7 +2319,7 @@ inline constexpr auto clamp(
     const T& max,
     Callable callable
 ) noexcept{
-  return math::min(math::max(x, min), max, callable);
+  return GEFEC_MATH_TRACE(component, math::min(math::max(x, min), max, callable));
 }
 
 template<typename T, typename = detail::not_arithmetic<T>>
@@ -1143,7 +2328,7 @@ inline constexpr auto clamp(
     const T& min,
     const T& max
 ) noexcept{
-  return math::min(math::max(x, min), max, std::less<typename T::value_type>{});
+  return GEFEC_MATH_TRACE(component, math::min(math::max(x, min), max, std::less<typename T::value_type>{}));
 }
 
 //ABS:
@@ -1152,11 +2337,13 @@ inline constexpr auto abs(T x) noexcept{
   return std::abs(x);
 }
 
+//The component calls below are unqualified, so overloads for number types
+//declared after this header (fixed point) are found by ADL.
 template<typename T, typename = detail::not_arithmetic<T>>
 inline constexpr auto abs(const T& x) noexcept{
-  return x.map([](const auto& e){
-    return math::abs(e);
-  });
+  return GEFEC_MATH_TRACE(component, x.map([](const auto& e){
+    return abs(e);
+  }));
 }
 
 //ROUND:
@@ -1167,9 +2354,9 @@ inline constexpr auto round(T x) noexcept{
 
 template<typename T, typename = detail::not_arithmetic<T>>
 inline constexpr auto round(const T& x) noexcept{
-  return x.map([](const auto& e){
-    return math::round(e);
-  });
+  return GEFEC_MATH_TRACE(component, x.map([](const auto& e){
+    return round(e);
+  }));
 }
 
 //TRUNC:
@@ -1180,9 +2367,9 @@ inline constexpr auto trunc(T x) noexcept{
 
 template<typename T, typename = detail::not_arithmetic<T>>
 inline constexpr auto trunc(const T& x) noexcept{
-  return x.map([](const auto& e){
-    return math::trunc(e);
-  });
+  return GEFEC_MATH_TRACE(component, x.map([](const auto& e){
+    return trunc(e);
+  }));
 }
 
 //FLOOR:
@@ -1193,9 +2380,9 @@ inline constexpr auto floor(T x) noexcept{
 
 template<typename T, typename = detail::not_arithmetic<T>>
 inline constexpr auto floor(const T& x) noexcept{
-  return x.map([](const auto& e){
-    return math::floor(e);
-  });
+  return GEFEC_MATH_TRACE(component, x.map([](const auto& e){
+    return floor(e);
+  }));
 }
 
 //CEIL:
@@ -1206,11 +2393,186 @@ inline constexpr auto ceil(T x) noexcept{
 
 template<typename T, typename = detail::not_arithmetic<T>>
 inline constexpr auto ceil(const T& x) noexcept{
-  return x.map([](const auto& e){
-    return math::ceil(e);
-  });
+  return GEFEC_MATH_TRACE(component, x.map([](const auto& e){
+    return ceil(e);
+  }));
+}
+
+namespace detail{
+
+inline auto float_bits(float x) noexcept{
+  auto bits = std::uint32_t(0);
+  std::memcpy(&bits, &x, sizeof(x));
+  return bits;
+}
+
+inline auto bits_float(std::uint32_t bits) noexcept{
+  auto x = 0.f;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+inline auto double_bits(double x) noexcept{
+  auto bits = std::uint64_t(0);
+  std::memcpy(&bits, &x, sizeof(x));
+  return bits;
+}
+
+inline auto bits_double(std::uint64_t bits) noexcept{
+  auto x = 0.0;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+} //namespace detail
+
+//Element by element, like abs() and round() above (batch.hpp has the same
+//functions for float arrays, vectorized):
+
+//SIN:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto sin(T x) noexcept{
+  return std::sin(x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto sin(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([](const auto& e){
+    return sin(e);
+  }));
+}
+
+//COS:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto cos(T x) noexcept{
+  return std::cos(x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto cos(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([](const auto& e){
+    return cos(e);
+  }));
+}
+
+//SINCOS:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto sincos(T x) noexcept{
+  return std::pair(std::sin(x), std::cos(x));
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto sincos(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, std::pair(
+    x.map([](const auto& e){ return sin(e); }),
+    x.map([](const auto& e){ return cos(e); })
+  ));
+}
+
+//TAN:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto tan(T x) noexcept{
+  return std::tan(x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto tan(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([](const auto& e){
+    return tan(e);
+  }));
+}
+
+//ATAN2:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto atan2(T y, T x) noexcept{
+  return std::atan2(y, x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto atan2(const T& y, const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, zip(y, x).map([](const auto& p){
+    return atan2(p.first, p.second);
+  }));
+}
+
+//EXP:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto exp(T x) noexcept{
+  return std::exp(x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto exp(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([](const auto& e){
+    return exp(e);
+  }));
+}
+
+//LOG:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto log(T x) noexcept{
+  return std::log(x);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto log(const T& x) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([](const auto& e){
+    return log(e);
+  }));
+}
+
+//POW:
+template<typename T, typename = detail::arithmetic<T>>
+inline auto pow(T x, T y) noexcept{
+  return std::pow(x, y);
+}
+
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto pow(const T& x, const T& y) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, zip(x, y).map([](const auto& p){
+    return pow(p.first, p.second);
+  }));
+}
+
+//Every element to the same power, e.g. pow(color, 2.2f):
+template<typename T, typename = detail::not_arithmetic<T>>
+inline auto pow(const T& x, typename T::value_type y) noexcept{
+  return GEFEC_MATH_TRACE(transcendental, x.map([&](const auto& e){
+    return pow(e, y);
+  }));
+}
+
+namespace detail{
+
+//Finalizer of MurmurHash3, spreads every input bit over the whole word:
+inline constexpr auto hash_mix(std::uint64_t h) noexcept{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+template<typename T>
+inline auto hash_bits(const T& value) noexcept -> std::uint64_t{
+  if constexpr (std::is_integral_v<T>){
+    return static_cast<std::uint64_t>(value);
+  }
+  else if constexpr (std::is_floating_point_v<T> && sizeof(T) <= sizeof(std::uint64_t)){
+    //-0 and 0 compare equal, so they have to hash equal:
+    const auto normalized = value == T(0) ? T(0) : value;
+    auto bits = std::uint64_t(0);
+    std::memcpy(&bits, &normalized, sizeof(T));
+    return bits;
+  }
+  else{
+    return std::hash<T>{}(value);
+  }
 }
 
+} //namespace detail
+
 //For structured binding to work:
 template<std::size_t I, typename T, std::size_t N>
 auto get(const vec<T, N>& vec) noexcept{
@@ -1232,6 +2594,29 @@ const auto&& get(const vec<T, N>&& vec) noexcept{
   return std::move(vec[I]);
 }
 
+//The standard aliases (vec2 ... dmat4, ivec and imat), which math.cpp
+//instantiates once. Defining GEFEC_MATH_EXTERN_TEMPLATES in the other
+//translation units keeps them from instantiating and emitting the members
+//again; the free functions and operators return auto, so they are still
+//instantiated where they are used.
+#define GEFEC_MATH_FOR_EACH_ALIAS(instantiate) \
+  instantiate(float, 2) instantiate(float, 3) instantiate(float, 4) \
+  instantiate(double, 2) instantiate(double, 3) instantiate(double, 4) \
+  instantiate(std::int32_t, 2) instantiate(std::int32_t, 3) instantiate(std::int32_t, 4)
+
+#ifdef GEFEC_MATH_EXTERN_TEMPLATES
+
+#define GEFEC_MATH_EXTERN_TEMPLATE(T, N) \
+  extern template struct vec<T, N>; \
+  extern template struct mat_base<T, N, N, layout::column_major>; \
+  extern template struct mat<T, N, N>;
+
+GEFEC_MATH_FOR_EACH_ALIAS(GEFEC_MATH_EXTERN_TEMPLATE)
+
+#undef GEFEC_MATH_EXTERN_TEMPLATE
+
+#endif
+
 } //namespace gf::math
 
 namespace std{
@@ -1244,13 +2629,27 @@ struct tuple_element<I, gf::math::vec<T, N>>{
   using type = T;
 };
 
+template<typename T, size_t N>
+struct hash<gf::math::vec<T, N>>{
+  auto operator()(const gf::math::vec<T, N>& vec) const noexcept -> size_t{
+    auto h = uint64_t(0x9e3779b97f4a7c15ull ^ N);
+
+    for (auto i : gf::math::range(N)){
+      h = (h ^ gf::math::detail::hash_bits(vec[i])) * 0xff51afd7ed558ccdull;
+      h ^= h >> 32;
+    }
+
+    return static_cast<size_t>(gf::math::detail::hash_mix(h));
+  }
+};
+
 } //namespace std
 
 #ifdef GEFEC_MATH_DEBUG
 
 #include <iostream>
 
-template<typename T, std::size_t N>
+GEFEC_MATH_EXPORT template<typename T, std::size_t N>
 auto operator<<(std::ostream& out, const gf::math::vec<T, N>& vec)
 -> std::ostream&{
   out << "[ ";
@@ -1262,8 +2661,8 @@ auto operator<<(std::ostream& out, const gf::math::vec<T, N>& vec)
   return out << ']';
 }
 
-template<typename T, std::size_t W, std::size_t H>
-auto operator<<(std::ostream& out, const gf::math::mat<T, W, H>& mat)
+GEFEC_MATH_EXPORT template<typename T, std::size_t W, std::size_t H, typename L>
+auto operator<<(std::ostream& out, const gf::math::mat<T, W, H, L>& mat)
 -> std::ostream&{
   for (auto y : gf::math::range(H)){
     for (auto x : gf::math::range(W)){
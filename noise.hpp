@@ -0,0 +1,369 @@
+#pragma once
+
+#include "batch.hpp"
+#include "parallel.hpp"
+#include <array>
+#include <utility>
+
+//Gradient noise over vec<T, 2>, vec<T, 3> and vec<T, 4>: Perlin's (improved)
+//noise and simplex noise, fractal Brownian motion of either, and grids of
+//them evaluated in tiles on several threads with the batch.hpp dispatch.
+//The noise functions have no branches (see the polynomials in batch.hpp) and
+//no loops left after unrolling; they work on std::array rather than vec,
+//whose constructors and operators loop. That is what lets a packet loop over
+//them vectorize.
+
+namespace gf::math{
+
+namespace detail{
+
+//lowbias32 (Chris Wellons): every input bit reaches every output bit, with
+//32 bit multiplies only:
+[[gnu::always_inline]] inline constexpr auto noise_hash(std::uint32_t h) noexcept{
+  h ^= h >> 16;
+  h *= 0x7feb352du;
+  h ^= h >> 15;
+  h *= 0x846ca68bu;
+  h ^= h >> 16;
+  return h;
+}
+
+//A lattice point hashes as noise_hash(seed * NoiseSeed + sum of its
+//coordinates times NoiseAxis), so moving to a neighbour is a single add:
+inline constexpr auto NoiseSeed = std::uint32_t(0x165667b1u);
+inline constexpr std::uint32_t NoiseAxis[4] = { 0x9e3779b1u, 0x85ebca77u, 0xc2b2ae3du, 0x27d4eb2fu };
+
+//floor(x) as an integer, without SSE4.1; |x| < 2^31:
+template<typename T>
+[[gnu::always_inline]] inline auto lattice(T x) noexcept{
+  const auto i = std::int32_t(x);
+  return i - std::int32_t(x < T(i));
+}
+
+//d . g for the gradient g that h picks: every component +-1, then one of
+//them, or none, set to 0. In 2D these are the 8 directions of Perlin's noise,
+//in 3D his 12 cube edges and the 8 corners:
+template<typename T, std::size_t N>
+[[gnu::always_inline]] inline auto gradient_dot(std::uint32_t h, const std::array<T, N>& d) noexcept{
+  const auto zero = ((h >> 24) * std::uint32_t(N + 1)) >> 8;
+  auto result = T(0);
+
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    const auto signed_d = select_bits(((h >> a) & 1) != 0, -d[a], d[a]);
+    result += select_bits(a == zero, T(0), signed_d);
+  }
+
+  return result;
+}
+
+//The corners of the cell with Corner's bits set at axes [A, N), interpolated
+//along axes [0, A); bit a of Corner steps along axis a. d is the offset from
+//the cell's first corner and h that corner's unmixed hash:
+template<std::size_t A, std::size_t Corner, typename T, std::size_t N>
+[[gnu::always_inline]] inline auto perlin_corners(std::uint32_t h, const std::array<T, N>& d, const std::array<T, N>& fade) noexcept -> T{
+  if constexpr (A == 0){
+    auto offset = std::array<T, N>();
+
+    #pragma GCC unroll 4
+    for (auto a : range(N)){
+      offset[a] = ((Corner >> a) & 1) != 0 ? d[a] - T(1) : d[a];
+      h += ((Corner >> a) & 1) != 0 ? NoiseAxis[a] : 0;
+    }
+
+    return gradient_dot(noise_hash(h), offset);
+  }
+  else{
+    const auto near_value = perlin_corners<A - 1, Corner>(h, d, fade);
+    const auto far_value = perlin_corners<A - 1, Corner | (std::size_t(1) << (A - 1))>(h, d, fade);
+    return near_value + fade[A - 1] * (far_value - near_value);
+  }
+}
+
+//A corner contributes at most the 1-norm of its offset (its gradient points
+//the same way), which bounds perlin() by N / 2, at the centre of a cell, and
+//simplex() by the maxima found numerically; the scales take both to 1. The
+//perlin() bound is loose from 3D on: it needs all 2^N corners of a cell to
+//draw the one diagonal gradient pointing at its centre, so typical maxima
+//over many cells are about 0.8 in 3D and 0.65 in 4D. Those keep growing
+//with the area searched, so scaling by them would leave [-1, 1] somewhere.
+//Then the skew (sqrt(N + 1) - 1) / N and unskew (1 - 1 / sqrt(N + 1)) / N of
+//the simplex lattice:
+inline constexpr double PerlinScale[5] = { 0, 0, 1.0, 2.0 / 3, 0.5 };
+inline constexpr double SimplexScale[5] = { 0, 0, 70.0, 62.0, 54.0 };
+inline constexpr double SimplexSkew[5] = { 0, 0, 0.36602540378443865, 1.0 / 3, 0.30901699437494742 };
+inline constexpr double SimplexUnskew[5] = { 0, 0, 0.21132486540518713, 1.0 / 6, 0.13819660112501052 };
+
+template<typename T, std::size_t N>
+inline constexpr auto check_noise() noexcept{
+  static_assert(std::is_floating_point_v<T>, "noise needs floating point coordinates");
+  static_assert(N >= 2 && N <= 4, "noise is 2, 3 or 4 dimensional");
+}
+
+//Corner K of the simplex steps from the cell's corner along the K axes of the
+//highest ranks; h is the hash of the cell's corner, d the offset from it.
+//Functions rather than lambdas, which GCC won't inline into kernel steps:
+template<std::size_t K, typename T, std::size_t N>
+[[gnu::always_inline]] inline auto simplex_corner(std::uint32_t h, const std::array<T, N>& d, const std::array<std::uint32_t, N>& rank) noexcept{
+  constexpr auto Unskew = T(SimplexUnskew[N]);
+
+  auto offset = std::array<T, N>();
+  auto distance = T(0.5);
+
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    const auto step = rank[a] + std::uint32_t(K) >= std::uint32_t(N);
+    h += NoiseAxis[a] & (std::uint32_t(0) - std::uint32_t(step));
+    offset[a] = d[a] - select_bits(step, T(1), T(0)) + T(K) * Unskew;
+    distance -= offset[a] * offset[a];
+  }
+
+  const auto t = select_bits(distance > T(0), distance, T(0));
+  return t * t * t * t * gradient_dot(noise_hash(h), offset);
+}
+
+template<typename T, std::size_t N, std::size_t... K>
+[[gnu::always_inline]] inline auto simplex_corners(
+  std::uint32_t h,
+  const std::array<T, N>& d,
+  const std::array<std::uint32_t, N>& rank,
+  std::index_sequence<K...>
+) noexcept{
+  return (simplex_corner<K>(h, d, rank) + ...);
+}
+
+//The bodies of perlin() and simplex(), inlined into kernel steps:
+template<typename T, std::size_t N>
+[[gnu::always_inline]] inline auto perlin_at(const vec<T, N>& p, std::uint32_t seed) noexcept{
+  check_noise<T, N>();
+
+  auto h = seed * NoiseSeed;
+  auto d = std::array<T, N>();
+  auto fade = std::array<T, N>();
+
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    const auto cell = lattice(p[a]);
+    h += std::uint32_t(cell) * NoiseAxis[a];
+    d[a] = p[a] - T(cell);
+    fade[a] = d[a] * d[a] * d[a] * (d[a] * (d[a] * T(6) - T(15)) + T(10));
+  }
+
+  return T(PerlinScale[N]) * perlin_corners<N, 0>(h, d, fade);
+}
+
+template<typename T, std::size_t N>
+[[gnu::always_inline]] inline auto simplex_at(const vec<T, N>& p, std::uint32_t seed) noexcept{
+  check_noise<T, N>();
+
+  constexpr auto Skew = T(SimplexSkew[N]);
+  constexpr auto Unskew = T(SimplexUnskew[N]);
+
+  auto skew = T(0);
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    skew += p[a];
+  }
+  skew *= Skew;
+
+  auto h = seed * NoiseSeed;
+  auto cell = std::array<T, N>();
+  auto unskew = T(0);
+
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    const auto c = lattice(p[a] + skew);
+    h += std::uint32_t(c) * NoiseAxis[a];
+    cell[a] = T(c);
+    unskew += T(c);
+  }
+
+  unskew *= Unskew;
+
+  auto d = std::array<T, N>();
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    d[a] = p[a] - (cell[a] - unskew);
+  }
+
+  //Ranks of the components, ties broken by axis:
+  auto rank = std::array<std::uint32_t, N>();
+
+  #pragma GCC unroll 4
+  for (auto a : range(N)){
+    #pragma GCC unroll 4
+    for (auto b : range(N)){
+      rank[a] += std::uint32_t(((b < a) & (d[a] >= d[b])) | ((b > a) & (d[a] > d[b])));
+    }
+  }
+
+  return T(SimplexScale[N]) * simplex_corners(h, d, rank, std::make_index_sequence<N + 1>());
+}
+
+} //namespace detail
+
+//Perlin's improved noise: gradients at the integer lattice points, blended
+//with 6t^5 - 15t^4 + 10t^3. Continuous with continuous derivatives, 0 at the
+//lattice points and within [-1, 1], which it fills in 2D; in 3D and 4D values
+//rarely pass 0.8 and 0.65. Every seed is a different noise; p needs
+//|p[i]| < 2^31 and loses detail long before that:
+template<typename T, std::size_t N>
+inline auto perlin(const vec<T, N>& p, std::uint32_t seed = 0) noexcept{
+  return detail::perlin_at(p, seed);
+}
+
+//Simplex noise (Perlin's, in Gustavson's formulation): the sum of radial
+//kernels (1/2 - |d|^2)^4 times gradients over the N + 1 corners of the
+//simplex around p. Cheaper than perlin() from 3 dimensions on, and without
+//its axis aligned artifacts. Within [-1, 1]:
+template<typename T, std::size_t N>
+inline auto simplex(const vec<T, N>& p, std::uint32_t seed = 0) noexcept{
+  return detail::simplex_at(p, seed);
+}
+
+//perlin() and simplex() as function objects, for fbm() and noise_grid():
+struct perlin_noise{
+  template<typename T, std::size_t N>
+  [[gnu::always_inline]] inline auto operator()(const vec<T, N>& p, std::uint32_t seed = 0) const noexcept{
+    return detail::perlin_at(p, seed);
+  }
+};
+
+struct simplex_noise{
+  template<typename T, std::size_t N>
+  [[gnu::always_inline]] inline auto operator()(const vec<T, N>& p, std::uint32_t seed = 0) const noexcept{
+    return detail::simplex_at(p, seed);
+  }
+};
+
+template<typename T>
+struct fbm_settings{
+  std::size_t octaves = 6;
+  T lacunarity = T(2); //frequency of each octave over that of the one before
+  T gain = T(0.5); //amplitude of each octave over that of the one before
+  std::uint32_t seed = 0; //octave i uses seed + i, so that octaves don't line up
+};
+
+namespace detail{
+
+//The amplitude of the first octave, which makes them all sum to 1:
+template<typename T>
+inline auto first_amplitude(const fbm_settings<T>& settings) noexcept{
+  auto total = T(0);
+  auto amplitude = T(1);
+
+  for (auto i = std::size_t(0); i < settings.octaves; ++i){
+    total += amplitude;
+    amplitude *= settings.gain;
+  }
+
+  return T(1) / total;
+}
+
+} //namespace detail
+
+//Fractal Brownian motion: the sum of octaves of noise(p * frequency, seed),
+//with the amplitudes scaled to sum to 1, so the result keeps the range of the
+//noise. noise is called like perlin() and simplex():
+template<typename Noise, typename T, std::size_t N>
+inline auto fbm(Noise noise, const vec<T, N>& p, const fbm_settings<T>& settings = {}) noexcept{
+  auto result = T(0);
+  auto frequency = T(1);
+  auto amplitude = detail::first_amplitude(settings);
+
+  for (auto octave : range(settings.octaves)){
+    result += amplitude * noise(p * frequency, settings.seed + std::uint32_t(octave));
+    frequency *= settings.lacunarity;
+    amplitude *= settings.gain;
+  }
+
+  return result;
+}
+
+namespace detail{
+
+//One octave over a row of a tile: result[i] += amplitude * noise of
+//(origin + (x + i, y, 0...) * spacing) * frequency, the position fbm() is
+//given for that sample:
+template<typename Noise, std::size_t N>
+struct noise_row_kernel{
+  Noise noise;
+  std::array<float, N> origin;
+  float spacing;
+  float frequency;
+  float amplitude;
+  std::int32_t x;
+  float y;
+  std::uint32_t seed;
+
+  [[gnu::always_inline]] inline auto step(std::size_t i, float* result) const noexcept{
+    result[i] += amplitude * noise(position(i, std::make_index_sequence<N>()), seed);
+  }
+
+  //Built component by component, vec's loops would stay in the step:
+  template<std::size_t... A>
+  [[gnu::always_inline]] inline auto position(std::size_t i, std::index_sequence<A...>) const noexcept{
+    const auto sample_x = origin[0] + float(x + std::int32_t(i)) * spacing;
+    const auto sample_y = origin[1] + y * spacing;
+    return vec<float, N>((A == 0 ? sample_x : A == 1 ? sample_y : origin[A]) * frequency...);
+  }
+};
+
+} //namespace detail
+
+//result[y * width + x] = fbm(noise, origin + (x, y, 0...) * spacing, settings),
+//a grid over the first two axes of origin (3 and 4 dimensional noise is
+//sliced). Tiles of TileSize x TileSize samples are split between the threads
+//and every row of a tile is a batch.hpp kernel, one pass per octave; noise
+//has to be branch-free to vectorize, like perlin_noise and simplex_noise
+//(except 4 dimensional perlin_noise, too large for GCC to inline whole).
+//The default settings are a single octave, the plain noise:
+template<typename Noise, std::size_t N>
+inline auto noise_grid(
+  Noise noise,
+  const vec<float, N>& origin,
+  float spacing,
+  std::size_t width,
+  std::size_t height,
+  float* result,
+  const fbm_settings<float>& settings = { 1 },
+  std::size_t threads = hardware_threads()
+){
+  constexpr auto TileSize = std::size_t(64);
+
+  const auto columns = (width + TileSize - 1) / TileSize;
+  const auto rows = (height + TileSize - 1) / TileSize;
+
+  auto corner = std::array<float, N>();
+
+  for (auto a : range(N)){
+    corner[a] = origin[a];
+  }
+
+  parallel_for(columns * rows, [&](std::size_t begin, std::size_t end){
+    for (auto tile : range(begin, end)){
+      const auto x0 = tile % columns * TileSize;
+      const auto y0 = tile / columns * TileSize;
+      const auto count = std::min(TileSize, width - x0);
+
+      for (auto y : range(y0, std::min(y0 + TileSize, height))){
+        auto* row = result + y * width + x0;
+        std::fill(row, row + count, 0.f);
+
+        auto kernel = detail::noise_row_kernel<Noise, N>{
+          noise, corner, spacing, 1.f, detail::first_amplitude(settings), std::int32_t(x0), float(y), settings.seed
+        };
+
+        for (auto octave : range(settings.octaves)){
+          detail::dispatch(kernel, count, row);
+
+          kernel.frequency *= settings.lacunarity;
+          kernel.amplitude *= settings.gain;
+          kernel.seed = settings.seed + std::uint32_t(octave + 1);
+        }
+      }
+    }
+  }, threads);
+}
+
+} //namespace gf::math
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "binary.hpp"
+#include "parallel.hpp"
+#include "text.hpp"
+#include <array>
+
+namespace gf::math{
+
+//Indexed triangle mesh, every attribute has its own index buffer with 3 indices per triangle:
+struct mesh{
+  std::vector<vec3> positions;
+  std::vector<vec3> normals;
+  std::vector<std::uint32_t> indices;
+
+  //Empty unless every face corner has a normal:
+  std::vector<std::uint32_t> normal_indices;
+
+  auto triangle_count() const noexcept{
+    return indices.size() / 3;
+  }
+
+  auto triangle(std::size_t i) const noexcept{
+    return std::array{
+      positions[indices[i * 3]],
+      positions[indices[i * 3 + 1]],
+      positions[indices[i * 3 + 2]]
+    };
+  }
+};
+
+namespace detail{
+
+//Part of an OBJ file parsed on its own. Negative (relative) indices depend on
+//the vertices of previous chunks, so the slots holding them are recorded and
+//fixed up when the chunks are merged. The ones reaching before the chunk hold
+//their distance back from its start until then.
+struct obj_chunk{
+  std::vector<vec3> positions;
+  std::vector<vec3> normals;
+  std::vector<std::uint32_t> indices;
+  std::vector<std::uint32_t> normal_indices;
+  std::vector<std::size_t> relative_indices;
+  std::vector<std::size_t> relative_normal_indices;
+  std::vector<std::size_t> previous_indices;
+  std::vector<std::size_t> previous_normal_indices;
+  bool every_normal = true;
+  bool failed = false;
+};
+
+//What an index counts from:
+enum class obj_origin : std::uint8_t{ file, chunk, previous_chunks };
+
+struct obj_corner{
+  std::uint32_t position;
+  std::uint32_t normal;
+  obj_origin position_origin;
+  obj_origin normal_origin;
+  bool has_normal;
+};
+
+inline auto is_obj_space(char c) noexcept{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline auto skip_obj_spaces(const char* first, const char* last) noexcept{
+  while (first != last && is_obj_space(*first)) ++first;
+  return first;
+}
+
+//1 based or negative index into an array with count elements so far:
+inline auto parse_obj_index(
+  const char*& first,
+  const char* last,
+  std::size_t count,
+  std::uint32_t& index,
+  obj_origin& origin
+) noexcept{
+  auto value = std::int64_t(0);
+  const auto result = std::from_chars(first, last, value);
+  if (result.ec != std::errc() || value == 0) return false;
+
+  first = result.ptr;
+
+  //Checked before narrowing, an index past 32 bits would alias a valid one. No
+  //mesh has InvalidIndex elements, so neither is any index or distance back:
+  const auto local = value < 0 ? std::int64_t(count) + value : value - 1;
+  if (local >= std::int64_t(InvalidIndex) || -local >= std::int64_t(InvalidIndex)) return false;
+
+  origin = value > 0 ? obj_origin::file : local >= 0 ? obj_origin::chunk : obj_origin::previous_chunks;
+  index = static_cast<std::uint32_t>(local < 0 ? -local : local);
+  return true;
+}
+
+//Corners are "v", "v/vt", "v//vn" or "v/vt/vn", texture coordinates are skipped:
+inline auto parse_obj_face(
+  const char* first,
+  const char* last,
+  obj_chunk& chunk,
+  std::vector<obj_corner>& corners
+){
+  corners.clear();
+
+  while (true){
+    first = skip_obj_spaces(first, last);
+    if (first == last || *first == '#') break;
+
+    auto corner = obj_corner{ InvalidIndex, InvalidIndex, obj_origin::file, obj_origin::file, false };
+    if (!parse_obj_index(first, last, chunk.positions.size(), corner.position, corner.position_origin)){
+      return false;
+    }
+
+    if (first != last && *first == '/'){
+      ++first;
+
+      auto texcoord = std::int64_t(0);
+      if (first != last && *first != '/') first = std::from_chars(first, last, texcoord).ptr;
+
+      if (first != last && *first == '/'){
+        ++first;
+
+        if (!parse_obj_index(first, last, chunk.normals.size(), corner.normal, corner.normal_origin)){
+          return false;
+        }
+
+        corner.has_normal = true;
+      }
+    }
+
+    if (first != last && !is_obj_space(*first)) return false;
+    corners.push_back(corner);
+  }
+
+  if (corners.size() < 3) return false;
+
+  const auto push = [&](const obj_corner& corner){
+    if (corner.position_origin == obj_origin::chunk) chunk.relative_indices.push_back(chunk.indices.size());
+    if (corner.position_origin == obj_origin::previous_chunks) chunk.previous_indices.push_back(chunk.indices.size());
+    if (corner.normal_origin == obj_origin::chunk) chunk.relative_normal_indices.push_back(chunk.normal_indices.size());
+    if (corner.normal_origin == obj_origin::previous_chunks) chunk.previous_normal_indices.push_back(chunk.normal_indices.size());
+
+    chunk.indices.push_back(corner.position);
+    chunk.normal_indices.push_back(corner.normal);
+    chunk.every_normal = chunk.every_normal && corner.has_normal;
+  };
+
+  //Polygons are split into a fan of triangles:
+  for (auto i : range(std::size_t(1), corners.size() - 1)){
+    push(corners[0]);
+    push(corners[i]);
+    push(corners[i + 1]);
+  }
+
+  return true;
+}
+
+inline auto parse_obj_chunk(const char* first, const char* last, obj_chunk& chunk){
+  auto corners = std::vector<obj_corner>();
+
+  while (first != last && !chunk.failed){
+    const auto* line_end = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    if (line_end == nullptr) line_end = last;
+
+    const auto* line = skip_obj_spaces(first, line_end);
+    const auto remaining = line_end - line;
+
+    const auto keyword = [&](const char* word, std::ptrdiff_t length){
+      return
+        remaining > length &&
+        std::memcmp(line, word, length) == 0 &&
+        is_obj_space(line[length]);
+    };
+
+    if (keyword("v", 1) || keyword("vn", 2)){
+      auto& target = line[1] == 'n' ? chunk.normals : chunk.positions;
+      auto v = vec3();
+
+      //Extra components (w, vertex colors) are ignored:
+      if (math::from_chars(line + 2, line_end, v).ec == std::errc()) target.push_back(v);
+      else chunk.failed = true;
+    }
+    else if (keyword("f", 1)){
+      chunk.failed = !parse_obj_face(line + 2, line_end, chunk, corners);
+    }
+
+    //Comments, texture coordinates, groups, materials... are skipped.
+    first = line_end == last ? last : line_end + 1;
+  }
+}
+
+} //namespace detail
+
+//Parses Wavefront OBJ text: positions, normals and faces (triangulated).
+//The text is split at line boundaries into chunks parsed in parallel.
+//Returns false for malformed files and indices out of range.
+inline auto parse_obj(
+  const char* first,
+  const char* last,
+  mesh& result,
+  std::size_t threads = hardware_threads()
+){
+  result = mesh();
+
+  //A few chunks per thread, small files are parsed on the calling thread:
+  constexpr auto MinChunkSize = std::size_t(1) << 16;
+  const auto size = static_cast<std::size_t>(last - first);
+  const auto chunk_count = math::max<std::size_t>(1, math::min(threads * 4, size / MinChunkSize));
+
+  auto bounds = std::vector<const char*>{ first };
+
+  for (auto i : range(std::size_t(1), chunk_count)){
+    const auto* split = std::max(first + size * i / chunk_count, bounds.back());
+    const auto* line_end = static_cast<const char*>(std::memchr(split, '\n', last - split));
+    bounds.push_back(line_end == nullptr ? last : line_end + 1);
+  }
+
+  bounds.push_back(last);
+
+  auto chunks = std::vector<detail::obj_chunk>(chunk_count);
+
+  parallel_for(chunk_count, [&](std::size_t begin, std::size_t end){
+    for (auto i : range(begin, end)){
+      detail::parse_obj_chunk(bounds[i], bounds[i + 1], chunks[i]);
+    }
+  }, threads);
+
+  //Where every chunk goes in the merged arrays:
+  struct offsets{ std::size_t positions, normals, indices; };
+  auto starts = std::vector<offsets>(chunk_count + 1, offsets{ 0, 0, 0 });
+  auto every_normal = true;
+
+  for (auto i : range(chunk_count)){
+    if (chunks[i].failed) return false;
+
+    starts[i + 1] = offsets{
+      starts[i].positions + chunks[i].positions.size(),
+      starts[i].normals + chunks[i].normals.size(),
+      starts[i].indices + chunks[i].indices.size()
+    };
+
+    every_normal = every_normal && chunks[i].every_normal;
+  }
+
+  const auto totals = starts.back();
+  if (totals.positions >= InvalidIndex || totals.normals >= InvalidIndex) return false;
+
+  result.positions.resize(totals.positions);
+  result.normals.resize(totals.normals);
+  result.indices.resize(totals.indices);
+  if (every_normal) result.normal_indices.resize(totals.indices);
+
+  auto out_of_range = std::vector<char>(chunk_count, 0);
+
+  parallel_for(chunk_count, [&](std::size_t begin, std::size_t end){
+    for (auto i : range(begin, end)){
+      auto& chunk = chunks[i];
+      const auto start = starts[i];
+
+      for (auto slot : chunk.relative_indices){
+        chunk.indices[slot] += static_cast<std::uint32_t>(start.positions);
+      }
+
+      for (auto slot : chunk.relative_normal_indices){
+        chunk.normal_indices[slot] += static_cast<std::uint32_t>(start.normals);
+      }
+
+      for (auto slot : chunk.previous_indices){
+        const auto distance = std::size_t(chunk.indices[slot]);
+        out_of_range[i] |= distance > start.positions;
+        chunk.indices[slot] = static_cast<std::uint32_t>(start.positions - distance);
+      }
+
+      for (auto slot : chunk.previous_normal_indices){
+        const auto distance = std::size_t(chunk.normal_indices[slot]);
+        out_of_range[i] |= every_normal && distance > start.normals;
+        chunk.normal_indices[slot] = static_cast<std::uint32_t>(start.normals - distance);
+      }
+
+      for (auto index : chunk.indices){
+        out_of_range[i] |= index >= totals.positions;
+      }
+
+      std::copy(chunk.positions.begin(), chunk.positions.end(), result.positions.begin() + start.positions);
+      std::copy(chunk.normals.begin(), chunk.normals.end(), result.normals.begin() + start.normals);
+      std::copy(chunk.indices.begin(), chunk.indices.end(), result.indices.begin() + start.indices);
+
+      if (every_normal){
+        for (auto index : chunk.normal_indices){
+          out_of_range[i] |= index >= totals.normals;
+        }
+
+        std::copy(
+          chunk.normal_indices.begin(),
+          chunk.normal_indices.end(),
+          result.normal_indices.begin() + start.indices
+        );
+      }
+    }
+  }, threads);
+
+  for (auto failed : out_of_range){
+    if (failed){
+      result = mesh();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+inline auto parse_obj(std::string_view text, mesh& result, std::size_t threads = hardware_threads()){
+  return parse_obj(text.data(), text.data() + text.size(), result, threads);
+}
+
+//Maps the file instead of reading it into memory:
+inline auto load_obj(const char* path, mesh& result, std::size_t threads = hardware_threads()){
+  const auto file = mapped_file(path);
+
+  if (!file){
+    result = mesh();
+    return false;
+  }
+
+  return parse_obj(file.data(), file.data() + file.size(), result, threads);
+}
+
+} //namespace gf::math
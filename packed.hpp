@@ -0,0 +1,288 @@
+#pragma once
+
+#include "math.hpp"
+#include <limits>
+#include <vector>
+
+namespace gf::math{
+
+namespace detail{
+
+//Round to nearest even. Every case is computed and then selected, so the
+//bulk conversions below have no branches in their loops.
+inline auto float_to_half(float value) noexcept{
+  constexpr auto F32Infinity = std::uint32_t(255) << 23;
+  constexpr auto F16Overflow = std::uint32_t(127 + 16) << 23;
+  constexpr auto F16Normal = std::uint32_t(127 - 14) << 23;
+  constexpr auto DenormMagic = std::uint32_t((127 - 15) + (23 - 10) + 1) << 23;
+
+  auto f = float_bits(value);
+  const auto sign = f & 0x80000000u;
+  f ^= sign;
+
+  //Too large, infinity or NaN:
+  const auto special = f > F32Infinity ? std::uint32_t(0x7e00) : std::uint32_t(0x7c00);
+
+  //Subnormal halves, the float addition does the rounding:
+  const auto subnormal = float_bits(bits_float(f) + bits_float(DenormMagic)) - DenormMagic;
+
+  //Normal halves, rebias the exponent and round the mantissa:
+  const auto odd = (f >> 13) & 1;
+  const auto normal = (f + (std::uint32_t(15 - 127) << 23) + 0xfff + odd) >> 13;
+
+  const auto result = f >= F16Overflow ? special : f < F16Normal ? subnormal : normal;
+  return static_cast<std::uint16_t>(result | (sign >> 16));
+}
+
+inline auto half_to_float(std::uint16_t half) noexcept{
+  constexpr auto ShiftedExponent = std::uint32_t(0x7c00) << 13;
+  constexpr auto Magic = std::uint32_t(113) << 23;
+
+  const auto shifted = (std::uint32_t(half) & 0x7fff) << 13;
+  const auto exponent = shifted & ShiftedExponent;
+  const auto rebiased = shifted + (std::uint32_t(127 - 15) << 23);
+
+  const auto special = rebiased + (std::uint32_t(128 - 16) << 23);
+  const auto subnormal = float_bits(bits_float(rebiased + (1u << 23)) - bits_float(Magic));
+
+  const auto result =
+    exponent == ShiftedExponent ? special :
+    exponent == 0 ? subnormal :
+    rebiased;
+
+  return bits_float(result | ((std::uint32_t(half) & 0x8000) << 16));
+}
+
+} //namespace detail
+
+//IEEE 754 binary16. Converts implicitly from and to float, so arithmetic
+//on halves (and on vec<half, N>) is done in float.
+struct half{
+  std::uint16_t bits;
+
+  half() = default;
+  half(float value) noexcept : bits(detail::float_to_half(value)) {}
+
+  static constexpr auto from_bits(std::uint16_t bits) noexcept{
+    auto result = half();
+    result.bits = bits;
+    return result;
+  }
+
+  operator float() const noexcept{
+    return detail::half_to_float(bits);
+  }
+};
+
+//Fixed point in [0, 1], stored in an unsigned integer:
+template<typename Int>
+struct unorm{
+  static_assert(std::is_unsigned_v<Int>, "unorm is stored in an unsigned integer");
+  static constexpr auto Max = float(std::numeric_limits<Int>::max());
+
+  Int bits;
+
+  unorm() = default;
+
+  constexpr unorm(float value) noexcept
+  : bits(static_cast<Int>(math::clamp(value, 0.f, 1.f) * Max + 0.5f)) {}
+
+  constexpr operator float() const noexcept{
+    return bits / Max;
+  }
+};
+
+//Fixed point in [-1, 1], stored in a signed integer. The lowest value maps to -1 as well.
+template<typename Int>
+struct snorm{
+  static_assert(std::is_signed_v<Int>, "snorm is stored in a signed integer");
+  static constexpr auto Max = float(std::numeric_limits<Int>::max());
+
+  Int bits;
+
+  snorm() = default;
+
+  snorm(float value) noexcept
+  : bits(static_cast<Int>(std::round(math::clamp(value, -1.f, 1.f) * Max))) {}
+
+  constexpr operator float() const noexcept{
+    return math::max(bits / Max, -1.f);
+  }
+};
+
+using unorm8 = unorm<std::uint8_t>;
+using unorm16 = unorm<std::uint16_t>;
+using snorm8 = snorm<std::int8_t>;
+using snorm16 = snorm<std::int16_t>;
+
+using hvec2 = vec<half, 2>;
+using hvec3 = vec<half, 3>;
+using hvec4 = vec<half, 4>;
+
+namespace detail{
+
+//dot(), len() and the other sums over halves accumulate in float:
+template<> struct accumulated<half>{ using type = float; };
+template<> struct wider<half>{ using type = float; };
+
+} //namespace detail
+
+//Arithmetic on vec<half, N>, with each other, with float vectors and with
+//float scalars, is done in float and gives vec<float, N>, like arithmetic on
+//single halves:
+template<std::size_t N>
+inline auto to_float(const vec<half, N>& v) noexcept{
+  return vec<float, N>(v);
+}
+
+#define GEFEC_MATH_HALF_OPERATOR(op)                                                \
+  template<std::size_t N>                                                           \
+  inline auto operator op(const vec<half, N>& a, const vec<half, N>& b) noexcept{   \
+    return to_float(a) op to_float(b);                                              \
+  }                                                                                 \
+  template<std::size_t N>                                                           \
+  inline auto operator op(const vec<half, N>& a, const vec<float, N>& b) noexcept{  \
+    return to_float(a) op b;                                                        \
+  }                                                                                 \
+  template<std::size_t N>                                                           \
+  inline auto operator op(const vec<float, N>& a, const vec<half, N>& b) noexcept{  \
+    return a op to_float(b);                                                        \
+  }                                                                                 \
+  template<std::size_t N>                                                           \
+  inline auto operator op(const vec<half, N>& a, float b) noexcept{                 \
+    return to_float(a) op b;                                                        \
+  }                                                                                 \
+  template<std::size_t N>                                                           \
+  inline auto operator op(float a, const vec<half, N>& b) noexcept{                 \
+    return a op to_float(b);                                                        \
+  }
+
+GEFEC_MATH_HALF_OPERATOR(+)
+GEFEC_MATH_HALF_OPERATOR(-)
+GEFEC_MATH_HALF_OPERATOR(*)
+GEFEC_MATH_HALF_OPERATOR(/)
+
+#undef GEFEC_MATH_HALF_OPERATOR
+
+//Four unorm components in 32 bits: 10 for x, y, z and 2 for w, x in the low bits.
+struct rgb10a2{
+  std::uint32_t bits;
+
+  rgb10a2() = default;
+
+  explicit rgb10a2(const vec4& v) noexcept : bits(0){
+    constexpr float Max[] = { 1023.f, 1023.f, 1023.f, 3.f };
+    constexpr std::uint32_t Shift[] = { 0, 10, 20, 30 };
+
+    for (auto i : range(4)){
+      const auto component = static_cast<std::uint32_t>(math::clamp(v[i], 0.f, 1.f) * Max[i] + 0.5f);
+      bits |= component << Shift[i];
+    }
+  }
+
+  auto unpack() const noexcept{
+    return vec4(
+      float(bits & 0x3ff) / 1023.f,
+      float((bits >> 10) & 0x3ff) / 1023.f,
+      float((bits >> 20) & 0x3ff) / 1023.f,
+      float(bits >> 30) / 3.f
+    );
+  }
+};
+
+//Octahedral mapping of a unit vector onto [-1, 1]^2, two components are
+//enough to store normals (e.g. as vec<snorm16, 2>).
+inline auto oct_encode(const vec3& n) noexcept{
+  const auto sign_x = n.x >= 0.f ? 1.f : -1.f;
+  const auto sign_y = n.y >= 0.f ? 1.f : -1.f;
+
+  const auto inv_l1 = 1.f / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+  const auto x = n.x * inv_l1;
+  const auto y = n.y * inv_l1;
+
+  //The lower hemisphere is folded over the diagonals:
+  return n.z >= 0.f
+    ? vec2(x, y)
+    : vec2((1.f - std::abs(y)) * sign_x, (1.f - std::abs(x)) * sign_y);
+}
+
+inline auto oct_decode(const vec2& e) noexcept{
+  auto n = vec3(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+  const auto t = math::max(-n.z, 0.f);
+
+  n.x += n.x >= 0.f ? -t : t;
+  n.y += n.y >= 0.f ? -t : t;
+
+  const auto inv_len = 1.f / std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+  return vec3(n.x * inv_len, n.y * inv_len, n.z * inv_len);
+}
+
+//Bulk conversions of vertex streams, P is half, unorm or snorm:
+template<typename P, std::size_t N>
+inline auto pack(const std::vector<vec<float, N>>& values){
+  auto result = std::vector<vec<P, N>>(values.size());
+
+  for (auto i : range(values.size())){
+    for (auto n : range(N)){
+      result[i][n] = P(values[i][n]);
+    }
+  }
+
+  return result;
+}
+
+template<typename P, std::size_t N>
+inline auto unpack(const std::vector<vec<P, N>>& values){
+  auto result = std::vector<vec<float, N>>(values.size());
+
+  for (auto i : range(values.size())){
+    for (auto n : range(N)){
+      result[i][n] = float(values[i][n]);
+    }
+  }
+
+  return result;
+}
+
+inline auto pack_rgb10a2(const std::vector<vec4>& values){
+  auto result = std::vector<rgb10a2>(values.size());
+
+  for (auto i : range(values.size())){
+    result[i] = rgb10a2(values[i]);
+  }
+
+  return result;
+}
+
+inline auto unpack(const std::vector<rgb10a2>& values){
+  auto result = std::vector<vec4>(values.size());
+
+  for (auto i : range(values.size())){
+    result[i] = values[i].unpack();
+  }
+
+  return result;
+}
+
+inline auto pack_normals(const std::vector<vec3>& normals){
+  auto result = std::vector<vec<snorm16, 2>>(normals.size());
+
+  for (auto i : range(normals.size())){
+    const auto e = oct_encode(normals[i]);
+    result[i] = vec<snorm16, 2>(snorm16(e.x), snorm16(e.y));
+  }
+
+  return result;
+}
+
+inline auto unpack_normals(const std::vector<vec<snorm16, 2>>& packed){
+  auto result = std::vector<vec3>(packed.size());
+
+  for (auto i : range(packed.size())){
+    result[i] = oct_decode(vec2(float(packed[i].x), float(packed[i].y)));
+  }
+
+  return result;
+}
+
+} //namespace gf::math
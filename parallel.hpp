@@ -0,0 +1,44 @@
+#pragma once
+
+#include "math.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace gf::math{
+
+inline auto hardware_threads() noexcept -> std::size_t{
+  const auto threads = std::thread::hardware_concurrency();
+  return threads == 0 ? 1 : threads;
+}
+
+//Splits [0, count) into contiguous chunks and calls callable(begin, end) for
+//each of them, one chunk per thread. The last chunk runs on the calling thread.
+template<typename Callable>
+inline auto parallel_for(
+  std::size_t count,
+  Callable callable,
+  std::size_t threads = hardware_threads()
+){
+  threads = std::max<std::size_t>(1, std::min(threads, count));
+
+  if (threads == 1){
+    if (count != 0) callable(std::size_t(0), count);
+    return;
+  }
+
+  const auto chunk = (count + threads - 1) / threads;
+  auto workers = std::vector<std::thread>();
+
+  for (auto begin = std::size_t(0); begin + chunk < count; begin += chunk){
+    workers.emplace_back(callable, begin, begin + chunk);
+  }
+
+  callable(workers.size() * chunk, count);
+
+  for (auto& worker : workers){
+    worker.join();
+  }
+}
+
+} //namespace gf::math
@@ -0,0 +1,492 @@
+#pragma once
+
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace gf::math{
+
+//One entry of a matrix being assembled. Entries with the same row and column
+//are summed, as in finite element assembly:
+template<typename Block>
+struct sparse_triplet{
+  std::uint32_t row;
+  std::uint32_t column;
+  Block value;
+};
+
+namespace detail{
+
+//Scalar and vector types of a sparse matrix with Block entries. Scalars
+//give plain CSR, mat<T, B, B> blocks give block CSR over vec<T, B>:
+template<typename Block>
+struct sparse_block{
+  using scalar_type = Block;
+  using vector_type = Block;
+
+  static constexpr auto Size = std::size_t(1);
+};
+
+template<typename T, std::size_t B, typename L>
+struct sparse_block<mat<T, B, B, L>>{
+  using scalar_type = T;
+  using vector_type = vec<T, B>;
+
+  static constexpr auto Size = B;
+};
+
+template<typename T>
+inline constexpr auto multiply_add(T a, T x, T& y) noexcept{
+  y += a * x;
+}
+
+//Calls f(0) ... f(N - 1) unrolled; -O2 doesn't peel the loops of small blocks:
+template<std::size_t... I, typename Callable>
+inline constexpr auto unrolled(std::index_sequence<I...>, Callable f) noexcept{
+  (f(I), ...);
+}
+
+//y += a * x without going through mat * vec, walking a in storage order:
+template<typename T, std::size_t B, typename L>
+inline constexpr auto multiply_add(const mat<T, B, B, L>& a, const vec<T, B>& x, vec<T, B>& y) noexcept{
+  constexpr auto Indices = std::make_index_sequence<B>();
+
+  if constexpr (std::is_same_v<L, layout::row_major>){
+    unrolled(Indices, [&](std::size_t r){
+      unrolled(Indices, [&](std::size_t c){ y[r] += a.at(c, r) * x[c]; });
+    });
+  }
+  else{
+    unrolled(Indices, [&](std::size_t c){
+      unrolled(Indices, [&](std::size_t r){ y[r] += a.at(c, r) * x[c]; });
+    });
+  }
+}
+
+//Vector elements are scalars for CSR and vec<T, B> for block CSR. The
+//operations of the solver go through their components, unrolled, instead of
+//the vec operators, which -O2 leaves as loops:
+template<typename V>
+inline constexpr auto Components = std::size_t(1);
+
+template<typename T, std::size_t N>
+inline constexpr auto Components<vec<T, N>> = N;
+
+template<typename T>
+inline constexpr auto& component(T& v, std::size_t) noexcept{
+  return v;
+}
+
+template<typename T, std::size_t N>
+inline constexpr auto& component(vec<T, N>& v, std::size_t k) noexcept{
+  return v[k];
+}
+
+template<typename T, std::size_t N>
+inline constexpr const auto& component(const vec<T, N>& v, std::size_t k) noexcept{
+  return v[k];
+}
+
+template<typename V, typename Callable>
+inline constexpr auto each_component(Callable f) noexcept{
+  unrolled(std::make_index_sequence<Components<V>>(), f);
+}
+
+template<typename V>
+inline constexpr auto sparse_dot(const V& a, const V& b) noexcept{
+  auto result = std::decay_t<decltype(component(a, 0))>(0);
+  each_component<V>([&](std::size_t k){ result += component(a, k) * component(b, k); });
+  return result;
+}
+
+//y += alpha * x:
+template<typename T, typename V>
+inline constexpr auto axpy(T alpha, const V& x, V& y) noexcept{
+  each_component<V>([&](std::size_t k){ component(y, k) += alpha * component(x, k); });
+}
+
+//Inverse for the Jacobi preconditioner; singular entries give the identity,
+//leaving those rows unpreconditioned:
+template<typename T>
+inline auto invert_or_identity(T a) noexcept{
+  return a != T(0) ? T(1) / a : T(1);
+}
+
+//Gauss-Jordan elimination with partial pivoting:
+template<typename T, std::size_t B, typename L>
+inline auto invert_or_identity(const mat<T, B, B, L>& a) noexcept{
+  auto m = mat<T, B, B, L>(a);
+  auto result = mat<T, B, B, L>(T(1));
+
+  for (auto c : range(B)){
+    auto pivot = c;
+
+    for (auto r : range(c + 1, B)){
+      if (std::abs(m.at(c, r)) > std::abs(m.at(c, pivot))) pivot = r;
+    }
+
+    if (m.at(c, pivot) == T(0)) return mat<T, B, B, L>(T(1));
+
+    for (auto x : range(B)){
+      std::swap(m.at(x, c), m.at(x, pivot));
+      std::swap(result.at(x, c), result.at(x, pivot));
+    }
+
+    const auto scale = T(1) / m.at(c, c);
+
+    for (auto x : range(B)){
+      m.at(x, c) *= scale;
+      result.at(x, c) *= scale;
+    }
+
+    for (auto r : range(B)){
+      if (r == c) continue;
+
+      const auto factor = m.at(c, r);
+
+      for (auto x : range(B)){
+        m.at(x, r) -= factor * m.at(x, c);
+        result.at(x, r) -= factor * result.at(x, c);
+      }
+    }
+  }
+
+  return result;
+}
+
+//Threads for a pass over count rows; small passes are not worth a thread:
+inline auto sparse_threads(std::size_t count, std::size_t threads) noexcept{
+  constexpr auto RowsPerThread = std::size_t(4096);
+  return std::max<std::size_t>(1, std::min(threads, count / RowsPerThread));
+}
+
+//Calls callable(begin, end) over [0, count) in parallel and sums the results.
+//The rows are split into one part per thread up front, so the summation
+//order, and with it the result, only depends on the thread count:
+template<typename T, typename Callable>
+inline auto parallel_sum(std::size_t count, Callable callable, std::size_t threads){
+  const auto parts = sparse_threads(count, threads);
+  auto partial = std::vector<T>(parts);
+
+  parallel_for(parts, [&](std::size_t begin, std::size_t end){
+    for (auto part : range(begin, end)){
+      partial[part] = callable(count * part / parts, count * (part + 1) / parts);
+    }
+  }, parts);
+
+  auto result = T();
+
+  for (auto p : partial){
+    result += p;
+  }
+
+  return result;
+}
+
+} //namespace detail
+
+//Compressed sparse row matrix. With mat<T, B, B> blocks this is block CSR
+//(BSR): indices address B x B blocks and vectors are arrays of vec<T, B>,
+//the natural layout for 3D finite elements and cloth.
+template<typename Block>
+struct sparse_matrix{
+  using block_type = Block;
+  using scalar_type = typename detail::sparse_block<Block>::scalar_type;
+  using vector_type = typename detail::sparse_block<Block>::vector_type;
+
+  static constexpr auto BlockSize = detail::sparse_block<Block>::Size;
+
+  std::size_t rows = 0;
+  std::size_t columns = 0;
+
+  std::vector<std::uint32_t> row_offsets = { 0 }; //rows + 1 offsets into column_indices and values
+  std::vector<std::uint32_t> column_indices; //sorted within each row
+  std::vector<Block> values;
+
+  sparse_matrix() = default;
+
+  //Assembles from triplets in any order, summing duplicates. Rows and columns count blocks.
+  //A triplet outside the matrix rejects the input and leaves an empty 0 x 0 matrix:
+  sparse_matrix(std::size_t rows, std::size_t columns, const std::vector<sparse_triplet<Block>>& triplets)
+  : rows(rows), columns(columns), row_offsets(rows + 1, 0){
+    for (const auto& t : triplets){
+      if (t.row >= rows || t.column >= columns){
+        *this = sparse_matrix();
+        return;
+      }
+    }
+
+    //Counting sort by row, then sort and merge the columns of every row:
+    for (const auto& t : triplets){
+      ++row_offsets[t.row + 1];
+    }
+
+    for (auto r : range(rows)){
+      row_offsets[r + 1] += row_offsets[r];
+    }
+
+    auto order = std::vector<std::uint32_t>(triplets.size());
+    auto cursor = std::vector<std::uint32_t>(row_offsets.begin(), row_offsets.end() - 1);
+
+    for (auto i : range(triplets.size())){
+      order[cursor[triplets[i].row]++] = static_cast<std::uint32_t>(i);
+    }
+
+    column_indices.reserve(triplets.size());
+    values.reserve(triplets.size());
+
+    auto begin = std::uint32_t(0);
+
+    for (auto r : range(rows)){
+      const auto end = row_offsets[r + 1];
+
+      std::stable_sort(order.begin() + begin, order.begin() + end, [&](auto a, auto b){
+        return triplets[a].column < triplets[b].column;
+      });
+
+      row_offsets[r] = static_cast<std::uint32_t>(values.size());
+
+      for (auto i : range(begin, end)){
+        const auto& t = triplets[order[i]];
+
+        if (values.size() > row_offsets[r] && column_indices.back() == t.column){
+          values.back() += t.value;
+        }
+        else{
+          column_indices.push_back(t.column);
+          values.push_back(t.value);
+        }
+      }
+
+      begin = end;
+    }
+
+    row_offsets[rows] = static_cast<std::uint32_t>(values.size());
+  }
+
+  //Number of stored blocks:
+  auto nonzeros() const noexcept{
+    return values.size();
+  }
+
+  //The stored block, or a zero block:
+  auto operator()(std::size_t row, std::size_t column) const noexcept{
+    const auto first = column_indices.begin() + row_offsets[row];
+    const auto last = column_indices.begin() + row_offsets[row + 1];
+    const auto found = std::lower_bound(first, last, column);
+
+    return found != last && *found == column
+      ? values[found - column_indices.begin()]
+      : Block();
+  }
+
+  auto diagonal() const{
+    auto result = std::vector<Block>(std::min(rows, columns));
+
+    for (auto r : range(result.size())){
+      result[r] = (*this)(r, r);
+    }
+
+    return result;
+  }
+
+  //y[begin, end) = (A * x)[begin, end):
+  auto multiply_rows(const vector_type* x, vector_type* y, std::size_t begin, std::size_t end) const noexcept{
+    for (auto r : range(begin, end)){
+      auto sum = vector_type();
+
+      for (auto i : range(row_offsets[r], row_offsets[r + 1])){
+        detail::multiply_add(values[i], x[column_indices[i]], sum);
+      }
+
+      y[r] = sum;
+    }
+  }
+
+  //y = A * x, rows split across threads. y is resized to rows:
+  auto multiply(
+    const std::vector<vector_type>& x,
+    std::vector<vector_type>& y,
+    std::size_t threads = hardware_threads()
+  ) const{
+    y.resize(rows);
+
+    parallel_for(rows, [&](std::size_t begin, std::size_t end){
+      multiply_rows(x.data(), y.data(), begin, end);
+    }, detail::sparse_threads(rows, threads));
+  }
+
+  auto operator*(const std::vector<vector_type>& x) const{
+    auto result = std::vector<vector_type>();
+    multiply(x, result);
+    return result;
+  }
+};
+
+template<typename T>
+using csr_matrix = sparse_matrix<T>;
+
+template<typename T, std::size_t B>
+using bsr_matrix = sparse_matrix<mat<T, B, B>>;
+
+//Jacobi preconditioner, z = D^-1 * r with the inverted diagonal (blocks) of A:
+template<typename Block>
+struct jacobi_preconditioner{
+  using vector_type = typename detail::sparse_block<Block>::vector_type;
+
+  std::vector<Block> inverse_diagonal;
+
+  jacobi_preconditioner() = default;
+
+  explicit jacobi_preconditioner(const sparse_matrix<Block>& a)
+  : inverse_diagonal(a.diagonal()){
+    for (auto& d : inverse_diagonal){
+      d = detail::invert_or_identity(d);
+    }
+  }
+
+  auto apply(const vector_type& r, std::size_t row) const noexcept{
+    auto z = vector_type();
+    detail::multiply_add(inverse_diagonal[row], r, z);
+    return z;
+  }
+};
+
+template<typename T>
+struct cg_settings{
+  std::size_t max_iterations = 1000;
+  T tolerance = T(1e-6); //on |b - A x| / |b|
+};
+
+template<typename T>
+struct cg_result{
+  std::size_t iterations = 0;
+  T residual = T(0); //|b - A x| / |b| at the end
+  bool converged = false;
+};
+
+//Preconditioned conjugate gradients for symmetric positive definite A,
+//starting from the given x. The preconditioner needs apply(r, row) returning
+//row `row` of M^-1 * r, like jacobi_preconditioner. Every iteration is three
+//parallel passes: the product fused with p.q, the updates of x and r fused
+//with the preconditioner and both reductions, and the new search direction.
+template<typename Block, typename Preconditioner>
+inline auto pcg(
+  const sparse_matrix<Block>& a,
+  const std::vector<typename sparse_matrix<Block>::vector_type>& b,
+  std::vector<typename sparse_matrix<Block>::vector_type>& x,
+  const Preconditioner& preconditioner,
+  const cg_settings<typename sparse_matrix<Block>::scalar_type>& settings = {},
+  std::size_t threads = hardware_threads()
+){
+  using T = typename sparse_matrix<Block>::scalar_type;
+  using V = typename sparse_matrix<Block>::vector_type;
+
+  const auto n = a.rows;
+  auto result = cg_result<T>();
+
+  x.resize(n);
+
+  auto r = std::vector<V>(n);
+  auto z = std::vector<V>(n);
+  auto p = std::vector<V>(n);
+  auto q = std::vector<V>(n);
+
+  //(r.z, r.r) after x += alpha * p, r -= alpha * q, z = M^-1 * r:
+  const auto update = [&](T alpha){
+    return detail::parallel_sum<vec<T, 2>>(n, [&](std::size_t begin, std::size_t end){
+      auto sums = vec<T, 2>();
+
+      for (auto i : range(begin, end)){
+        detail::axpy(alpha, p[i], x[i]);
+        detail::axpy(-alpha, q[i], r[i]);
+        z[i] = preconditioner.apply(r[i], i);
+
+        sums.x += detail::sparse_dot(r[i], z[i]);
+        sums.y += detail::sparse_dot(r[i], r[i]);
+      }
+
+      return sums;
+    }, threads);
+  };
+
+  const auto b_squared = detail::parallel_sum<T>(n, [&](std::size_t begin, std::size_t end){
+    auto sum = T(0);
+
+    for (auto i : range(begin, end)){
+      sum += detail::sparse_dot(b[i], b[i]);
+    }
+
+    return sum;
+  }, threads);
+
+  const auto scale = b_squared > T(0) ? T(1) / std::sqrt(b_squared) : T(1);
+
+  //r = b - A * x, p = z:
+  a.multiply(x, q, threads);
+
+  for (auto i : range(n)){
+    r[i] = b[i] - q[i];
+  }
+
+  auto sums = update(T(0));
+  p = z;
+
+  for (;;){
+    result.residual = std::sqrt(sums.y) * scale;
+
+    if (result.residual <= settings.tolerance){
+      result.converged = true;
+      break;
+    }
+
+    if (result.iterations == settings.max_iterations) break;
+    ++result.iterations;
+
+    const auto pq = detail::parallel_sum<T>(n, [&](std::size_t begin, std::size_t end){
+      a.multiply_rows(p.data(), q.data(), begin, end);
+
+      auto sum = T(0);
+
+      for (auto i : range(begin, end)){
+        sum += detail::sparse_dot(p[i], q[i]);
+      }
+
+      return sum;
+    }, threads);
+
+    //Not positive definite along p:
+    if (!(pq > T(0))) break;
+
+    const auto rz = sums.x;
+    sums = update(rz / pq);
+
+    const auto beta = sums.x / rz;
+
+    parallel_for(n, [&](std::size_t begin, std::size_t end){
+      for (auto i : range(begin, end)){
+        detail::each_component<V>([&](std::size_t k){
+          detail::component(p[i], k) = detail::component(z[i], k) + beta * detail::component(p[i], k);
+        });
+      }
+    }, detail::sparse_threads(n, threads));
+  }
+
+  return result;
+}
+
+//With the Jacobi preconditioner of A:
+template<typename Block>
+inline auto pcg(
+  const sparse_matrix<Block>& a,
+  const std::vector<typename sparse_matrix<Block>::vector_type>& b,
+  std::vector<typename sparse_matrix<Block>::vector_type>& x,
+  const cg_settings<typename sparse_matrix<Block>::scalar_type>& settings = {},
+  std::size_t threads = hardware_threads()
+){
+  return pcg(a, b, x, jacobi_preconditioner<Block>(a), settings, threads);
+}
+
+} //namespace gf::math
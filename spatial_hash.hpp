@@ -0,0 +1,290 @@
+#pragma once
+
+#include "math.hpp"
+#include <vector>
+
+namespace gf::math{
+
+//Uniform grid over vec<T, N> positions, storing only the occupied cells in an
+//open addressing table with linear probing. Objects of a cell are chained
+//through the entry array; rebuild() lays every chain out contiguously, which
+//is what per-frame rebuilds of many moving objects should use.
+template<typename T, std::size_t N>
+struct spatial_hash{
+  using cell_type = vec<std::int32_t, N>;
+  using position_type = vec<T, N>;
+
+  struct entry{
+    position_type position;
+    std::uint32_t object;
+    std::uint32_t next; //next entry of the same cell, or InvalidIndex
+  };
+
+  struct slot{
+    cell_type cell;
+    std::uint32_t head = InvalidIndex; //InvalidIndex marks an empty slot
+    std::uint32_t count = 0;
+  };
+
+  explicit spatial_hash(T cell_size)
+  : inv_cell_size(T(1) / cell_size), slots(16) {}
+
+  auto cell_of(const position_type& position) const noexcept{
+    auto result = cell_type();
+
+    for (auto i : range(N)){
+      result[i] = static_cast<std::int32_t>(std::floor(position[i] * inv_cell_size));
+    }
+
+    return result;
+  }
+
+  //Number of stored objects:
+  auto size() const noexcept{
+    return object_count;
+  }
+
+  auto cell_count() const noexcept{
+    return used_slots;
+  }
+
+  auto clear(){
+    for (auto& s : slots){
+      s = slot();
+    }
+
+    entries.clear();
+    free_entry = InvalidIndex;
+    object_count = 0;
+    used_slots = 0;
+  }
+
+  //Replaces the content with objects 0..positions.size()-1.
+  auto rebuild(const std::vector<position_type>& positions){
+    clear();
+    reserve_cells(positions.size());
+
+    slot_of.resize(positions.size());
+
+    for (auto i : range(positions.size())){
+      const auto s = find_or_insert(cell_of(positions[i]));
+      slot_of[i] = s;
+      ++slots[s].count;
+    }
+
+    //Counting sort: every cell gets a contiguous run of entries.
+    auto offset = std::uint32_t(0);
+
+    for (auto& s : slots){
+      if (s.count == 0) continue;
+
+      s.head = offset;
+      offset += s.count;
+    }
+
+    cursor.assign(slots.size(), 0);
+    entries.resize(positions.size());
+
+    for (auto i : range(positions.size())){
+      const auto& s = slots[slot_of[i]];
+      const auto index = s.head + cursor[slot_of[i]]++;
+      const auto last = cursor[slot_of[i]] == s.count;
+
+      entries[index] = entry{
+        positions[i],
+        static_cast<std::uint32_t>(i),
+        last ? InvalidIndex : index + 1
+      };
+    }
+
+    object_count = positions.size();
+  }
+
+  auto insert(std::uint32_t object, const position_type& position){
+    reserve_cells(used_slots + 1);
+
+    const auto s = find_or_insert(cell_of(position));
+    auto index = free_entry;
+
+    if (index != InvalidIndex){
+      free_entry = entries[index].next;
+    }
+    else{
+      index = static_cast<std::uint32_t>(entries.size());
+      entries.emplace_back();
+    }
+
+    entries[index] = entry{ position, object, slots[s].head };
+    slots[s].head = index;
+    ++slots[s].count;
+    ++object_count;
+  }
+
+  //The position has to be the one the object was inserted with. Returns false if not found.
+  auto remove(std::uint32_t object, const position_type& position){
+    const auto s = find(cell_of(position));
+    if (s == InvalidIndex) return false;
+
+    auto previous = InvalidIndex;
+
+    for (auto index = slots[s].head; index != InvalidIndex; index = entries[index].next){
+      if (entries[index].object != object){
+        previous = index;
+        continue;
+      }
+
+      if (previous == InvalidIndex){
+        slots[s].head = entries[index].next;
+      }
+      else{
+        entries[previous].next = entries[index].next;
+      }
+
+      entries[index].next = free_entry;
+      free_entry = index;
+      --object_count;
+
+      if (--slots[s].count == 0) erase_slot(s);
+      return true;
+    }
+
+    return false;
+  }
+
+  //Calls callable(object, position) for every object in the cell:
+  template<typename Callable>
+  auto query(const cell_type& cell, Callable callable) const{
+    const auto s = find(cell);
+    if (s == InvalidIndex) return;
+
+    for (auto index = slots[s].head; index != InvalidIndex; index = entries[index].next){
+      callable(entries[index].object, entries[index].position);
+    }
+  }
+
+  //Calls callable(object, position) for every object within the radius:
+  template<typename Callable>
+  auto query(const position_type& center, T radius, Callable callable) const{
+    const auto low = cell_of(center - radius);
+    const auto high = cell_of(center + radius);
+    const auto radius_squared = radius * radius;
+
+    auto cell = low;
+
+    //Walks every cell of the box [low, high] like an odometer:
+    for (;;){
+      query(cell, [&](std::uint32_t object, const position_type& position){
+        if (distance_squared(center, position) <= radius_squared){
+          callable(object, position);
+        }
+      });
+
+      auto axis = std::size_t(0);
+
+      while (axis < N && cell[axis] == high[axis]){
+        cell[axis] = low[axis];
+        ++axis;
+      }
+
+      if (axis == N) break;
+      ++cell[axis];
+    }
+  }
+
+private:
+  T inv_cell_size;
+
+  std::vector<slot> slots;
+  std::vector<entry> entries;
+  std::uint32_t free_entry = InvalidIndex;
+  std::size_t object_count = 0;
+  std::size_t used_slots = 0;
+
+  //Scratch buffers of rebuild(), kept to avoid reallocating every frame:
+  std::vector<std::uint32_t> slot_of;
+  std::vector<std::uint32_t> cursor;
+
+  auto home(const cell_type& cell) const noexcept{
+    return std::hash<cell_type>{}(cell) & (slots.size() - 1);
+  }
+
+  auto is_empty(const slot& s) const noexcept{
+    return s.head == InvalidIndex && s.count == 0;
+  }
+
+  auto find(const cell_type& cell) const noexcept{
+    const auto mask = slots.size() - 1;
+
+    for (auto i = home(cell);; i = (i + 1) & mask){
+      if (is_empty(slots[i])) return InvalidIndex;
+      if (slots[i].cell == cell) return static_cast<std::uint32_t>(i);
+    }
+  }
+
+  //The slot is claimed by setting count or head, which the callers do right away:
+  auto find_or_insert(const cell_type& cell) noexcept{
+    const auto mask = slots.size() - 1;
+
+    for (auto i = home(cell);; i = (i + 1) & mask){
+      if (is_empty(slots[i])){
+        slots[i].cell = cell;
+        ++used_slots;
+        return static_cast<std::uint32_t>(i);
+      }
+
+      if (slots[i].cell == cell) return static_cast<std::uint32_t>(i);
+    }
+  }
+
+  //Keeps the load factor at or below one half:
+  auto reserve_cells(std::size_t cells){
+    if (cells * 2 <= slots.size()) return;
+
+    auto capacity = slots.size();
+    while (cells * 2 > capacity) capacity *= 2;
+
+    auto old = std::move(slots);
+    slots = std::vector<slot>(capacity);
+
+    for (const auto& s : old){
+      if (is_empty(s)) continue;
+
+      const auto mask = slots.size() - 1;
+      auto i = home(s.cell);
+
+      while (!is_empty(slots[i])) i = (i + 1) & mask;
+      slots[i] = s;
+    }
+  }
+
+  //Backward shift deletion, so lookups never need tombstones:
+  auto erase_slot(std::size_t hole){
+    const auto mask = slots.size() - 1;
+
+    slots[hole] = slot();
+    --used_slots;
+
+    for (auto i = (hole + 1) & mask; !is_empty(slots[i]); i = (i + 1) & mask){
+      const auto wanted = home(slots[i].cell);
+
+      //Moves the entry back unless its home lies cyclically in (hole, i]:
+      const auto stays = hole <= i
+        ? (wanted > hole && wanted <= i)
+        : (wanted > hole || wanted <= i);
+
+      if (stays) continue;
+
+      slots[hole] = slots[i];
+      slots[i] = slot();
+      hole = i;
+    }
+  }
+};
+
+template<typename T>
+using spatial_hash2 = spatial_hash<T, 2>;
+
+template<typename T>
+using spatial_hash3 = spatial_hash<T, 3>;
+
+} //namespace gf::math
@@ -0,0 +1,150 @@
+#define GEFEC_MATH_DEBUG
+#include "../batch.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace m = gf::math;
+
+//Not a multiple of the packet size, so the tails run too:
+constexpr auto Count = std::size_t(1000 + 7);
+
+template<typename Callable>
+auto every_isa(Callable callable){
+  auto result = true;
+
+  for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+    if (m::force_isa(level) != level) continue;
+    result = result && callable();
+  }
+
+  m::force_isa(m::supported_isa());
+  return result;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  auto random = std::mt19937(5);
+  auto element = std::uniform_real_distribution<float>(-10.f, 10.f);
+
+  auto points = std::vector<m::vec3>(Count);
+  auto others = std::vector<m::vec3>(Count);
+  auto vectors = std::vector<m::vec4>(Count);
+  auto matrices = std::vector<m::mat4>(Count);
+  auto boxes = std::vector<m::aabb<float>>(Count);
+
+  for (auto i : m::range(Count)){
+    points[i] = m::vec3(element(random), element(random), element(random));
+    others[i] = m::vec3(element(random), element(random), element(random));
+    vectors[i] = m::vec4(element(random), element(random), element(random), element(random));
+
+    for (auto [x, y] : m::range({ 4, 4 })){
+      matrices[i][x][y] = element(random);
+    }
+
+    boxes[i] = m::aabb<float>().extend(points[i]).extend(points[i] + m::vec3(1.f));
+  }
+
+  const auto transform = matrices[0];
+
+  test("isa: query and force", []{
+    const auto supported = m::supported_isa();
+
+    return
+      m::force_isa(m::isa::scalar) == m::isa::scalar &&
+      m::active_isa() == m::isa::scalar &&
+      m::force_isa(m::isa::avx512) == supported &&
+      m::active_isa() == supported &&
+      std::string(m::isa_name(m::isa::avx2)) == "avx2";
+  });
+
+  test("transform_points and transform match the operators", [&]{
+    return every_isa([&]{
+      auto transformed = std::vector<m::vec3>(Count);
+      auto transformed4 = std::vector<m::vec4>(Count);
+
+      m::transform_points(transform, points.data(), Count, transformed.data());
+      m::transform(transform, vectors.data(), Count, transformed4.data());
+
+      for (auto i : m::range(Count)){
+        if (!m::compare(transformed[i], (transform * points[i].as_vec<4>(1.f)).xyz(), 1e-4f)) return false;
+        if (!m::compare(transformed4[i], transform * vectors[i], 1e-4f)) return false;
+      }
+
+      return true;
+    });
+  });
+
+  test("transform_points: row-major matrices", [&]{
+    const auto row_major = m::mat<float, 4, 4, m::layout::row_major>(transform);
+    auto a = std::vector<m::vec3>(Count);
+    auto b = std::vector<m::vec3>(Count);
+
+    m::transform_points(transform, points.data(), Count, a.data());
+    m::transform_points(row_major, points.data(), Count, b.data());
+
+    return a == b;
+  });
+
+  test("dot and normalize match the operators", [&]{
+    return every_isa([&]{
+      auto dots = std::vector<float>(Count);
+      auto normalized = std::vector<m::vec3>(Count);
+
+      m::dot(points.data(), others.data(), Count, dots.data());
+      m::normalize(points.data(), Count, normalized.data());
+
+      for (auto i : m::range(Count)){
+        if (!m::compare(dots[i], m::dot(points[i], others[i]), 1e-4f)) return false;
+        if (!m::compare(normalized[i], points[i].normalized(), 1e-6f)) return false;
+      }
+
+      return true;
+    });
+  });
+
+  test("multiply matches the operator", [&]{
+    return every_isa([&]{
+      auto products = std::vector<m::mat4>(Count);
+      m::multiply(matrices.data(), matrices.data() + 1, Count - 1, products.data());
+
+      for (auto i : m::range(Count - 1)){
+        const auto expected = matrices[i] * matrices[i + 1];
+
+        for (auto [x, y] : m::range({ 4, 4 })){
+          if (!m::compare(products[i][x][y], expected[x][y], 1e-3f)) return false;
+        }
+      }
+
+      return true;
+    });
+  });
+
+  test("cull matches overlaps", [&]{
+    const auto projection = m::mat4(
+      1.f, 0.f, 0.f, 0.f,
+      0.f, 1.f, 0.f, 0.f,
+      0.f, 0.f, 0.1f, 0.5f,
+      0.f, 0.f, 0.1f, 1.f
+    );
+    const auto f = m::frustum<float>(projection);
+
+    return every_isa([&]{
+      auto visible = std::vector<std::uint8_t>(Count);
+      auto count = std::size_t(0);
+
+      m::cull(f, boxes.data(), Count, visible.data());
+
+      for (auto i : m::range(Count)){
+        if (visible[i] != m::overlaps(f, boxes[i])) return false;
+        count += visible[i];
+      }
+
+      return count > 0 && count < Count;
+    });
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
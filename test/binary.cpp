@@ -0,0 +1,110 @@
+#define GEFEC_MATH_DEBUG
+#include "../binary.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <filesystem>
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  namespace m = gf::math;
+
+  const auto directory = std::filesystem::temp_directory_path();
+  const auto points_path = (directory / "gf_math_points.bin").string();
+  const auto transforms_path = (directory / "gf_math_transforms.bin").string();
+  const auto truncated_path = (directory / "gf_math_truncated.bin").string();
+
+  auto points = std::vector<m::vec3>(10000);
+  for (auto i : m::range(points.size())){
+    points[i] = m::vec3(float(i), -0.5f * i, 1.f / (i + 1));
+  }
+
+  auto transforms = std::vector<m::mat4>(100);
+  for (auto i : m::range(transforms.size())){
+    transforms[i] = m::translation(m::vec3(float(i), 2.f, 3.f)) * m::scale(m::vec3(0.5f * i));
+  }
+
+  test("binary: batched writer", [&]{
+    auto writer = m::binary_writer<m::vec3>(points_path.c_str());
+
+    for (auto begin = std::size_t(0); begin < points.size(); begin += 999){
+      writer.write(points.data() + begin, m::min<std::size_t>(999, points.size() - begin));
+    }
+
+    return writer.count() == points.size() && writer.close() && !writer;
+  });
+
+  test("binary: header layout", [&]{
+    const auto expected = sizeof(m::vec3) * points.size() + m::BinaryAlignment;
+    return std::filesystem::file_size(points_path) == expected;
+  });
+
+  test("binary: mapped vec3", [&]{
+    const auto mapped = m::mapped_array<m::vec3>(points_path.c_str());
+
+    if (!mapped || mapped.size() != points.size()) return false;
+    if (reinterpret_cast<std::uintptr_t>(mapped.data()) % alignof(m::vec3) != 0) return false;
+
+    for (auto i : m::range(points.size())){
+      if (mapped[i] != points[i]) return false;
+    }
+
+    const auto tail = mapped.chunk(9990, 100);
+    return tail.size() == 10 && tail[0] == points[9990];
+  });
+
+  test("binary: mapped mat4", [&]{
+    if (!m::write_binary(transforms_path.c_str(), transforms)) return false;
+
+    const auto mapped = m::mapped_array<m::mat4>(transforms_path.c_str());
+    auto index = std::size_t(0);
+
+    for (const auto& transform : mapped){
+      if (transform != transforms[index++]) return false;
+    }
+
+    return index == transforms.size();
+  });
+
+  test("binary: chunked reader", [&]{
+    auto reader = m::binary_reader<m::vec3>(points_path.c_str());
+    auto chunk = std::vector<m::vec3>();
+    auto index = std::size_t(0);
+
+    while (reader.read(chunk, 4096) != 0){
+      for (const auto& point : chunk){
+        if (point != points[index++]) return false;
+      }
+    }
+
+    return index == points.size() && reader.remaining() == 0;
+  });
+
+  test("binary: element type is checked", [&]{
+    return
+      !m::mapped_array<m::vec2>(points_path.c_str()) &&
+      !m::mapped_array<m::dvec3>(points_path.c_str()) &&
+      !m::binary_reader<m::mat4>(points_path.c_str()) &&
+      !m::mapped_array<m::vec3>(transforms_path.c_str()) &&
+      !m::mapped_array<m::mat<float, 4, 4, m::layout::row_major>>(transforms_path.c_str()) &&
+      !m::mapped_array<m::vec3>("this file does not exist") &&
+      m::read_binary<m::mat4>(transforms_path.c_str()) == transforms;
+  });
+
+  test("binary: truncated files are rejected", [&]{
+    std::filesystem::copy_file(
+      points_path, truncated_path, std::filesystem::copy_options::overwrite_existing
+    );
+    std::filesystem::resize_file(truncated_path, std::filesystem::file_size(points_path) - 1);
+
+    return
+      !m::mapped_array<m::vec3>(truncated_path.c_str()) &&
+      !m::binary_reader<m::vec3>(truncated_path.c_str());
+  });
+
+  for (const auto& path : { points_path, transforms_path, truncated_path }){
+    std::filesystem::remove(path);
+  }
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,226 @@
+#define GEFEC_MATH_DEBUG
+#include "../bvh.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+#include <set>
+
+namespace m = gf::math;
+
+auto random_triangles(std::size_t count){
+  auto random = std::mt19937(42);
+  auto position = std::uniform_real_distribution<float>(-10.f, 10.f);
+  auto offset = std::uniform_real_distribution<float>(-1.f, 1.f);
+
+  auto vertices = std::vector<m::vec3>();
+
+  for (auto i : m::range(count)){
+    (void)i;
+    const auto center = m::vec3(position(random), position(random), position(random));
+
+    for (auto j : m::range(3)){
+      (void)j;
+      vertices.push_back(center + m::vec3(offset(random), offset(random), offset(random)));
+    }
+  }
+
+  return vertices;
+}
+
+auto random_rays(std::size_t count){
+  auto random = std::mt19937(7);
+  auto position = std::uniform_real_distribution<float>(-10.f, 10.f);
+
+  auto rays = std::vector<m::fray>();
+
+  for (auto i : m::range(count)){
+    (void)i;
+    const auto origin = m::vec3(position(random), position(random), -20.f);
+    const auto target = m::vec3(position(random), position(random), position(random));
+
+    rays.push_back(m::fray{ origin, (target - origin).normalized() });
+  }
+
+  return rays;
+}
+
+auto brute_force(const std::vector<m::vec3>& vertices, const m::fray& r){
+  auto result = m::bvh_hit<float>();
+
+  for (auto i : m::range(vertices.size() / 3)){
+    auto triangle = m::triangle_packet<float, 1>();
+    triangle.set(0, vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+
+    const auto hits = m::intersect(r, triangle, 0.f, result.t);
+
+    if (hits.any()){
+      result = m::bvh_hit<float>{ static_cast<std::uint32_t>(i), hits.t[0], hits.u[0], hits.v[0] };
+    }
+  }
+
+  return result;
+}
+
+template<typename Tree>
+auto matches_brute_force(const Tree& tree, const std::vector<m::vec3>& vertices){
+  for (const auto& r : random_rays(300)){
+    const auto expected = brute_force(vertices, r);
+    const auto hit = tree.intersect(r);
+
+    if (hit.triangle != expected.triangle) return false;
+    if (hit.hit() && !m::compare(hit.t, expected.t)) return false;
+  }
+
+  return true;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  const auto vertices = random_triangles(3000);
+
+  test("aabb extend and surface area", []{
+    auto box = m::aabb<float>();
+    const auto empty = box.is_empty();
+
+    box.extend(m::vec3(0.f)).extend(m::vec3(1.f, 2.f, 3.f));
+
+    return
+      empty &&
+      !box.is_empty() &&
+      box.surface_area() == 22.f &&
+      box.major_axis() == 2 &&
+      box.center() == m::vec3(0.5f, 1.f, 1.5f);
+  });
+
+  test("frustum culls boxes", []{
+    //perspective() is laid out for row vectors, its transpose maps column vectors to clip space:
+    const auto projection = m::perspective(1.f, float(m::pi / 2.0), 0.1f, 100.f).t();
+    const auto view = m::translation(m::vec3(0.f, 0.f, 10.f));
+    const auto f = m::frustum<float>(projection * view);
+
+    auto in_front = m::aabb<float>();
+    in_front.extend(m::vec3(-1.f)).extend(m::vec3(1.f));
+
+    auto behind = m::aabb<float>();
+    behind.extend(m::vec3(-1.f, -1.f, -20.f)).extend(m::vec3(1.f, 1.f, -15.f));
+
+    auto aside = m::aabb<float>();
+    aside.extend(m::vec3(50.f, -1.f, -1.f)).extend(m::vec3(52.f, 1.f, 1.f));
+
+    return m::overlaps(f, in_front) && !m::overlaps(f, behind) && !m::overlaps(f, aside);
+  });
+
+  test("bvh: empty mesh", []{
+    const auto tree = m::bvh<float>(std::vector<m::vec3>());
+    const auto tree4 = m::bvh4<float>(tree);
+    const auto r = m::fray{ m::vec3(0.f), m::vec3(0.f, 0.f, 1.f) };
+
+    return !tree.intersect(r).hit() && !tree4.intersect(r).hit();
+  });
+
+  test("bvh: single triangle", []{
+    const auto vertices = std::vector{ m::vec3(-1.f, -1.f, 0.f), m::vec3(1.f, -1.f, 0.f), m::vec3(0.f, 1.f, 0.f) };
+    const auto tree = m::bvh<float>(vertices);
+    const auto tree4 = m::bvh4<float>(tree);
+    const auto r = m::fray{ m::vec3(0.f, 0.f, -5.f), m::vec3(0.f, 0.f, 1.f) };
+
+    return 
+      tree.intersect(r).triangle == 0 && 
+      m::compare(tree.intersect(r).t, 5.f) &&
+      tree4.intersect(r).triangle == 0;
+  });
+
+  test("bvh: closest hit matches brute force", [&]{
+    return matches_brute_force(m::bvh<float>(vertices), vertices);
+  });
+
+  test("bvh: serial and parallel builds agree", []{
+    //Enough triangles for the root's children to be built on their own threads:
+    const auto large = random_triangles(3 * m::detail::bvh_builder<float>::ParallelThreshold);
+
+    return 
+      matches_brute_force(m::bvh<float>(large, {}, 1), large) &&
+      matches_brute_force(m::bvh<float>(large, {}, 8), large);
+  });
+
+  test("bvh: indexed mesh", []{
+    const auto positions = std::vector{ 
+      m::vec3(-1.f, -1.f, 0.f), m::vec3(1.f, -1.f, 0.f), 
+      m::vec3(1.f, 1.f, 0.f), m::vec3(-1.f, 1.f, 0.f) 
+    };
+    const auto indices = std::vector<std::uint32_t>{ 0, 1, 2, 2, 3, 0 };
+    const auto tree = m::bvh<float>(positions, indices);
+
+    const auto r1 = m::fray{ m::vec3(0.5f, -0.5f, -5.f), m::vec3(0.f, 0.f, 1.f) };
+    const auto r2 = m::fray{ m::vec3(-0.5f, 0.5f, -5.f), m::vec3(0.f, 0.f, 1.f) };
+
+    return tree.intersect(r1).triangle == 0 && tree.intersect(r2).triangle == 1;
+  });
+
+  test("bvh4: closest hit matches brute force", [&]{
+    return matches_brute_force(m::bvh4<float>(m::bvh<float>(vertices)), vertices);
+  });
+
+  test("bvh: refit follows moved vertices", [&]{
+    auto tree = m::bvh<float>(vertices);
+    auto moved = vertices;
+
+    for (auto& v : moved){
+      v = v * 0.5f + m::vec3(3.f, 0.f, 1.f);
+    }
+
+    tree.refit(moved);
+
+    return 
+      matches_brute_force(tree, moved) &&
+      matches_brute_force(m::bvh4<float>(tree), moved);
+  });
+
+  test("bvh: aabb query", [&]{
+    const auto tree = m::bvh<float>(vertices);
+
+    auto box = m::aabb<float>();
+    box.extend(m::vec3(-3.f, -2.f, -4.f)).extend(m::vec3(2.f, 5.f, 1.f));
+
+    auto found = std::set<std::uint32_t>();
+    tree.query(box, [&](std::uint32_t triangle){ found.insert(triangle); });
+
+    auto expected = std::set<std::uint32_t>();
+    for (auto i : m::range(vertices.size() / 3)){
+      auto bounds = m::aabb<float>();
+      bounds.extend(vertices[i * 3]).extend(vertices[i * 3 + 1]).extend(vertices[i * 3 + 2]);
+
+      if (m::overlaps(bounds, box)) expected.insert(static_cast<std::uint32_t>(i));
+    }
+
+    return !expected.empty() && found == expected;
+  });
+
+  test("bvh: frustum query", [&]{
+    const auto tree = m::bvh<float>(vertices);
+    const auto projection = m::perspective(1.f, float(m::pi / 4.0), 0.1f, 100.f).t();
+    const auto f = m::frustum<float>(projection * m::translation(m::vec3(0.f, 0.f, 30.f)));
+
+    auto found = std::set<std::uint32_t>();
+    tree.query(f, [&](std::uint32_t triangle){ found.insert(triangle); });
+
+    //Every triangle with all vertices strictly inside the clip volume must be reported:
+    for (auto i : m::range(vertices.size() / 3)){
+      auto inside = true;
+
+      for (auto j : m::range(3)){
+        const auto clip = projection * (vertices[i * 3 + j] + m::vec3(0.f, 0.f, 30.f)).as_vec<4>(1.f);
+        inside = inside && 
+          m::abs(clip.x) < clip.w && m::abs(clip.y) < clip.w && 
+          clip.z > 0.f && clip.z < clip.w;
+      }
+
+      if (inside && found.count(static_cast<std::uint32_t>(i)) == 0) return false;
+    }
+
+    return !found.empty() && found.size() < vertices.size() / 3;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
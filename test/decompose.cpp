@@ -0,0 +1,189 @@
+#define GEFEC_MATH_DEBUG
+#include "../decompose.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace m = gf::math;
+
+template<typename T>
+auto max_difference(const m::mat<T, 3, 3>& a, const m::mat<T, 3, 3>& b){
+  auto result = T(0);
+
+  for (auto [x, y] : m::range({ 3, 3 })){
+    result = m::max(result, m::abs(a[x][y] - b[x][y]));
+  }
+
+  return result;
+}
+
+template<typename T>
+auto is_rotation(const m::mat<T, 3, 3>& r, T tolerance){
+  return
+    max_difference(r.t() * r, m::mat<T, 3, 3>(T(1))) < tolerance &&
+    m::abs(r.det() - T(1)) < tolerance;
+}
+
+template<typename T>
+auto diagonal(const m::vec<T, 3>& v){
+  auto result = m::mat<T, 3, 3>();
+
+  for (auto i : m::range(3)){
+    result[i][i] = v[i];
+  }
+
+  return result;
+}
+
+template<typename T>
+auto random_matrices(std::size_t count, bool symmetric){
+  auto random = std::mt19937(7);
+  auto element = std::uniform_real_distribution<T>(-10, 10);
+  auto result = std::vector<m::mat<T, 3, 3>>(count);
+
+  for (auto& a : result){
+    for (auto [x, y] : m::range({ 3, 3 })){
+      a[x][y] = element(random);
+    }
+
+    if (symmetric) a = a + a.t();
+  }
+
+  return result;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("eigen_sym: diagonal and repeated eigenvalues", []{
+    const auto a = m::mat3(
+      2.f, 0.f, 0.f,
+      0.f, 5.f, 0.f,
+      0.f, 0.f, -1.f
+    );
+    const auto identity = m::eigen_sym(m::mat3(3.f));
+    const auto e = m::eigen_sym(a);
+
+    return
+      e.values == m::vec3(5.f, 2.f, -1.f) &&
+      is_rotation(e.vectors, 1e-6f) &&
+      identity.values == m::vec3(3.f) &&
+      identity.vectors == m::mat3(1.f);
+  });
+
+  test("eigen_sym: random symmetric matrices", []{
+    for (const auto& a : random_matrices<double>(1000, true)){
+      const auto e = m::eigen_sym(a);
+
+      if (!is_rotation(e.vectors, 1e-12)) return false;
+      if (e.values.x < e.values.y || e.values.y < e.values.z) return false;
+      if (max_difference(e.vectors * diagonal(e.values) * e.vectors.t(), a) > 1e-12) return false;
+    }
+
+    for (const auto& a : random_matrices<float>(1000, true)){
+      const auto e = m::eigen_sym(a);
+
+      if (!is_rotation(e.vectors, 1e-5f)) return false;
+      if (max_difference(e.vectors * diagonal(e.values) * e.vectors.t(), a) > 1e-4f) return false;
+    }
+
+    return true;
+  });
+
+  test("svd: random matrices", []{
+    for (const auto& a : random_matrices<double>(1000, false)){
+      const auto d = m::svd(a);
+
+      if (!is_rotation(d.u, 1e-12) || !is_rotation(d.v, 1e-12)) return false;
+      if (d.sigma.x < d.sigma.y || d.sigma.y < m::abs(d.sigma.z)) return false;
+      if ((d.sigma.z < 0.0) != (a.det() < 0.0)) return false;
+      if (max_difference(d.u * diagonal(d.sigma) * d.v.t(), a) > 1e-11) return false;
+    }
+
+    return true;
+  });
+
+  test("svd: rank deficient matrices", []{
+    const auto zero = m::svd(m::mat3(0.f));
+    const auto planar = m::dmat3(
+      1.0, 2.0, 0.0,
+      3.0, 4.0, 0.0,
+      5.0, 6.0, 0.0
+    );
+    const auto d = m::svd(planar);
+
+    return
+      zero.sigma == m::vec3(0.f) &&
+      is_rotation(zero.u, 1e-6f) && is_rotation(zero.v, 1e-6f) &&
+      m::abs(d.sigma.z) < 1e-12 &&
+      is_rotation(d.u, 1e-12) && is_rotation(d.v, 1e-12) &&
+      max_difference(d.u * diagonal(d.sigma) * d.v.t(), planar) < 1e-12;
+  });
+
+  test("polar: rotation and stretch", []{
+    const auto homogeneous = m::rotation(0.7f, m::vec3(1.f, 2.f, -1.f).normalized());
+    auto rotation = m::mat3();
+
+    for (auto [x, y] : m::range({ 3, 3 })){
+      rotation[x][y] = homogeneous[x][y];
+    }
+
+    const auto stretch = m::mat3(
+      2.f, 0.5f, 0.f,
+      0.5f, 1.f, 0.25f,
+      0.f, 0.25f, 3.f
+    );
+    const auto p = m::polar(rotation * stretch);
+
+    return
+      max_difference(p.rotation, rotation) < 1e-5f &&
+      max_difference(p.stretch, stretch) < 1e-5f &&
+      p.stretch == p.stretch.t();
+  });
+
+  test("polar: reflections give rotations", []{
+    const auto mirrored = m::dmat3(
+      -1.0, 0.0, 0.0,
+      0.0, 2.0, 0.0,
+      0.0, 0.0, 3.0
+    );
+    const auto p = m::polar(mirrored);
+
+    return
+      is_rotation(p.rotation, 1e-12) &&
+      max_difference(p.rotation * p.stretch, mirrored) < 1e-12;
+  });
+
+  test("packets and arrays match single matrices", []{
+    const auto matrices = random_matrices<float>(21, false);
+    auto packet = m::mat_packet<float, 3, 3, 8>();
+
+    for (auto i : m::range(8)){
+      packet.set(i, matrices[i]);
+    }
+
+    const auto svds = m::svd(packet);
+    const auto eigens = m::eigen_sym(packet);
+
+    auto polars = std::vector<m::polar3<float>>(matrices.size());
+    m::polar(matrices.data(), matrices.size(), polars.data());
+
+    for (auto i : m::range(8)){
+      const auto d = m::svd(matrices[i]);
+      const auto e = m::eigen_sym(matrices[i]);
+
+      if (max_difference(svds.u.get(i), d.u) > 1e-6f) return false;
+      if (m::abs(svds.sigma.get(i).x - d.sigma.x) > 1e-5f) return false;
+      if (max_difference(eigens.vectors.get(i), e.vectors) > 1e-6f) return false;
+    }
+
+    for (auto i : m::range(matrices.size())){
+      if (max_difference(polars[i].rotation, m::polar(matrices[i]).rotation) > 1e-6f) return false;
+    }
+
+    return true;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,124 @@
+#define GEFEC_MATH_DEBUG
+#include "../divisor.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <limits>
+#include <random>
+
+namespace m = gf::math;
+
+template<typename T>
+auto interesting_values(){
+  auto values = std::vector<T>{
+    0, 1, 2, 3, 5, 7, 10, 100, 641, 1000, 65535, 65536, 65537,
+    std::numeric_limits<T>::max(), std::numeric_limits<T>::max() - 1
+  };
+
+  for (auto shift : m::range(31)){
+    values.push_back(T(1) << shift);
+    values.push_back((T(1) << shift) + 1);
+    values.push_back((T(1) << shift) - 1);
+  }
+
+  auto random = std::mt19937(7);
+  for (auto i : m::range(200)){
+    (void)i;
+    values.push_back(static_cast<T>(random()));
+  }
+
+  if constexpr (std::is_signed_v<T>){
+    const auto count = values.size();
+
+    for (auto i : m::range(count)){
+      values.push_back(static_cast<T>(0u - static_cast<std::uint32_t>(values[i])));
+    }
+
+    values.push_back(std::numeric_limits<T>::min());
+  }
+
+  return values;
+}
+
+template<typename T>
+auto matches_builtin(){
+  const auto values = interesting_values<T>();
+
+  for (auto d : values){
+    if (d == 0) continue;
+
+    const auto fast = m::divisor<T>(d);
+
+    for (auto n : values){
+      //Overflows with the built-in operator too:
+      if constexpr (std::is_signed_v<T>){
+        if (d == -1 && n == std::numeric_limits<T>::min()) continue;
+      }
+
+      if (n / fast != n / d || n % fast != n % d) return false;
+    }
+  }
+
+  return true;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("ivec: division", []{
+    return
+      m::ivec2(7, -9) / 2 == m::ivec2(3, -4) &&
+      m::ivec3(10, 20, 30) / m::ivec3(3, 4, 7) == m::ivec3(3, 5, 4) &&
+      m::ivec2(7, -9) % 4 == m::ivec2(3, -1) &&
+      m::ivec2(80, 20) / 2 == m::ivec2(40, 10);
+  });
+
+  test("divisor: int32 matches the built-in operators", []{
+    return matches_builtin<std::int32_t>();
+  });
+
+  test("divisor: uint32 matches the built-in operators", []{
+    return matches_builtin<std::uint32_t>();
+  });
+
+  test("divisor: vec", []{
+    const auto d = m::divisor<std::int32_t>(-3);
+    const auto v = m::ivec4(10, -10, 2, 0);
+
+    return v / d == m::ivec4(-3, 3, 0, 0) && v % d == m::ivec4(1, -1, 2, 0);
+  });
+
+  test("divisor: batched", []{
+    auto random = std::mt19937(3);
+    auto values = std::vector<m::ivec3>(1000);
+
+    for (auto& v : values){
+      v = m::ivec3(
+        static_cast<std::int32_t>(random()),
+        static_cast<std::int32_t>(random()),
+        static_cast<std::int32_t>(random())
+      );
+    }
+
+    for (auto divisor : { 1, 8, -16, 7, -1000, 1 << 30 }){
+      const auto d = m::divisor<std::int32_t>(divisor);
+      const auto quotients = m::divide(values, d);
+      const auto remainders = m::modulo(values, d);
+
+      for (auto i : m::range(values.size())){
+        if (quotients[i] != values[i] / divisor) return false;
+        if (remainders[i] != values[i] % divisor) return false;
+      }
+    }
+
+    return true;
+  });
+
+  test("divisor: constexpr", []{
+    constexpr auto d = m::divisor<std::uint32_t>(10);
+    static_assert(d.divide(12345) == 1234);
+    static_assert(d.modulo(12345) == 5);
+    return true;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
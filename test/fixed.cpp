@@ -0,0 +1,191 @@
+#define GEFEC_MATH_DEBUG
+#include "../fixed.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+
+namespace m = gf::math;
+
+using f16 = m::fixed16;
+using fvec3 = m::vec<f16, 3>;
+using fmat4 = m::mat<f16, 4, 4>;
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  static_assert(sizeof(f16) == 4);
+  static_assert(sizeof(m::fixed32) == 8);
+  static_assert(sizeof(fvec3) == 12);
+
+  test("fixed: conversions", []{
+    return
+      f16(3).raw == 3 << 16 &&
+      f16(-2).raw == -2 * 65536 &&
+      f16(0.5).raw == 1 << 15 &&
+      f16(-0.25).raw == -(1 << 14) &&
+      double(f16(1.5)) == 1.5 &&
+      f16(-1.5).to_int() == -2 &&
+      f16::from_raw(1).raw == 1;
+  });
+
+  test("fixed: arithmetic", []{
+    constexpr auto a = f16(1.5);
+    constexpr auto b = f16(-2.25);
+
+    static_assert(a + b == f16(-0.75));
+    static_assert(a * b == f16(-3.375));
+    static_assert(b / a == f16(-1.5));
+    static_assert(-a == f16(-1.5));
+    static_assert(a - 1 == f16(0.5));
+
+    //Multiplication rounds down, division toward zero:
+    const auto tiny = f16::from_raw(1);
+
+    return
+      (tiny * f16(0.5)).raw == 0 &&
+      (-tiny * f16(0.5)).raw == -1 &&
+      (f16(1) / f16(3)).raw == 65536 / 3 &&
+      (f16(-1) / f16(3)).raw == -65536 / 3;
+  });
+
+  test("fixed: rounding functions", []{
+    return
+      m::floor(f16(-1.5)) == f16(-2) && m::ceil(f16(-1.5)) == f16(-1) &&
+      m::trunc(f16(-1.5)) == f16(-1) && m::round(f16(-1.5)) == f16(-2) &&
+      m::round(f16(1.25)) == f16(1) && m::abs(f16(-3)) == f16(3) &&
+      m::abs(fvec3(-1, 2, -3)) == fvec3(1, 2, 3) &&
+      m::floor(fvec3(f16(0.5), f16(-0.5), f16(2))) == fvec3(0, -1, 2);
+  });
+
+  test("fixed: sqrt", []{
+    for (auto i : m::range(1, 180)){
+      const auto x = f16(int(i));
+      if (m::sqrt(x * x) != x) return false;
+    }
+
+    //Largest value whose square is not above 2:
+    const auto root = m::sqrt(f16(2));
+    const auto next = f16::from_raw(root.raw + 1);
+
+    return 
+      root * root <= f16(2) && double(next) * double(next) > 2.0 &&
+      m::sqrt(f16(-1)) == f16(0);
+  });
+
+  test("fixed: sin and cos", []{
+    for (auto i : m::range(0, 200)){
+      const auto angle = -10.0 + i * 0.1;
+      const auto x = f16(angle);
+
+      if (std::abs(double(m::sin(x)) - std::sin(double(x))) > 1e-3) return false;
+      if (std::abs(double(m::cos(x)) - std::cos(double(x))) > 1e-3) return false;
+    }
+
+    return true;
+  });
+
+  test("fixed: vec", []{
+    const auto a = fvec3(1, 2, 2);
+    const auto b = fvec3(f16(0.5), 0, -1);
+
+    return
+      m::dot(a, b) == f16(-1.5) &&
+      m::cross(a, b) == fvec3(-2, f16(2), -1) &&
+      a.len() == f16(3) &&
+      a.normalized() == fvec3(f16::from_raw(65536 / 3), f16::from_raw(2 * 65536 / 3), f16::from_raw(2 * 65536 / 3)) &&
+      a / f16(2) == fvec3(f16(0.5), 1, 1) &&
+      a.xy() == m::vec<f16, 2>(1, 2);
+  });
+
+  test("fixed: widened accumulation", []{
+    //|v|^2 = 120000 does not fit 16 integer bits:
+    const auto v = fvec3(200, 200, 200);
+
+    static_assert(std::is_same_v<decltype(v.len_squared<m::precision::widened>()), m::fixed<48, 16>>);
+
+    return 
+      v.len_squared<m::precision::widened>() == m::fixed<48, 16>(120000) &&
+      std::abs(double(v.len<m::precision::widened>()) - std::sqrt(120000.0)) < 1e-4;
+  });
+
+  test("fixed: mat", []{
+    const auto a = m::mat<f16, 3, 3>(
+      2, 0, 1,
+      1, 3, 2,
+      1, 1, 2
+    );
+
+    const auto t = m::translation(fvec3(1, 2, 3)) * m::scale(fvec3(2, 2, 2));
+    const auto p = t * fvec3(1, f16(-0.5), 0).as_vec<4>(f16(1));
+
+    return
+      a.det() == f16(6) &&
+      a * m::mat<f16, 3, 3>(f16(1)) == a &&
+      p == m::vec<f16, 4>(3, 1, 3, 1);
+  });
+
+  test("fixed: rotation", []{
+    //Same as the float version up to the fixed point precision:
+    const auto r = m::rotation(f16(0.7), fvec3(1, 2, 3));
+    const auto expected = m::rotation(0.7f, m::vec3(1.f, 2.f, 3.f));
+
+    for (auto [x, y] : m::range({ 4, 4 })){
+      if (std::abs(double(r[x][y]) - expected[x][y]) > 1e-3) return false;
+    }
+
+    return true;
+  });
+
+  test("fixed: batched kernels match the scalar code", []{
+    auto random = std::mt19937(11);
+    auto raw = std::uniform_int_distribution<std::int32_t>(-(100 << 16), 100 << 16);
+
+    auto positions = std::vector<fvec3>(1000);
+    auto velocities = std::vector<fvec3>(1000);
+
+    for (auto i : m::range(positions.size())){
+      for (auto n : m::range(3)){
+        positions[i][n] = f16::from_raw(raw(random));
+        velocities[i][n] = f16::from_raw(raw(random) / 16);
+      }
+    }
+
+    const auto dt = f16(1.0 / 60.0);
+    const auto transform = m::translation(fvec3(1, -2, 3)) * m::rotation(f16(0.3), fvec3(1, 1, 0));
+
+    auto expected = positions;
+    for (auto i : m::range(expected.size())){
+      expected[i] += velocities[i] * dt;
+    }
+
+    m::mul_add(positions, velocities, dt);
+    if (positions != expected) return false;
+
+    const auto transformed = m::transform(transform, positions);
+
+    for (auto i : m::range(positions.size())){
+      if (transformed[i] != (transform * positions[i].as_vec<4>(f16(1))).xyz()) return false;
+    }
+
+    return true;
+  });
+
+  test("fixed: deterministic", []{
+    //A fixed sequence of operations has to give the same bits everywhere:
+    auto x = fvec3(f16(0.1), f16(-7.3), f16(12.25));
+    const auto v = fvec3(f16(0.01), f16(0.02), f16(-0.03));
+
+    for (auto i : m::range(1000)){
+      (void)i;
+      x = (x + v * m::sqrt(f16(2))) * f16(0.999);
+    }
+
+    const auto direction = x.normalized();
+
+    return 
+      x.x.raw == 585277 && x.y.raw == 992669 && x.z.raw == -1458695 &&
+      direction.x.raw == 20633 && direction.y.raw == 34995 && direction.z.raw == -51425;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,65 @@
+#define GEFEC_MATH_DEBUG
+#define GEFEC_MATH_EXTERN_TEMPLATES
+#include "../math.hpp"
+#include "test.hpp"
+#include <iomanip>
+
+//The members of the standard aliases come from math.cpp, built here into
+//the same program:
+#include "../math.cpp"
+
+namespace m = gf::math;
+
+template<typename T, std::size_t N>
+auto members_work(){
+  auto v = m::vec<T, N>(T(3));
+  v += m::vec<T, N>(T(1));
+  v *= T(2);
+  v -= T(1);
+
+  auto a = m::mat<T, N, N>(T(2));
+  a.at(0, N - 1) = T(5);
+
+  return
+    v == m::vec<T, N>(T(7)) &&
+    v.len_squared() == T(49 * N) &&
+    a.det() == T(1 << N) &&
+    a.t().at(N - 1, 0) == T(5) &&
+    a.diagonal_product() == T(1 << N) &&
+    !a.is_diagonal();
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("instantiation: float aliases", []{
+    return members_work<float, 2>() && members_work<float, 3>() && members_work<float, 4>();
+  });
+
+  test("instantiation: double aliases", []{
+    return members_work<double, 2>() && members_work<double, 3>() && members_work<double, 4>();
+  });
+
+  test("instantiation: integer aliases", []{
+    return
+      members_work<std::int32_t, 2>() && members_work<std::int32_t, 3>() &&
+      members_work<std::int32_t, 4>();
+  });
+
+  test("instantiation: swizzles are still instantiated where they are used", []{
+    auto v = m::ivec4(1, 2, 3, 4);
+    v.set_xw(v.yz());
+
+    return v.wzyx() == m::ivec4(3, 3, 2, 2) && m::vec2(1.f, 2.f).yx() == m::vec2(2.f, 1.f);
+  });
+
+  test("instantiation: other types are unaffected", []{
+    const auto v = m::vec<float, 5>(1.f);
+    auto a = m::mat<float, 2, 3>();
+    a.at(1, 2) = 1.f;
+
+    return v.len_squared() == 5.f && a.t().at(2, 1) == 1.f;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
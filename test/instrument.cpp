@@ -0,0 +1,173 @@
+#define GEFEC_MATH_DEBUG
+#define GEFEC_MATH_INSTRUMENT
+#include "../math.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace m = gf::math;
+namespace instrument = gf::math::instrument;
+
+using instrument::op;
+
+//Constant evaluation still works, it just isn't counted:
+static_assert(m::dot(m::ivec3(1, 2, 3), m::ivec3(1, 1, 1)) == 6);
+static_assert(m::ivec2(1, 2) * 2 == m::ivec2(2, 4));
+
+static auto handled = 0;
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("instrument: every call of a family is counted", []{
+    instrument::reset();
+
+    const auto a = m::vec3(1.f, 2.f, 3.f);
+    const auto b = m::vec3(4.f, 5.f, 6.f);
+    const auto t = m::translation(a);
+
+    auto v = a + b;
+    v = v - a;
+    v += b;
+    v = v * 2.f;
+    v /= 3.f;
+
+    m::dot(a, b);
+    m::cross(a, b);
+    (t * t).t();
+    t * m::vec4(1.f);
+    m::mat3(2.f).det();
+
+    const auto counts = instrument::thread_counts();
+
+    return
+      counts[op::vec_add] == 3 &&
+      counts[op::vec_multiply] == 1 &&
+      counts[op::vec_divide] == 1 &&
+      counts[op::dot] == 1 &&
+      counts[op::cross] == 1 &&
+      counts[op::transform] == 1 &&
+      counts[op::mat_multiply] == 1 &&
+      counts[op::transpose] == 1 &&
+      counts[op::mat_vec] == 1 &&
+      counts[op::det] == 1 &&
+      counts[op::normalize] == 0;
+  });
+
+  test("instrument: only the outermost call is counted", []{
+    instrument::reset();
+
+    m::vec3(1.f, 2.f, 3.f).normalized();
+    m::rotation_z(1.f);
+
+    const auto counts = instrument::thread_counts();
+
+    //rotation() normalizes its axis, a call of its own:
+    return
+      counts[op::normalize] == 2 &&
+      counts[op::transform] == 1 &&
+      counts[op::length] == 0 &&
+      counts[op::vec_divide] == 0 &&
+      counts[op::transpose] == 0;
+  });
+
+  test("instrument: counters are per thread, totals include finished threads", []{
+    instrument::reset();
+
+    m::dot(m::vec2(1.f), m::vec2(2.f));
+
+    auto worker = std::thread([]{
+      for (auto i = 0; i < 10; ++i){
+        m::dot(m::vec2(1.f), m::vec2(float(i)));
+      }
+    });
+
+    worker.join();
+
+    return
+      instrument::thread_counts()[op::dot] == 1 &&
+      instrument::total_counts()[op::dot] == 11;
+  });
+
+  test("instrument: results aren't checked unless asked to", []{
+    instrument::reset();
+    m::vec3(0.f).normalized();
+
+    return !instrument::first_non_finite() && instrument::thread_counts().non_finite[std::size_t(op::normalize)] == 0;
+  });
+
+  test("instrument: checks count non-finite results and call the handler", []{
+    instrument::reset();
+    instrument::check_finite(true);
+    instrument::on_non_finite([](const instrument::non_finite_event&){ ++handled; });
+
+    m::vec3(1.f).normalized();
+    m::vec3(1.f) / 0.f;
+    m::vec3(1.f) * 2.f;
+    m::vec3(0.f).normalized();
+
+    const auto first = instrument::first_non_finite();
+    const auto counts = instrument::thread_counts();
+
+    instrument::check_finite(false);
+    instrument::on_non_finite(nullptr);
+
+    return
+      first &&
+      first->family == op::vec_divide &&
+      first->checkpoint.line == 0 &&
+      counts.non_finite[std::size_t(op::vec_divide)] == 1 &&
+      counts.non_finite[std::size_t(op::normalize)] == 1 &&
+      counts.non_finite[std::size_t(op::vec_multiply)] == 0 &&
+      handled == 2;
+  });
+
+  test("instrument: non-finite results report the last checkpoint", []{
+    instrument::reset();
+    instrument::check_finite(true);
+
+    instrument::checkpoint("zero length");
+    const auto line = unsigned(__LINE__ - 1);
+
+    m::vec3(1.f).normalized();
+    m::vec3(0.f).normalized();
+
+    const auto first = instrument::first_non_finite();
+    instrument::check_finite(false);
+
+    return
+      first &&
+      first->family == op::normalize &&
+      first->call == 2 &&
+      std::string(first->checkpoint.label) == "zero length" &&
+      first->checkpoint.line == line &&
+      std::string(first->checkpoint.file).find("instrument.cpp") != std::string::npos;
+  });
+
+  test("instrument: report", []{
+    instrument::reset();
+    instrument::checkpoint();
+    instrument::check_finite(true);
+
+    for (auto i = 0; i < 3; ++i){
+      m::mat4(1.f) * m::mat4(2.f);
+    }
+
+    m::dot(m::vec2(1.f), m::vec2(2.f));
+    m::mat2(1.f) / 0.f;
+
+    instrument::check_finite(false);
+
+    auto out = std::stringstream();
+    instrument::report(out);
+    const auto text = out.str();
+
+    return
+      text.find("mat_multiply") < text.find("dot") &&
+      text.find("first non-finite: mat_scale call 1") != std::string::npos &&
+      text.find("normalize") == std::string::npos;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,118 @@
+#define GEFEC_MATH_DEBUG
+#include "../intersect.hpp"
+#include "test.hpp"
+#include <iomanip>
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  namespace m = gf::math;
+
+  const auto a = m::vec3(-1.f, -1.f, 0.f);
+  const auto b = m::vec3(1.f, -1.f, 0.f);
+  const auto c = m::vec3(0.f, 1.f, 0.f);
+
+  test("ray.at", []{
+    const auto r = m::fray{ m::vec3(1.f, 2.f, 3.f), m::vec3(0.f, 0.f, -1.f) };
+    return r.at(2.f) == m::vec3(1.f, 2.f, 1.f);
+  });
+
+  test("ray vs triangle packet", [&]{
+    auto triangles = m::triangle_packet<float, 4>();
+
+    for (auto i : m::range(4)){
+      const auto offset = m::vec3(0.f, 0.f, static_cast<float>(i) + 1.f);
+      triangles.set(i, a + offset, b + offset, c + offset);
+    }
+
+    //Lane 2 is moved out of the ray's way:
+    triangles.set(2, a + 10.f, b + 10.f, c + 10.f);
+
+    const auto r = m::fray{ m::vec3(0.f, 0.f, 10.f), m::vec3(0.f, 0.f, -1.f) };
+    const auto hits = m::intersect(r, triangles);
+
+    return 
+      hits.mask == 0b1011 &&
+      hits.nearest() == 3 &&
+      m::compare(hits.t[3], 6.f) &&
+      m::compare(hits.t[0], 9.f);
+  });
+
+  test("ray vs triangle: barycentrics", [&]{
+    auto triangles = m::triangle_packet<float, 1>();
+    triangles.set(0, a, b, c);
+
+    const auto r = m::fray{ m::vec3(1.f, -1.f, 5.f), m::vec3(0.f, 0.f, -1.f) };
+    const auto hits = m::intersect(r, triangles, 0.f, 100.f);
+
+    return hits.any() && m::compare(hits.u[0], 1.f) && m::compare(hits.v[0], 0.f);
+  });
+
+  test("ray vs triangle: t range", [&]{
+    auto triangles = m::triangle_packet<float, 1>();
+    triangles.set(0, a, b, c);
+
+    const auto r = m::fray{ m::vec3(0.f, 0.f, 5.f), m::vec3(0.f, 0.f, -1.f) };
+
+    return 
+      m::intersect(r, triangles, 0.f, 4.f).mask == 0 &&
+      m::intersect(r, triangles, 6.f, 10.f).mask == 0 &&
+      m::intersect(r, triangles, 4.f, 6.f).mask == 1;
+  });
+
+  test("parallel ray misses triangle", [&]{
+    auto triangles = m::triangle_packet<float, 1>();
+    triangles.set(0, a, b, c);
+
+    const auto r = m::fray{ m::vec3(-5.f, 0.f, 0.f), m::vec3(1.f, 0.f, 0.f) };
+    return !m::intersect(r, triangles).any();
+  });
+
+  test("ray packet vs triangle", [&]{
+    auto rays = m::ray_packet<float, 8>();
+
+    for (auto i : m::range(8)){
+      const auto x = -2.f + static_cast<float>(i) * 0.5f;
+      rays.set(i, m::fray{ m::vec3(x, -0.5f, 1.f), m::vec3(0.f, 0.f, -1.f) });
+    }
+
+    const auto hits = m::intersect(rays, a, b, c);
+
+    //x from -2 to 1.5 in 0.5 steps, the triangle spans [-0.75, 0.75] at y = -0.5:
+    return hits.mask == 0b00111000;
+  });
+
+  test("ray vs box packet", []{
+    auto boxes = m::box_packet<float, 4>();
+
+    boxes.set(0, m::vec3(-1.f, -1.f, -1.f), m::vec3(1.f, 1.f, 1.f));
+    boxes.set(1, m::vec3(2.f, 2.f, 2.f), m::vec3(3.f, 3.f, 3.f));
+    boxes.set(2, m::vec3(-1.f, -1.f, -5.f), m::vec3(1.f, 1.f, -4.f));
+    boxes.set(3, m::vec3(-1.f, -1.f, 20.f), m::vec3(1.f, 1.f, 21.f));
+
+    const auto r = m::fray{ m::vec3(0.f, 0.f, 10.f), m::vec3(0.f, 0.f, -1.f) };
+    const auto hits = m::intersect(r, boxes);
+
+    return 
+      hits.mask == 0b0101 &&
+      hits.nearest() == 0 &&
+      m::compare(hits.t[0], 9.f) &&
+      m::compare(hits.t[2], 14.f);
+  });
+
+  test("ray packet vs box", []{
+    auto rays = m::ray_packet<float, 4>();
+
+    rays.set(0, m::fray{ m::vec3(0.f, 0.f, 5.f), m::vec3(0.f, 0.f, -1.f) });
+    rays.set(1, m::fray{ m::vec3(0.f, 0.f, 5.f), m::vec3(0.f, 0.f, 1.f) });
+    rays.set(2, m::fray{ m::vec3(0.f, 0.f, 0.f), m::vec3(1.f, 1.f, 1.f) });
+    rays.set(3, m::fray{ m::vec3(5.f, 5.f, 5.f), m::vec3(-1.f, 0.f, 0.f) });
+
+    const auto hits = m::intersect(rays, m::vec3(-1.f), m::vec3(1.f));
+
+    //Ray 2 starts inside the box:
+    return hits.mask == 0b0101 && m::compare(hits.t[0], 4.f) && hits.t[2] == 0.f;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
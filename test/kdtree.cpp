@@ -0,0 +1,149 @@
+#define GEFEC_MATH_DEBUG
+#include "../kdtree.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+
+namespace m = gf::math;
+
+template<std::size_t N>
+auto random_points(std::size_t count, unsigned seed){
+  auto random = std::mt19937(seed);
+  auto coordinate = std::uniform_real_distribution<float>(-100.f, 100.f);
+
+  auto points = std::vector<m::vec<float, N>>(count);
+
+  for (auto& point : points){
+    for (auto n : m::range(N)){
+      point[n] = coordinate(random);
+    }
+  }
+
+  return points;
+}
+
+template<std::size_t N>
+auto brute_force(const std::vector<m::vec<float, N>>& points, const m::vec<float, N>& query){
+  auto result = std::vector<m::kd_neighbor<float>>();
+
+  for (auto i : m::range(points.size())){
+    auto distance = 0.f;
+
+    for (auto n : m::range(N)){
+      distance += (points[i][n] - query[n]) * (points[i][n] - query[n]);
+    }
+
+    result.push_back(m::kd_neighbor<float>{ static_cast<std::uint32_t>(i), distance });
+  }
+
+  std::sort(result.begin(), result.end(), [](const auto& a, const auto& b){
+    return a.distance_squared < b.distance_squared;
+  });
+
+  return result;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  const auto points = random_points<3>(5000, 1);
+  const auto queries = random_points<3>(200, 2);
+  const auto tree = m::kd_tree3<float>(points);
+
+  test("kd_tree: empty", []{
+    const auto tree = m::kd_tree2<float>(std::vector<m::vec2>());
+    return !tree.nearest(m::vec2(0.f)).found() && tree.nearest(m::vec2(0.f), 3).empty();
+  });
+
+  test("kd_tree: nearest", [&]{
+    for (const auto& query : queries){
+      if (tree.nearest(query).index != brute_force(points, query)[0].index) return false;
+    }
+
+    return true;
+  });
+
+  test("kd_tree: nearest point is itself", [&]{
+    for (auto i : m::range(100)){
+      const auto n = tree.nearest(points[i]);
+      if (n.index != i || n.distance_squared != 0.f) return false;
+    }
+
+    return true;
+  });
+
+  test("kd_tree: k nearest", [&]{
+    for (const auto& query : queries){
+      const auto expected = brute_force(points, query);
+      const auto found = tree.nearest(query, 8);
+
+      if (found.size() != 8) return false;
+
+      for (auto i : m::range(8)){
+        if (found[i].index != expected[i].index) return false;
+      }
+    }
+
+    return true;
+  });
+
+  test("kd_tree: k larger than the tree", []{
+    const auto tree = m::kd_tree2<float>(random_points<2>(5, 3));
+    return tree.nearest(m::vec2(0.f), 10).size() == 5;
+  });
+
+  test("kd_tree: radius search", [&]{
+    for (const auto& query : queries){
+      const auto expected = brute_force(points, query);
+      auto found = tree.within(query, 20.f);
+
+      const auto count = std::count_if(expected.begin(), expected.end(), [](const auto& n){
+        return n.distance_squared <= 400.f;
+      });
+
+      if (static_cast<std::ptrdiff_t>(found.size()) != count) return false;
+
+      std::sort(found.begin(), found.end(), [](const auto& a, const auto& b){
+        return a.distance_squared < b.distance_squared;
+      });
+
+      for (auto i : m::range(found.size())){
+        if (found[i].index != expected[i].index) return false;
+      }
+    }
+
+    return true;
+  });
+
+  test("kd_tree: batched queries", [&]{
+    const auto nearest = tree.nearest_batch(queries, 4);
+    const auto k_nearest = tree.k_nearest_batch(queries, 3, 4);
+
+    for (auto i : m::range(queries.size())){
+      const auto expected = brute_force(points, queries[i]);
+
+      if (nearest[i].index != expected[0].index) return false;
+
+      for (auto j : m::range(3)){
+        if (k_nearest[i * 3 + j].index != expected[j].index) return false;
+      }
+    }
+
+    return true;
+  });
+
+  test("kd_tree: vec2 with duplicates", []{
+    auto points = random_points<2>(1000, 4);
+    points.insert(points.end(), points.begin(), points.end());
+
+    const auto tree = m::kd_tree2<float>(points, 1);
+    const auto found = tree.nearest(points[10], 2);
+
+    return 
+      found.size() == 2 &&
+      found[0].distance_squared == 0.f &&
+      found[1].distance_squared == 0.f;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
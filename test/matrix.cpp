@@ -93,6 +93,55 @@ auto main() -> int{
     return mat.t().t() == mat;
   });
 
+  test("row and column views", [&]{
+    auto copy = mat;
+    const auto& const_copy = copy;
+
+    const m::vec4 row = const_copy.row_ref(1);
+    const auto sum = copy.row_ref(0) + copy.col_ref(3);
+
+    copy.row_ref(0) = copy.row_ref(3);
+    copy.col_ref(1) *= 2.f;
+    copy.row_ref(2) -= m::vec4(1.f);
+
+    return
+      row == m::vec4(11.f, 13.f, 17.f, 19.f) &&
+      sum == m::vec4(2.f + 7.f, 3.f + 19.f, 5.f + 37.f, 7.f + 53.f) &&
+      copy.row(0) == m::vec4(41.f, 86.f, 47.f, 53.f) &&
+      copy.row_ref(2) == m::vec4(22.f, 57.f, 30.f, 36.f) &&
+      copy.col_ref(1) == m::vec4(86.f, 26.f, 57.f, 86.f) &&
+      m::dot(copy.row_ref(3).eval(), m::vec4(1.f)) == 41.f + 86.f + 47.f + 53.f;
+  });
+
+  test("zero rows and columns", [&]{
+    auto copy = mat;
+    copy.row_ref(2) = m::vec4(0.f);
+
+    return
+      copy.is_any_row_zero() && !copy.is_any_column_zero() &&
+      copy.t().is_any_column_zero() && !mat.is_any_row_zero() &&
+      copy.det() == 0.f;
+  });
+
+  test("transpose view", [&]{
+    auto copy = mat;
+    const auto v = m::vec4(1.f, -2.f, 3.f, 0.5f);
+
+    const m::mat4 transposed = copy.t_ref();
+    const auto product = copy.t_ref() * mat;
+
+    copy.t_ref()[0] = m::vec4(0.f);
+
+    return
+      transposed == mat.t() &&
+      mat.t_ref() == mat.t() &&
+      product == mat.t() * mat &&
+      mat * mat.t_ref() == mat * mat.t() &&
+      mat.t_ref() * v == mat.t() * v &&
+      v * mat.t_ref() == v * mat.t() &&
+      copy.row(0) == m::vec4(0.f);
+  });
+
   test("matrix + matrix", [&]{
     return mat + mat.t() == m::mat4(
       4.f, 14.f, 28.f, 48.f,
@@ -170,6 +219,13 @@ auto main() -> int{
     return m::compare<float>(rotation, m::vec4(1.0, 0.0, 0.0, 1.0));
   });
 
+  test("rotation is orthonormal", []{
+    const auto r = m::rotation(0.7f, m::vec3(1.f, 2.f, -1.f));
+    const auto error = (r.t() * r - m::mat4(1.f)).map([](float e){ return m::abs(e); });
+
+    return error.every([](float e){ return e < 1e-6f; });
+  });
+
   mat = m::mat4(
     1.f, 0.f, 0.f, 0.f,
     1.f, 1.f, 0.f, 0.f,
@@ -265,5 +321,88 @@ auto main() -> int{
       mat8.det() == 0.0;
   });
 
+  test("row-major layout", [&]{
+    using row_mat4 = m::mat<float, 4, 4, m::layout::row_major>;
+
+    const auto rows = row_mat4(mat);
+    const auto other = row_mat4(mat.t() + 1.f);
+    const auto v = m::vec4(1.f, -2.f, 3.f, 0.5f);
+
+    //Rows are contiguous, in the order of the constructor arguments:
+    float raw[16];
+    std::memcpy(raw, rows.data, sizeof(raw));
+
+    auto copy = rows;
+    copy[1][2] = 0.f;
+    copy.row_ref(3) *= 2.f;
+
+    return
+      sizeof(row_mat4) == sizeof(m::mat4) &&
+      raw[1] == mat[1][0] && raw[4] == mat[0][1] && raw[14] == mat[2][3] &&
+      rows[3][1] == mat[3][1] && rows.row(2) == mat.row(2) &&
+      m::mat4(rows * other) == mat * (mat.t() + 1.f) &&
+      m::mat4(rows * mat) == mat * mat &&
+      rows * v == mat * v && v * rows == v * mat &&
+      m::mat4(rows.t()) == mat.t() &&
+      m::mat4(rows.t_ref() * other) == m::mat4(rows).t() * m::mat4(other) &&
+      rows.det() == mat.det() &&
+      copy.at(1, 2) == 0.f && copy.row(3) == mat.row(3) * 2.f;
+  });
+
+  test("in-place matrix products", [&]{
+    const auto b = mat.t() + 1.f;
+    auto product = mat;
+    auto squared = mat;
+    auto quotient = mat;
+    auto rows = m::mat<float, 4, 4, m::layout::row_major>(mat);
+    auto wide = m::mat<float, 4, 2>(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+
+    product *= b;
+    squared *= squared;
+    quotient /= b;
+    rows *= b;
+    wide *= mat;
+
+    return
+      product == mat * b &&
+      squared == mat * mat &&
+      quotient == mat / b &&
+      m::mat4(rows) == mat * b &&
+      wide == m::mat<float, 4, 2>(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f) * mat;
+  });
+
+  test("product chain order", []{
+    //Matrices ending in a vector are evaluated right to left:
+    using chain = m::product_chain<m::mat4, m::mat4, m::mat4, m::vec4>;
+    static_assert(chain::Order.split[0][3] == 0 && chain::Order.split[1][3] == 1);
+    static_assert(chain::Order.total_cost() == 3 * 16);
+
+    //10x30 * 30x5 * 5x60 is cheapest as (AB)C:
+    using mixed = m::product_chain<m::mat<int, 30, 10>, m::mat<int, 5, 30>, m::mat<int, 60, 5>>;
+    static_assert(mixed::Order.split[0][2] == 1 && mixed::Order.total_cost() == 4500);
+
+    return true;
+  });
+
+  test("product chain results", []{
+    const auto a = m::imat4(
+      1, 2, 3, 4,
+      5, 6, 7, 8,
+      9, 1, 2, 3,
+      4, 5, 6, 7
+    );
+    const auto b = a.t() - 2;
+    const auto v = m::ivec4(1, -2, 3, 4);
+
+    const m::ivec4 converted = m::chain(a) * b * a * v;
+
+    return
+      converted == a * b * a * v &&
+      m::chain(a, b, a).eval() == a * b * a &&
+      m::chain(v, a, b).eval() == v * a * b &&
+      m::chain(v, a, v).eval() == m::dot(v * a, v) &&
+      m::chain(a).eval() == a;
+  });
+
   std::cout << "ALL TESTS PASSED\n";
 }
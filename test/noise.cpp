@@ -0,0 +1,195 @@
+#define GEFEC_MATH_DEBUG
+#include "../noise.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace m = gf::math;
+
+template<typename Callable>
+auto every_isa(Callable callable){
+  auto result = true;
+
+  for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+    if (m::force_isa(level) != level) continue;
+    result = result && callable();
+  }
+
+  m::force_isa(m::supported_isa());
+  return result;
+}
+
+template<typename T, std::size_t N>
+auto points(std::size_t count, T min, T max){
+  auto random = std::mt19937(11);
+  auto coordinate = std::uniform_real_distribution<T>(min, max);
+  auto result = std::vector<m::vec<T, N>>(count);
+
+  for (auto& p : result){
+    for (auto i : m::range(N)){
+      p[i] = coordinate(random);
+    }
+  }
+
+  return result;
+}
+
+//Every value in [-1, 1], and some of them far from 0:
+template<typename T, std::size_t N, typename Noise>
+auto bounded(Noise noise){
+  auto largest = T(0);
+
+  for (const auto& p : points<T, N>(20000, T(-100), T(100))){
+    const auto value = noise(p, 0u);
+    if (!(std::abs(value) <= T(1))) return false;
+    largest = std::max(largest, std::abs(value));
+  }
+
+  return largest > T(0.4);
+}
+
+//No steps: a small move changes the value by at most a small multiple of it:
+template<std::size_t N, typename Noise>
+auto continuous(Noise noise){
+  constexpr auto Step = 1e-5;
+
+  for (const auto& p : points<double, N>(20000, -20.0, 20.0)){
+    for (auto i : m::range(N)){
+      auto q = p;
+      q[i] += Step;
+      if (std::abs(noise(q, 0u) - noise(p, 0u)) > 10.0 * Step) return false;
+    }
+  }
+
+  return true;
+}
+
+//A grid against fbm() of its sample positions, at every level and thread count:
+template<std::size_t N, typename Noise>
+auto grid_matches(Noise noise, const m::fbm_settings<float>& settings){
+  constexpr auto Width = std::size_t(150);
+  constexpr auto Height = std::size_t(70);
+  constexpr auto Spacing = 0.173f;
+
+  auto origin = m::vec<float, N>();
+
+  for (auto i : m::range(N)){
+    origin[i] = 3.5f - 2.f * float(i);
+  }
+
+  auto expected = std::vector<float>(Width * Height);
+
+  for (auto [x, y] : m::range({ Width, Height })){
+    auto offset = m::vec<float, N>();
+    offset[0] = float(x);
+    offset[1] = float(y);
+    expected[y * Width + x] = m::fbm(noise, origin + offset * Spacing, settings);
+  }
+
+  return every_isa([&]{
+    for (auto threads : { 1, 3 }){
+      auto result = std::vector<float>(Width * Height, 7.f);
+      m::noise_grid(noise, origin, Spacing, Width, Height, result.data(), settings, threads);
+
+      for (auto i : m::range(result.size())){
+        //FMA contractions in the vectorized levels move the positions, up
+        //to 26, by an ULP:
+        if (std::abs(result[i] - expected[i]) > 1e-4f) return false;
+      }
+    }
+
+    return true;
+  });
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  const auto perlin = m::perlin_noise();
+  const auto simplex = m::simplex_noise();
+
+  test("noise: perlin is 0 at lattice points", []{
+    return
+      m::perlin(m::vec2(3.f, -7.f)) == 0.f &&
+      m::perlin(m::dvec3(0.0, 1.0, -100.0), 5) == 0.0 &&
+      m::perlin(m::vec4(1.f, 2.f, 3.f, 4.f)) == 0.f &&
+      m::perlin(m::vec2(3.5f, -7.25f)) != 0.f;
+  });
+
+  test("noise: values are within [-1, 1]", [&]{
+    return
+      bounded<float, 2>(perlin) &&
+      bounded<float, 3>(perlin) &&
+      bounded<double, 4>(perlin) &&
+      bounded<float, 2>(simplex) &&
+      bounded<double, 3>(simplex) &&
+      bounded<float, 4>(simplex);
+  });
+
+  test("noise: noise is continuous", [&]{
+    return
+      continuous<2>(perlin) &&
+      continuous<3>(perlin) &&
+      continuous<4>(perlin) &&
+      continuous<2>(simplex) &&
+      continuous<3>(simplex) &&
+      continuous<4>(simplex);
+  });
+
+  test("noise: seeds", []{
+    const auto p = m::vec3(1.3f, -2.7f, 0.4f);
+
+    return
+      m::simplex(p, 1) == m::simplex(p, 1) &&
+      m::simplex(p, 1) != m::simplex(p, 2) &&
+      m::perlin(p, 1) != m::perlin(p, 2) &&
+      m::perlin(p) == m::perlin(p, 0);
+  });
+
+  test("noise: float and double agree", []{
+    for (const auto& p : points<double, 3>(1000, -5.0, 5.0)){
+      const auto q = m::vec3(p);
+
+      if (std::abs(m::simplex(q) - float(m::simplex(m::dvec3(q)))) > 1e-5f) return false;
+      if (std::abs(m::perlin(q) - float(m::perlin(m::dvec3(q)))) > 1e-5f) return false;
+    }
+
+    return true;
+  });
+
+  test("noise: noise is centred on 0", []{
+    auto sum = 0.0;
+    const auto samples = points<float, 2>(100000, -1000.f, 1000.f);
+
+    for (const auto& p : samples){
+      sum += m::simplex(p) + m::perlin(p);
+    }
+
+    return std::abs(sum / double(samples.size())) < 0.01;
+  });
+
+  test("noise: fbm sums octaves, normalized", [&]{
+    const auto p = m::vec2(0.37f, 5.1f);
+    const auto two = m::fbm_settings<float>{ 2, 3.f, 0.25f, 7 };
+
+    return
+      m::fbm(perlin, p, { 1 }) == m::perlin(p) &&
+      std::abs(m::fbm(simplex, p, two) - (m::simplex(p, 7) + 0.25f * m::simplex(p * 3.f, 8)) / 1.25f) < 1e-6f &&
+      bounded<float, 3>([](const auto& q, auto){ return m::fbm(m::simplex_noise(), q); });
+  });
+
+  test("noise: grids match fbm at every level", [&]{
+    const auto octaves = m::fbm_settings<float>{ 3, 2.1f, 0.6f, 4 };
+
+    return
+      grid_matches<2>(perlin, { 1 }) &&
+      grid_matches<2>(simplex, octaves) &&
+      grid_matches<3>(perlin, octaves) &&
+      grid_matches<3>(simplex, { 1 }) &&
+      grid_matches<4>(perlin, { 1 }) &&
+      grid_matches<4>(simplex, octaves);
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
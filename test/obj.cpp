@@ -0,0 +1,121 @@
+#define GEFEC_MATH_DEBUG
+#include "../obj.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+
+namespace m = gf::math;
+
+//Grid of quads, large enough to be split into many chunks:
+auto grid_obj(int size, bool relative){
+  auto text = std::string("# grid\no grid\n");
+
+  for (auto [x, y] : m::range({ size + 1, size + 1 })){
+    text += "v " + std::to_string(x) + ' ' + std::to_string(y) + " 0\n";
+  }
+
+  text += "vn 0 0 1\n";
+
+  for (auto [x, y] : m::range({ size, size })){
+    const auto corner = [&](int dx, int dy){
+      const auto index = int((y + dy) * (size + 1) + (x + dx) + 1);
+      const auto position = relative ? index - (size + 1) * (size + 1) - 1 : index;
+      return std::to_string(position) + (relative ? "//-1" : "//1");
+    };
+
+    text += "f " + corner(0, 0) + ' ' + corner(1, 0) + ' ' + corner(1, 1) + ' ' + corner(0, 1) + '\n';
+  }
+
+  return text;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("obj: triangle and quad", []{
+    const auto text =
+      "# comment\n"
+      "v 0 0 0\n"
+      "v 1 0 0 1\n"
+      "v 1 1 0\r\n"
+      "v 0 1 0\n"
+      "vt 0 0\n"
+      "vn 0 0 1\n"
+      "g quad\n"
+      "usemtl none\n"
+      "f 1/1/1 2/1/1 3/1/1\n"
+      "f -4 -3 -2 -1 # quad\n";
+
+    auto mesh = m::mesh();
+
+    return
+      m::parse_obj(text, mesh) &&
+      mesh.positions.size() == 4 &&
+      mesh.positions[1] == m::vec3(1.f, 0.f, 0.f) &&
+      mesh.normals.size() == 1 &&
+      mesh.triangle_count() == 3 &&
+      mesh.indices == std::vector<std::uint32_t>{ 0, 1, 2, 0, 1, 2, 0, 2, 3 } &&
+      mesh.normal_indices.empty();
+  });
+
+  test("obj: normal indices", []{
+    auto mesh = m::mesh();
+
+    return
+      m::parse_obj("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nvn 0 0 -1\nf 1//2 2//2 3//1\n", mesh) &&
+      mesh.normal_indices == std::vector<std::uint32_t>{ 1, 1, 0 } &&
+      mesh.triangle(0)[2] == m::vec3(0.f, 1.f, 0.f);
+  });
+
+  test("obj: malformed files", []{
+    auto mesh = m::mesh();
+
+    return
+      !m::parse_obj("v 0 0\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 2\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 0\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 -2\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 1x\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 4294967297\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nf 1 1 -4294967297\n", mesh) &&
+      !m::parse_obj("v 0 0 0\nvn 0 0 1\nf 1//1 1//1 1//4294967297\n", mesh) &&
+      mesh.positions.empty();
+  });
+
+  test("obj: parallel chunks give the serial result", []{
+    for (auto relative : { false, true }){
+      const auto text = grid_obj(300, relative);
+
+      auto serial = m::mesh();
+      auto parallel = m::mesh();
+
+      if (!m::parse_obj(text, serial, 1) || !m::parse_obj(text, parallel, 8)) return false;
+
+      if (serial.triangle_count() != 300 * 300 * 2) return false;
+      if (serial.positions != parallel.positions || serial.indices != parallel.indices) return false;
+      if (parallel.normal_indices != std::vector<std::uint32_t>(parallel.indices.size(), 0)) return false;
+
+      const auto last = parallel.triangle(parallel.triangle_count() - 1);
+      if (last[2] != m::vec3(299.f, 300.f, 0.f)) return false;
+    }
+
+    return true;
+  });
+
+  test("obj: load_obj", []{
+    const auto path = (std::filesystem::temp_directory_path() / "gf_math_grid.obj").string();
+    std::ofstream(path) << grid_obj(10, false);
+
+    auto mesh = m::mesh();
+    const auto loaded = m::load_obj(path.c_str(), mesh);
+    std::filesystem::remove(path);
+
+    return
+      loaded && mesh.triangle_count() == 200 &&
+      !m::load_obj("this file does not exist", mesh);
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
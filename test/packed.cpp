@@ -0,0 +1,181 @@
+#define GEFEC_MATH_DEBUG
+#include "../packed.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+
+namespace m = gf::math;
+
+//The half is one of the two nearest halves, ties go to the even one:
+auto is_nearest_half(float value, m::half h){
+  const auto below = float(m::half::from_bits(h.bits - 1));
+  const auto above = float(m::half::from_bits(h.bits + 1));
+  const auto error = std::abs(float(h) - value);
+
+  if (std::abs(below - value) < error || std::abs(above - value) < error) return false;
+
+  const auto tie = std::abs(below - value) == error || std::abs(above - value) == error;
+  return !tie || (h.bits & 1) == 0;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  static_assert(sizeof(m::hvec3) == 6);
+  static_assert(sizeof(m::vec<m::unorm8, 4>) == 4);
+  static_assert(sizeof(m::vec<m::snorm16, 2>) == 4);
+  static_assert(sizeof(m::rgb10a2) == 4);
+
+  test("half: every value round trips", []{
+    for (auto bits = 0u; bits <= 0xffffu; ++bits){
+      const auto h = m::half::from_bits(static_cast<std::uint16_t>(bits));
+      const auto f = float(h);
+
+      if (std::isnan(f)){
+        if (!std::isnan(float(m::half(f)))) return false;
+        continue;
+      }
+
+      if (m::half(f).bits != bits) return false;
+    }
+
+    return true;
+  });
+
+  test("half: special values", []{
+    const auto inf = std::numeric_limits<float>::infinity();
+
+    return
+      m::half(0.f).bits == 0 &&
+      m::half(-0.f).bits == 0x8000 &&
+      m::half(1.f).bits == 0x3c00 &&
+      m::half(-2.f).bits == 0xc000 &&
+      m::half(65504.f).bits == 0x7bff &&
+      m::half(65520.f).bits == 0x7c00 &&
+      m::half(inf).bits == 0x7c00 &&
+      m::half(-inf).bits == 0xfc00 &&
+      std::isnan(float(m::half(std::nanf("")))) &&
+      m::half(1e-10f).bits == 0 &&
+      float(m::half::from_bits(1)) == std::ldexp(1.f, -24);
+  });
+
+  test("half: rounds to nearest even", []{
+    auto random = std::mt19937(5);
+    auto exponent = std::uniform_int_distribution<int>(-24, 15);
+    auto mantissa = std::uniform_real_distribution<float>(1.f, 2.f);
+
+    for (auto i : m::range(100000)){
+      (void)i;
+      const auto value = std::ldexp(mantissa(random), exponent(random));
+      if (!is_nearest_half(value, m::half(value))) return false;
+    }
+
+    //Exactly halfway between 1 and the next half:
+    return m::half(1.f + std::ldexp(1.f, -11)).bits == 0x3c00;
+  });
+
+  test("half: vec arithmetic promotes to float", []{
+    const auto a = m::hvec3(1.f, 2.f, 3.f);
+    const auto b = m::hvec3(0.5f, 0.5f, 0.5f);
+    const auto sum = a + b;
+
+    static_assert(std::is_same_v<std::decay_t<decltype(sum)>, m::vec3>);
+    return sum == m::vec3(1.5f, 2.5f, 3.5f);
+  });
+
+  test("half: vec arithmetic with floats, dot and lengths", []{
+    const auto h = m::hvec3(2.f, 3.f, 6.f);
+    const auto f = m::vec3(1.f, 0.5f, 0.25f);
+
+    const auto with_vec = h + f;
+    const auto difference = h - m::hvec3(1.f, 1.f, 1.f);
+    const auto scaled = h * 2.f;
+    const auto divided = 12.f / h;
+    const auto length = h.len();
+
+    static_assert(std::is_same_v<std::decay_t<decltype(with_vec)>, m::vec3>);
+    static_assert(std::is_same_v<std::decay_t<decltype(difference)>, m::vec3>);
+    static_assert(std::is_same_v<std::decay_t<decltype(scaled)>, m::vec3>);
+    static_assert(std::is_same_v<std::decay_t<decltype(m::dot(h, h))>, float>);
+    static_assert(std::is_same_v<std::decay_t<decltype(length)>, float>);
+
+    return
+      with_vec == m::vec3(3.f, 3.5f, 6.25f) &&
+      f - h == -with_vec + 2.f * f &&
+      difference == m::vec3(1.f, 2.f, 5.f) &&
+      scaled == m::vec3(4.f, 6.f, 12.f) &&
+      2.f * h == scaled &&
+      h / 2.f == m::vec3(1.f, 1.5f, 3.f) &&
+      divided == m::vec3(6.f, 4.f, 2.f) &&
+      m::to_float(h) == m::vec3(2.f, 3.f, 6.f) &&
+      m::dot(h, h) == 49.f &&
+      length == 7.f &&
+      m::to_float(h.normalized()) == m::vec3(m::half(2.f / 7.f), m::half(3.f / 7.f), m::half(6.f / 7.f));
+  });
+
+  test("unorm and snorm", []{
+    return
+      m::unorm8(0.f).bits == 0 && m::unorm8(1.f).bits == 255 && m::unorm8(2.f).bits == 255 &&
+      m::unorm8(0.5f).bits == 128 &&
+      float(m::unorm8(1.f)) == 1.f &&
+      m::snorm16(-1.f).bits == -32767 && m::snorm16(1.f).bits == 32767 &&
+      float(m::snorm16(-1.f)) == -1.f &&
+      float(m::snorm8(m::snorm8(0.f))) == 0.f &&
+      std::abs(float(m::snorm16(0.3f)) - 0.3f) < 1.f / 32767.f;
+  });
+
+  test("rgb10a2", []{
+    const auto v = m::vec4(0.f, 0.5f, 1.f, 1.f / 3.f);
+    const auto packed = m::rgb10a2(v);
+    const auto unpacked = packed.unpack();
+
+    return
+      packed.bits == ((1u << 30) | (1023u << 20) | (512u << 10)) &&
+      m::all(m::nearly_equal(unpacked, v, 0.5f / 1023.f));
+  });
+
+  test("octahedral normals", []{
+    auto random = std::mt19937(9);
+    auto coordinate = std::uniform_real_distribution<float>(-1.f, 1.f);
+
+    auto normals = std::vector<m::vec3>{
+      m::vec3(0.f, 0.f, 1.f), m::vec3(0.f, 0.f, -1.f), m::vec3(1.f, 0.f, 0.f), m::vec3(0.f, -1.f, 0.f)
+    };
+
+    for (auto i : m::range(10000)){
+      (void)i;
+      normals.push_back(m::vec3(coordinate(random), coordinate(random), coordinate(random)).normalized());
+    }
+
+    const auto unpacked = m::unpack_normals(m::pack_normals(normals));
+
+    for (auto i : m::range(normals.size())){
+      if (m::dot(unpacked[i], normals[i]) < 0.99999f) return false;
+      if (std::abs(unpacked[i].len() - 1.f) > 1e-5f) return false;
+    }
+
+    return true;
+  });
+
+  test("bulk pack and unpack", []{
+    auto colors = std::vector<m::vec4>();
+
+    for (auto i : m::range(256)){
+      colors.push_back(m::vec4(i / 255.f));
+    }
+
+    const auto halves = m::unpack(m::pack<m::half>(colors));
+    const auto bytes = m::unpack(m::pack<m::unorm8>(colors));
+    const auto wide = m::unpack(m::pack_rgb10a2(colors));
+
+    for (auto i : m::range(colors.size())){
+      if (!m::all(m::nearly_equal(halves[i], colors[i], 1e-3f))) return false;
+      if (bytes[i] != colors[i]) return false;
+      if (!m::all(m::nearly_equal(wide[i], colors[i], 0.17f))) return false;
+    }
+
+    return true;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
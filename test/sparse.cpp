@@ -0,0 +1,191 @@
+#define GEFEC_MATH_DEBUG
+#include "../sparse.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+
+namespace m = gf::math;
+
+//Stiffness-like matrix of a chain of n nodes with 3x3 blocks: every node is
+//tied to its neighbors by a random symmetric positive definite spring block.
+auto chain_matrix(std::size_t n){
+  auto random = std::mt19937(11);
+  auto element = std::uniform_real_distribution<double>(-1.0, 1.0);
+  auto triplets = std::vector<m::sparse_triplet<m::dmat3>>();
+
+  for (auto i : m::range(n - 1)){
+    auto g = m::dmat3();
+
+    for (auto [x, y] : m::range({ 3, 3 })){
+      g[x][y] = element(random);
+    }
+
+    const auto k = g * g.t() + m::dmat3(1.0);
+    const auto a = static_cast<std::uint32_t>(i);
+    const auto b = static_cast<std::uint32_t>(i + 1);
+
+    triplets.push_back({ a, a, k });
+    triplets.push_back({ b, b, k });
+    triplets.push_back({ a, b, -1.0 * k });
+    triplets.push_back({ b, a, -1.0 * k });
+  }
+
+  //Anchors the first node so the system is not singular:
+  triplets.push_back({ 0, 0, m::dmat3(1.0) });
+
+  return m::bsr_matrix<double, 3>(n, n, triplets);
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("csr: assembly sums duplicates and sorts columns", []{
+    const auto a = m::csr_matrix<float>(3, 4, {
+      { 2, 3, 1.f },
+      { 0, 2, 2.f },
+      { 0, 0, 3.f },
+      { 2, 3, 4.f },
+      { 0, 2, 5.f },
+    });
+
+    return
+      a.nonzeros() == 3 &&
+      a.row_offsets == std::vector<std::uint32_t>{ 0, 2, 2, 3 } &&
+      a.column_indices == std::vector<std::uint32_t>{ 0, 2, 3 } &&
+      a(0, 2) == 7.f && a(2, 3) == 5.f && a(1, 1) == 0.f;
+  });
+
+  test("csr: triplets outside the matrix are rejected", []{
+    const auto row = m::csr_matrix<float>(2, 3, { { 0, 0, 1.f }, { 2, 0, 1.f } });
+    const auto column = m::csr_matrix<float>(2, 3, { { 1, 3, 1.f } });
+
+    return
+      row.rows == 0 && row.columns == 0 && row.nonzeros() == 0 &&
+      row.row_offsets == std::vector<std::uint32_t>{ 0 } &&
+      column.rows == 0 && column.nonzeros() == 0;
+  });
+
+  test("csr: multiply", []{
+    const auto a = m::csr_matrix<float>(2, 3, {
+      { 0, 0, 1.f }, { 0, 2, 2.f },
+      { 1, 1, 3.f }, { 1, 2, -1.f },
+    });
+    const auto y = a * std::vector<float>{ 1.f, 2.f, 3.f };
+
+    return y == std::vector<float>{ 7.f, 3.f };
+  });
+
+  test("bsr: multiply matches dense blocks", []{
+    const auto a = chain_matrix(50);
+    auto x = std::vector<m::dvec3>(50);
+
+    for (auto i : m::range(x.size())){
+      x[i] = m::dvec3(double(i), 1.0, -double(i) / 2);
+    }
+
+    const auto y = a * x;
+
+    for (auto r : m::range(a.rows)){
+      auto expected = m::dvec3();
+
+      for (auto c : m::range(a.columns)){
+        expected += a(r, c) * x[c];
+      }
+
+      if (!m::compare(y[r], expected, 1e-12)) return false;
+    }
+
+    return true;
+  });
+
+  test("bsr: row-major blocks multiply the same", []{
+    const auto a = chain_matrix(20);
+    auto triplets = std::vector<m::sparse_triplet<m::mat<double, 3, 3, m::layout::row_major>>>();
+
+    for (auto r : m::range(a.rows)){
+      for (auto i : m::range(a.row_offsets[r], a.row_offsets[r + 1])){
+        triplets.push_back({
+          static_cast<std::uint32_t>(r),
+          a.column_indices[i],
+          m::mat<double, 3, 3, m::layout::row_major>(a.values[i])
+        });
+      }
+    }
+
+    const auto b = m::sparse_matrix<m::mat<double, 3, 3, m::layout::row_major>>(a.rows, a.columns, triplets);
+    const auto x = std::vector<m::dvec3>(a.columns, m::dvec3(1.0, -2.0, 0.5));
+
+    return a * x == b * x;
+  });
+
+  test("pcg: solves scalar and block systems", []{
+    //1D Laplacian with Dirichlet ends:
+    const auto n = std::size_t(100);
+    auto triplets = std::vector<m::sparse_triplet<double>>();
+
+    for (auto i : m::range(n)){
+      const auto row = static_cast<std::uint32_t>(i);
+
+      triplets.push_back({ row, row, 2.0 });
+      if (i > 0) triplets.push_back({ row, row - 1, -1.0 });
+      if (i + 1 < n) triplets.push_back({ row, row + 1, -1.0 });
+    }
+
+    const auto laplacian = m::csr_matrix<double>(n, n, triplets);
+    const auto ones = std::vector<double>(n, 1.0);
+    auto x = std::vector<double>();
+
+    const auto scalar = m::pcg(laplacian, ones, x, { 1000, 1e-10 });
+    const auto residual = laplacian * x;
+
+    for (auto i : m::range(n)){
+      if (m::abs(residual[i] - 1.0) > 1e-7) return false;
+    }
+
+    const auto a = chain_matrix(200);
+    auto expected = std::vector<m::dvec3>(a.rows);
+
+    for (auto i : m::range(expected.size())){
+      expected[i] = m::dvec3(std::sin(double(i)), 1.0, double(i % 7));
+    }
+
+    const auto b = a * expected;
+    auto solution = std::vector<m::dvec3>();
+    const auto block = m::pcg(a, b, solution, { 5000, 1e-12 });
+
+    for (auto i : m::range(expected.size())){
+      if (!m::compare(solution[i], expected[i], 1e-6)) return false;
+    }
+
+    return scalar.converged && scalar.iterations <= n && block.converged && block.residual <= 1e-12;
+  });
+
+  test("pcg: threads give the same answer", []{
+    const auto a = chain_matrix(20000);
+    const auto b = std::vector<m::dvec3>(a.rows, m::dvec3(1.0, 0.0, -1.0));
+
+    auto single = std::vector<m::dvec3>();
+    auto threaded = std::vector<m::dvec3>();
+
+    const auto r1 = m::pcg(a, b, single, { 50, 0.0 }, 1);
+    const auto r4 = m::pcg(a, b, threaded, { 50, 0.0 }, 4);
+
+    for (auto i : m::range(a.rows)){
+      if (!m::compare(single[i], threaded[i], 1e-6)) return false;
+    }
+
+    return
+      r1.iterations == 50 && r4.iterations == 50 && !r1.converged &&
+      m::abs(r1.residual - r4.residual) < 1e-6 * r1.residual;
+  });
+
+  test("pcg: zero right hand side", []{
+    const auto a = chain_matrix(10);
+    auto x = std::vector<m::dvec3>();
+    const auto result = m::pcg(a, std::vector<m::dvec3>(a.rows), x);
+
+    return result.converged && result.iterations == 0 && x == std::vector<m::dvec3>(a.rows);
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,164 @@
+#define GEFEC_MATH_DEBUG
+#include "../spatial_hash.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+namespace m = gf::math;
+
+auto random_points(std::size_t count, unsigned seed){
+  auto random = std::mt19937(seed);
+  auto coordinate = std::uniform_real_distribution<float>(-50.f, 50.f);
+
+  auto points = std::vector<m::vec3>(count);
+
+  for (auto& point : points){
+    point = m::vec3(coordinate(random), coordinate(random), coordinate(random));
+  }
+
+  return points;
+}
+
+auto brute_force(const std::vector<m::vec3>& points, const m::vec3& center, float radius){
+  auto result = std::vector<std::uint32_t>();
+
+  for (auto i : m::range(points.size())){
+    if (m::distance_squared(points[i], center) <= radius * radius){
+      result.push_back(static_cast<std::uint32_t>(i));
+    }
+  }
+
+  return result;
+}
+
+auto collect(const m::spatial_hash3<float>& grid, const m::vec3& center, float radius){
+  auto result = std::vector<std::uint32_t>();
+  grid.query(center, radius, [&](std::uint32_t object, const m::vec3&){ result.push_back(object); });
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  const auto points = random_points(5000, 1);
+  const auto queries = random_points(100, 2);
+
+  test("hash: vec as unordered_map key", []{
+    auto map = std::unordered_map<m::ivec3, int>();
+    map[m::ivec3(1, 2, 3)] = 1;
+    map[m::ivec3(3, 2, 1)] = 2;
+    map[m::ivec3(1, 2, 3)] += 10;
+
+    return map.size() == 2 && map[m::ivec3(1, 2, 3)] == 11 && map[m::ivec3(3, 2, 1)] == 2;
+  });
+
+  test("hash: negative zero", []{
+    const auto hash = std::hash<m::vec2>();
+    return hash(m::vec2(-0.f, 1.f)) == hash(m::vec2(0.f, 1.f));
+  });
+
+  test("hash: component order matters", []{
+    const auto hash = std::hash<m::ivec2>();
+    return hash(m::ivec2(1, 2)) != hash(m::ivec2(2, 1));
+  });
+
+  test("spatial_hash: cell of negative positions", []{
+    const auto grid = m::spatial_hash2<float>(2.f);
+    return grid.cell_of(m::vec2(-0.5f, 3.f)) == m::ivec2(-1, 1);
+  });
+
+  test("spatial_hash: rebuild and radius query", [&]{
+    auto grid = m::spatial_hash3<float>(4.f);
+    grid.rebuild(points);
+
+    if (grid.size() != points.size()) return false;
+
+    for (const auto& query : queries){
+      if (collect(grid, query, 6.f) != brute_force(points, query, 6.f)) return false;
+    }
+
+    return true;
+  });
+
+  test("spatial_hash: cell query", [&]{
+    auto grid = m::spatial_hash3<float>(8.f);
+    grid.rebuild(points);
+
+    const auto cell = grid.cell_of(points[0]);
+    auto found = 0;
+    auto all_inside = true;
+
+    grid.query(cell, [&](std::uint32_t, const m::vec3& position){
+      ++found;
+      all_inside = all_inside && grid.cell_of(position) == cell;
+    });
+
+    const auto expected = std::count_if(points.begin(), points.end(), [&](const auto& p){
+      return grid.cell_of(p) == cell;
+    });
+
+    return all_inside && found == expected;
+  });
+
+  test("spatial_hash: insert and remove", [&]{
+    auto grid = m::spatial_hash3<float>(4.f);
+
+    for (auto i : m::range(points.size())){
+      grid.insert(static_cast<std::uint32_t>(i), points[i]);
+    }
+
+    //Removes every other point, then checks queries against the remaining ones:
+    for (auto i = std::size_t(0); i < points.size(); i += 2){
+      if (!grid.remove(static_cast<std::uint32_t>(i), points[i])) return false;
+    }
+
+    if (grid.remove(0, points[0])) return false;
+    if (grid.size() != points.size() / 2) return false;
+
+    for (const auto& query : queries){
+      auto expected = brute_force(points, query, 6.f);
+      expected.erase(
+        std::remove_if(expected.begin(), expected.end(), [](std::uint32_t i){ return i % 2 == 0; }),
+        expected.end()
+      );
+
+      if (collect(grid, query, 6.f) != expected) return false;
+    }
+
+    return true;
+  });
+
+  test("spatial_hash: removing everything frees the cells", [&]{
+    auto grid = m::spatial_hash3<float>(1.f);
+    grid.rebuild(points);
+
+    for (auto i : m::range(points.size())){
+      grid.remove(static_cast<std::uint32_t>(i), points[i]);
+    }
+
+    return grid.size() == 0 && grid.cell_count() == 0 && collect(grid, m::vec3(0.f), 100.f).empty();
+  });
+
+  test("spatial_hash: repeated rebuilds", [&]{
+    auto grid = m::spatial_hash3<float>(4.f);
+    auto moving = points;
+
+    for (auto frame : m::range(3)){
+      for (auto& p : moving){
+        p.x += 1.f + frame;
+      }
+
+      grid.rebuild(moving);
+
+      if (collect(grid, queries[frame], 8.f) != brute_force(moving, queries[frame], 8.f)) return false;
+    }
+
+    return true;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
@@ -0,0 +1,101 @@
+#define GEFEC_MATH_DEBUG
+#include "../text.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <random>
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  namespace m = gf::math;
+
+  test("text: vec formatting", []{
+    return
+      m::to_string(m::vec3(1.f, -0.5f, 100.f)) == "1 -0.5 100" &&
+      m::to_string(m::ivec2(-7, 42)) == "-7 42" &&
+      m::to_string(m::vec2(0.1f, 1e-20f)) == "0.1 1e-20";
+  });
+
+  test("text: mat formatting is row by row", []{
+    const auto mat = m::mat2(
+      1.f, 2.f,
+      3.f, 4.f
+    );
+
+    return m::to_string(mat) == "1 2 3 4" && m::from_string<m::mat2>("1 2 3 4") == mat;
+  });
+
+  test("text: shortest round trip", []{
+    auto random = std::mt19937(1234);
+    auto distribution = std::uniform_real_distribution<double>(-1e6, 1e6);
+
+    for (auto i : m::range(1000)){
+      (void)i;
+
+      const auto f = m::vec4(float(distribution(random)), float(distribution(random)), 1.f / 3.f, -1e-30f);
+      const auto d = m::dvec3(distribution(random), distribution(random), 1.0 / 3.0);
+
+      if (m::from_string<m::vec4>(m::to_string(f)) != f) return false;
+      if (m::from_string<m::dvec3>(m::to_string(d)) != d) return false;
+    }
+
+    return true;
+  });
+
+  test("text: separators and signs", []{
+    auto v = m::vec3();
+    const auto text = std::string_view(" \t1.5,\n+2 , -3e2 rest");
+    const auto result = m::from_chars(text.data(), text.data() + text.size(), v);
+
+    return
+      result.ec == std::errc() &&
+      std::string_view(result.ptr) == " rest" &&
+      v == m::vec3(1.5f, 2.f, -300.f);
+  });
+
+  test("text: failed parse leaves the value", []{
+    auto v = m::vec3(7.f);
+    const auto text = std::string_view("1 2 x");
+    const auto result = m::from_chars(text.data(), text.data() + text.size(), v);
+
+    return result.ec == std::errc::invalid_argument && v == m::vec3(7.f);
+  });
+
+  test("text: buffer too small", []{
+    char buffer[4];
+    const auto result = m::to_chars(buffer, buffer + sizeof(buffer), m::vec3(1.f, 2.f, 3.f));
+    return result.ec == std::errc::value_too_large;
+  });
+
+  test("text: bulk parsing", []{
+    const auto text = std::string_view("0 0 0\n1,2,3\n\n4.5 -5 6e1\r\n");
+    const auto points = m::parse_array<m::vec3>(text);
+
+    return
+      points.size() == 3 &&
+      points[1] == m::vec3(1.f, 2.f, 3.f) &&
+      points[2] == m::vec3(4.5f, -5.f, 60.f);
+  });
+
+  test("text: bulk parsing stops at errors", []{
+    const auto text = std::string_view("1 2 3 4 5");
+    auto points = std::vector<m::vec3>();
+    const auto result = m::parse_array(text.data(), text.data() + text.size(), points);
+
+    return
+      points.size() == 1 &&
+      result.ec == std::errc::invalid_argument &&
+      result.ptr == text.data() + 6;
+  });
+
+  test("text: bulk round trip", []{
+    auto transforms = std::vector<m::mat4>();
+    for (auto i : m::range(100)){
+      transforms.push_back(m::rotation(0.1f * i, m::vec3(1.f, 2.f, 3.f)) * m::scale(m::vec3(1.f / (i + 1))));
+    }
+
+    return m::parse_array<m::mat4>(m::format_array(transforms)) == transforms;
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
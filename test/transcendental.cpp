@@ -0,0 +1,286 @@
+#define GEFEC_MATH_DEBUG
+#include "../batch.hpp"
+#include "../fixed.hpp"
+#include "test.hpp"
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace m = gf::math;
+
+constexpr auto Infinity = std::numeric_limits<float>::infinity();
+constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+//Distance from the exact result, in units of the last place of the float
+//result; the references are computed in double:
+auto ulp(float value, double expected){
+  if (std::isnan(expected)) return std::isnan(value) ? 0.0 : double(Infinity);
+
+  const auto rounded = float(expected);
+  if (std::isinf(rounded)) return value == rounded ? 0.0 : double(Infinity);
+
+  const auto magnitude = std::abs(rounded);
+  const auto unit = magnitude < std::numeric_limits<float>::min()
+    ? double(std::numeric_limits<float>::denorm_min())
+    : double(std::nextafter(magnitude, Infinity) - magnitude);
+
+  return std::abs(value - expected) / unit;
+}
+
+//Samples of [min, max), not a multiple of the packet size so that the tails
+//run too:
+auto samples(float min, float max){
+  auto random = std::mt19937(7);
+  auto sample = std::uniform_real_distribution<float>(min, max);
+  auto result = std::vector<float>(20000 + 7);
+
+  for (auto& x : result){
+    x = sample(random);
+  }
+
+  return result;
+}
+
+template<typename Callable>
+auto every_isa(Callable callable){
+  auto result = true;
+
+  for (auto level : { m::isa::scalar, m::isa::sse2, m::isa::avx2, m::isa::avx512 }){
+    if (m::force_isa(level) != level) continue;
+    result = result && callable();
+  }
+
+  m::force_isa(m::supported_isa());
+  return result;
+}
+
+//The largest error of an array function over x, at every level:
+template<typename Batched, typename Expected>
+auto max_ulp(const std::vector<float>& x, Batched batched, Expected expected){
+  auto result = std::vector<float>(x.size());
+  auto error = 0.0;
+
+  every_isa([&]{
+    batched(x.data(), x.size(), result.data());
+
+    for (auto i : m::range(x.size())){
+      error = std::max(error, ulp(result[i], expected(double(x[i]))));
+    }
+
+    return true;
+  });
+
+  return error;
+}
+
+//Every result of an array function equal to expected(x), bit for bit:
+template<typename Batched, typename Expected>
+auto exactly(const std::vector<float>& x, Batched batched, Expected expected){
+  return every_isa([&]{
+    auto result = std::vector<float>(x.size());
+    batched(x.data(), x.size(), result.data());
+
+    for (auto i : m::range(x.size())){
+      const auto e = expected(x[i]);
+      if (std::isnan(e) ? !std::isnan(result[i]) : m::detail::float_bits(result[i]) != m::detail::float_bits(e)) return false;
+    }
+
+    return true;
+  });
+}
+
+auto batched_sin(const float* x, std::size_t count, float* result){ m::sin(x, count, result); }
+auto batched_cos(const float* x, std::size_t count, float* result){ m::cos(x, count, result); }
+auto batched_tan(const float* x, std::size_t count, float* result){ m::tan(x, count, result); }
+auto batched_exp(const float* x, std::size_t count, float* result){ m::exp(x, count, result); }
+auto batched_log(const float* x, std::size_t count, float* result){ m::log(x, count, result); }
+
+//atan2 and pow with the other argument fixed:
+auto atan2_over(float x){
+  return [x](const float* y, std::size_t count, float* result){
+    const auto xs = std::vector<float>(count, x);
+    m::atan2(y, xs.data(), count, result);
+  };
+}
+
+auto atan2_of(float y){
+  return [y](const float* x, std::size_t count, float* result){
+    const auto ys = std::vector<float>(count, y);
+    m::atan2(ys.data(), x, count, result);
+  };
+}
+
+auto pow_to(float y){
+  return [y](const float* x, std::size_t count, float* result){
+    m::pow(x, y, count, result);
+  };
+}
+
+auto pow_of(float x){
+  return [x](const float* y, std::size_t count, float* result){
+    const auto xs = std::vector<float>(count, x);
+    m::pow(xs.data(), y, count, result);
+  };
+}
+
+auto main() -> int{
+  std::cerr << std::setprecision(100);
+
+  test("transcendental: sin, cos, sincos and tan of arrays are within 2 ULP", []{
+    const auto small = samples(-4.f, 4.f);
+    const auto large = samples(-4e6f, 4e6f);
+    const auto sin_expected = [](double x){ return std::sin(x); };
+    const auto cos_expected = [](double x){ return std::cos(x); };
+    const auto tan_expected = [](double x){ return std::tan(x); };
+
+    auto other = std::vector<float>(small.size());
+    const auto sines = [&](const float* x, std::size_t count, float* result){ m::sincos(x, count, result, other.data()); };
+    const auto cosines = [&](const float* x, std::size_t count, float* result){ m::sincos(x, count, other.data(), result); };
+
+    return
+      max_ulp(small, batched_sin, sin_expected) <= 2.0 &&
+      max_ulp(small, batched_cos, cos_expected) <= 2.0 &&
+      max_ulp(small, batched_tan, tan_expected) <= 2.0 &&
+      max_ulp(large, batched_sin, sin_expected) <= 2.0 &&
+      max_ulp(large, batched_cos, cos_expected) <= 2.0 &&
+      max_ulp(large, batched_tan, tan_expected) <= 2.0 &&
+      max_ulp(small, sines, sin_expected) <= 2.0 &&
+      max_ulp(small, cosines, cos_expected) <= 2.0;
+  });
+
+  //Beyond 2^22 the arrays are computed with std::, at every level; a few
+  //large elements among small ones take the whole array there:
+  test("transcendental: sin, cos and tan of large arrays are within 2 ULP", []{
+    constexpr auto Max = std::numeric_limits<float>::max();
+
+    auto mixed = samples(-4.f, 4.f);
+    mixed.insert(mixed.begin() + 1000, { 1e10f, -1e30f, 3.4e38f, Max, -Max });
+
+    auto result = true;
+
+    for (const auto& x : { samples(-1e10f, 1e10f), samples(-1e30f, 1e30f), samples(0.f, Max), mixed }){
+      result = result &&
+        max_ulp(x, batched_sin, [](double e){ return std::sin(e); }) <= 2.0 &&
+        max_ulp(x, batched_cos, [](double e){ return std::cos(e); }) <= 2.0 &&
+        max_ulp(x, batched_tan, [](double e){ return std::tan(e); }) <= 2.0;
+    }
+
+    return result;
+  });
+
+  test("transcendental: exp, log and atan2 of arrays are within 2 ULP", []{
+    const auto exp_expected = [](double x){ return std::exp(x); };
+    const auto log_expected = [](double x){ return std::log(x); };
+
+    return
+      max_ulp(samples(-104.f, 89.f), batched_exp, exp_expected) <= 2.0 &&
+      max_ulp(samples(-1.f, 1.f), batched_exp, exp_expected) <= 2.0 &&
+      max_ulp(samples(0.f, 2.f), batched_log, log_expected) <= 2.0 &&
+      max_ulp(samples(0.f, 1e30f), batched_log, log_expected) <= 2.0 &&
+      max_ulp(samples(0.f, 1e-38f), batched_log, log_expected) <= 2.0 &&
+      max_ulp(samples(-10.f, 10.f), atan2_over(1.f), [](double y){ return std::atan2(y, 1.0); }) <= 2.0 &&
+      max_ulp(samples(-10.f, 10.f), atan2_over(-1.f), [](double y){ return std::atan2(y, -1.0); }) <= 2.0 &&
+      max_ulp(samples(-10.f, 10.f), atan2_of(-3.f), [](double x){ return std::atan2(-3.0, x); }) <= 2.0;
+  });
+
+  test("transcendental: pow of arrays is within 2 ULP", []{
+    return
+      max_ulp(samples(0.f, 10.f), pow_to(7.3f), [](double x){ return std::pow(x, double(7.3f)); }) <= 2.0 &&
+      max_ulp(samples(0.f, 1e10f), pow_to(-3.9f), [](double x){ return std::pow(x, double(-3.9f)); }) <= 2.0 &&
+      max_ulp(samples(-100.f, 100.f), pow_of(0.75f), [](double y){ return std::pow(0.75, y); }) <= 2.0 &&
+      max_ulp(samples(-1e4f, 1e4f), pow_of(1.01f), [](double y){ return std::pow(double(1.01f), y); }) <= 2.0;
+  });
+
+  test("transcendental: special values of arrays", []{
+    const auto specials = std::vector<float>{ 0.f, -0.f, Infinity, -Infinity, NaN };
+
+    return
+      exactly(specials, batched_sin, [](float e){ return std::sin(e); }) &&
+      exactly(specials, batched_cos, [](float e){ return std::cos(e); }) &&
+      exactly(specials, batched_tan, [](float e){ return std::tan(e); }) &&
+      exactly({ 0.f, -0.f, Infinity, -Infinity, NaN, 100.f, -200.f }, batched_exp, [](float e){ return std::exp(e); }) &&
+      exactly({ 1.f, 0.f, -0.f, Infinity, -Infinity, -1.f, NaN }, batched_log, [](float e){ return std::log(e); }) &&
+      exactly({ 0.f, -0.f, Infinity, -Infinity, 1.f, -1.f, NaN }, atan2_over(-0.f), [](float e){ return std::atan2(e, -0.f); }) &&
+      exactly({ 0.f, -0.f, Infinity, -Infinity, 1.f, -1.f, NaN }, atan2_over(0.f), [](float e){ return std::atan2(e, 0.f); }) &&
+      exactly(specials, atan2_of(-0.f), [](float e){ return std::atan2(-0.f, e); }) &&
+      exactly(specials, atan2_of(Infinity), [](float e){ return std::atan2(Infinity, e); });
+  });
+
+  test("transcendental: special values of pow", []{
+    const auto x = std::vector<float>{ 0.f, -0.f, 1.f, -1.f, 2.f, -2.f, 0.5f, Infinity, -Infinity, NaN };
+    const auto y = std::vector<float>{ 0.f, -0.f, 1.f, -1.f, 2.f, 3.f, -3.f, 0.5f, 1e30f, -1e30f, Infinity, -Infinity, NaN, 128.f, -149.f };
+
+    auto result = true;
+
+    for (auto e : y){
+      result = result && exactly(x, pow_to(e), [&](float b){ return std::pow(b, e); });
+    }
+
+    return result;
+  });
+
+  //As in the README, on a size the compiler sees through. GCC warned about
+  //the packet loop's tail there; the loop is called directly, since the
+  //array functions are only inlined into a single caller:
+  test("transcendental: arrays of a size known at compile time", []{
+    auto x = std::vector<float>(100000, 1.f);
+    auto result = std::vector<float>(x.size());
+    auto same = true;
+
+    const auto run = [&](auto kernel, double expected){
+      m::detail::for_packets(kernel, 100000, x.data(), result.data());
+      same = same && ulp(result[0], expected) <= 2.0 && ulp(result.back(), expected) <= 2.0;
+    };
+
+    run(m::detail::unary_kernel<m::detail::float_sin>(), std::sin(1.0));
+    run(m::detail::unary_kernel<m::detail::float_cos>(), std::cos(1.0));
+    run(m::detail::unary_kernel<m::detail::float_tan>(), std::tan(1.0));
+    run(m::detail::unary_kernel<m::detail::float_exp>(), std::exp(1.0));
+    run(m::detail::unary_kernel<m::detail::float_log>(), 0.0);
+
+    return same;
+  });
+
+  test("transcendental: vectors and matrices, element by element", []{
+    const auto v = m::vec3(0.5f, -1.f, 2.f);
+    const auto w = m::vec3(2.f, 3.f, 0.25f);
+    const auto [sines, cosines] = m::sincos(v);
+    const auto a = m::mat2(1.f, 2.f, 3.f, 4.f);
+
+    auto result = true;
+
+    for (auto i : m::range(3)){
+      result = result &&
+        m::sin(v)[i] == std::sin(v[i]) &&
+        m::cos(v)[i] == std::cos(v[i]) &&
+        sines[i] == std::sin(v[i]) &&
+        cosines[i] == std::cos(v[i]) &&
+        m::tan(v)[i] == std::tan(v[i]) &&
+        m::exp(v)[i] == std::exp(v[i]) &&
+        m::log(w)[i] == std::log(w[i]) &&
+        m::atan2(v, w)[i] == std::atan2(v[i], w[i]) &&
+        m::pow(w, v)[i] == std::pow(w[i], v[i]) &&
+        m::pow(v, 2.f)[i] == v[i] * v[i];
+    }
+
+    for (auto [x, y] : m::range({ 2, 2 })){
+      result = result && m::exp(a).at(x, y) == std::exp(a.at(x, y));
+    }
+
+    return result;
+  });
+
+  test("transcendental: other number types", []{
+    const auto d = m::dvec2(0.5, 3.0);
+    const auto f = m::vec<m::fixed16, 2>(m::fixed16(1), m::fixed16(-2));
+
+    return
+      m::sin(d) == m::dvec2(std::sin(0.5), std::sin(3.0)) &&
+      m::pow(d, d) == m::dvec2(std::pow(0.5, 0.5), 27.0) &&
+      m::sin(1.0) == std::sin(1.0) &&
+      m::sin(f) == m::vec<m::fixed16, 2>(m::sin(m::fixed16(1)), m::sin(m::fixed16(-2)));
+  });
+
+  std::cout << "ALL TESTS PASSED\n";
+}
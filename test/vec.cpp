@@ -2,6 +2,7 @@
 #include "../math.hpp"
 #include "test.hpp"
 #include <iomanip>
+#include <vector>
 
 auto main() -> int{
   std::cerr << std::setprecision(100);
@@ -10,6 +11,10 @@ auto main() -> int{
 
   static_assert(sizeof(m::vec<double, 10>) == sizeof(double) * 10);
 
+  //Lengths and normalization stay usable in constant expressions:
+  static_assert(m::vec2(3.f, 4.f).len() == 5.f);
+  static_assert(m::vec2(3.f, 4.f).normalized() == m::vec2(0.6f, 0.8f));
+
   test("vec: all operators implemented", []{
     auto vec = m::vec4(1.f, 2.f, 3.f, 4.f);
     auto mat = m::mat4(1.f);
@@ -127,17 +132,85 @@ auto main() -> int{
     return 10.f / vec2 == expected;
   });
 
+  test("compound operators match binary operators", [&]{
+    auto a = vec;
+    auto b = vec2;
+    auto c = m::ivec3(7, -9, 12);
+    const auto mat = m::mat4(
+      2.f, 3.f, 5.f, 7.f,
+      11.f, 13.f, 17.f, 19.f,
+      23.f, 29.f, 31.f, 37.f,
+      41.f, 43.f, 47.f, 53.f
+    );
+    auto d = vec2;
+    auto e = vec2;
+
+    a += vec2; a -= 0.25f; a *= vec2; a /= 3.f;
+    b -= vec; b /= vec2 + 1.f;
+    c /= 2; c -= m::ivec3(1);
+    d *= mat;
+    e /= mat;
+
+    return
+      a == ((vec + vec2) - 0.25f) * vec2 / 3.f &&
+      b == (vec2 - vec) / (vec2 + 1.f) &&
+      c == m::ivec3(2, -5, 5) &&
+      d == vec2 * mat &&
+      e == vec2 / mat && e != vec2 * mat;
+  });
+
   test("vec.as_vec", [&]{
     return vec.as_vec<2>(0.f) == m::vec2(0.5, -0.5);
   });
 
   vec = m::vec4(-2.0, 3.0, -5.0, 7.0);
   test("vec.len_squred()", [&]{
-    return vec.len_squared() == 87.0;
+    return vec.len_squared() == 87.f && vec.len_squared<m::precision::widened>() == 87.0;
   });
 
   test("vec.len()", [&]{
-    return vec.len() == std::sqrt(87.0);
+    return 
+      vec.len() == std::sqrt(87.f) && 
+      vec.len<m::precision::widened>() == std::sqrt(87.0);
+  });
+
+  test("accumulation types", []{
+    static_assert(std::is_same_v<decltype(m::vec2().len()), float>);
+    static_assert(std::is_same_v<decltype(m::vec2().len<m::precision::widened>()), double>);
+    static_assert(std::is_same_v<decltype(m::ivec3().len_squared<m::precision::widened>()), std::int64_t>);
+    static_assert(std::is_same_v<decltype(m::mat3().det()), float>);
+    return true;
+  });
+
+  test("compensated and pairwise sums", []{
+    //1 followed by many terms below float's resolution at 1:
+    auto values = std::vector<float>(1 << 16, 1e-8f);
+    values[0] = 1.f;
+
+    const auto expected = 1.0 + (values.size() - 1) * double(1e-8f);
+
+    const auto native = m::sum(values);
+    const auto kahan = m::sum<m::precision::kahan>(values);
+    const auto pairwise = m::sum<m::precision::pairwise>(values);
+    const auto widened = m::sum<m::precision::widened>(values);
+
+    return
+      native == 1.f &&
+      std::abs(kahan - expected) < 1e-6 &&
+      std::abs(pairwise - expected) < 1e-6 &&
+      std::abs(widened - expected) < 1e-9;
+  });
+
+  test("dot with policies", []{
+    const auto big = m::ivec2(100000, 100000);
+    const auto a = m::vec3(1e8f, 1.f, -1e8f);
+    const auto b = m::vec3(1.f, 1.f, 1.f);
+
+    return
+      m::dot<m::precision::widened>(big, big) == 20000000000ll &&
+      m::dot(a, b) == 0.f &&
+      m::dot<m::precision::kahan>(a, b) == 1.f &&
+      m::mat2(2.f, 1.f, 1.f, 3.f).det<m::precision::widened>() == 5.0;
   });
 
   test("normalization", []{
@@ -184,5 +257,73 @@ auto main() -> int{
       m::compare(m::dot(v2, v3), 0.f);
   });
 
+  test("vec: comparison masks", []{
+    const auto a = m::vec4(1.f, 2.f, 3.f, 4.f);
+    const auto b = m::vec4(4.f, 2.f, 1.f, 5.f);
+
+    return
+      m::movemask(m::less(a, b)) == 0b1001 &&
+      m::movemask(m::less_equal(a, b)) == 0b1011 &&
+      m::movemask(m::greater(a, b)) == 0b0100 &&
+      m::movemask(m::greater_equal(a, b)) == 0b0110 &&
+      m::movemask(m::equal(a, b)) == 0b0010 &&
+      m::movemask(m::not_equal(a, b)) == 0b1101 &&
+      m::less(a, b)[0] && !m::less(a, b)[1];
+  });
+
+  test("vec: nearly_equal", []{
+    const auto a = m::vec3(1.f, 2.f, 3.f);
+    const auto b = m::vec3(1.f + m::Epsilon<float> / 2.f, 2.5f, 3.f);
+
+    return m::movemask(m::nearly_equal(a, b)) == 0b101 && m::all(m::nearly_equal(a, b, 1.f));
+  });
+
+  test("vec: any all none", []{
+    const auto a = m::ivec3(1, 2, 3);
+
+    return
+      m::all(m::equal(a, a)) && !m::none(m::equal(a, a)) &&
+      m::none(m::less(a, a)) && !m::any(m::less(a, a)) &&
+      m::any(m::less(a, m::ivec3(0, 0, 4))) && !m::all(m::less(a, m::ivec3(0, 0, 4))) &&
+      m::all(~m::less(a, a)) &&
+      (m::less(a, m::ivec3(2)) | m::greater(a, m::ivec3(2))) == m::not_equal(a, m::ivec3(2));
+  });
+
+  test("vec: select", []{
+    const auto x = m::vec4(-2.f, 0.5f, 3.f, -0.25f);
+    const auto clamped = m::select(m::greater(x, m::vec4(1.f)), m::vec4(1.f), x);
+    const auto flipped = m::select(m::less(x, m::vec4(0.f)), -x, x);
+
+    constexpr auto picked = m::select(m::vmask<2>{ 0b10 }, m::ivec2(1, 2), m::ivec2(3, 4));
+    static_assert(picked.x == 3 && picked.y == 2);
+
+    return
+      clamped == m::vec4(-2.f, 0.5f, 1.f, -0.25f) &&
+      flipped == m::abs(x);
+  });
+
+  test("vec: swizzle", []{
+    constexpr auto v = m::vec4(1.f, 2.f, 3.f, 4.f);
+
+    static_assert(v.xy() == m::vec2(1.f, 2.f));
+    static_assert(v.wzyx() == m::vec4(4.f, 3.f, 2.f, 1.f));
+    static_assert(v.swizzle<2, 0, 1>() == v.zxy());
+
+    return 
+      v.xxx() == m::vec3(1.f) &&
+      m::ivec2(5, 6).yx() == m::ivec2(6, 5) &&
+      m::vec3(1.f, 2.f, 3.f).xzyy() == m::vec4(1.f, 3.f, 2.f, 2.f);
+  });
+
+  test("vec: swizzle assignment", []{
+    auto v = m::vec4(1.f, 2.f, 3.f, 4.f);
+    v.set_zx(m::vec2(10.f, 20.f));
+
+    auto u = m::ivec3(0);
+    u.assign<2, 1>(m::ivec2(7, 8))[0] = 9;
+
+    return v == m::vec4(20.f, 2.f, 10.f, 4.f) && u == m::ivec3(9, 8, 7);
+  });
+
   std::cout << "ALL TESTS PASSED\n";
 }
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "math.hpp"
+#include <charconv>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+//Locale independent text formatting and parsing of vectors and matrices,
+//built on std::to_chars/std::from_chars. Components are written in the
+//shortest form that reads back to the same value and separated by a space.
+//Parsers accept any mix of whitespace and commas between components.
+
+namespace gf::math{
+
+namespace detail{
+
+inline constexpr auto is_text_separator(char c) noexcept{
+  return c == ' ' || c == ',' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+inline constexpr auto skip_text_separators(const char* first, const char* last) noexcept{
+  while (first != last && is_text_separator(*first)) ++first;
+  return first;
+}
+
+//Longest shortest round-trip representation of a component, sign and exponent included:
+template<typename T>
+inline constexpr auto max_scalar_chars() noexcept -> std::size_t{
+  if constexpr (std::is_floating_point_v<T>){
+    return std::numeric_limits<T>::max_digits10 + 8;
+  }
+  else{
+    return std::numeric_limits<T>::digits10 + 2;
+  }
+}
+
+template<typename T>
+inline auto parse_scalar(const char* first, const char* last, T& value) noexcept{
+  first = skip_text_separators(first, last);
+
+  //std::from_chars doesn't take a plus sign:
+  if (first != last && *first == '+') ++first;
+
+  return std::from_chars(first, last, value);
+}
+
+template<typename T>
+inline auto format_scalar(char* first, char* last, T value) noexcept{
+  if constexpr (std::is_same_v<T, bool>){
+    return std::to_chars(first, last, int(value));
+  }
+  else{
+    return std::to_chars(first, last, value);
+  }
+}
+
+inline auto format_separator(std::to_chars_result result, char* last) noexcept{
+  if (result.ec != std::errc()) return result;
+  if (result.ptr == last) return std::to_chars_result{ last, std::errc::value_too_large };
+
+  *result.ptr = ' ';
+  ++result.ptr;
+  return result;
+}
+
+} //namespace detail
+
+//Upper bound of the characters written by to_chars for one element:
+template<typename T, std::size_t N>
+inline constexpr auto max_chars(const vec<T, N>*) noexcept{
+  return N * (detail::max_scalar_chars<T>() + 1);
+}
+
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline constexpr auto max_chars(const mat<T, W, H, L>*) noexcept{
+  return W * H * (detail::max_scalar_chars<T>() + 1);
+}
+
+template<typename E>
+inline constexpr auto MaxChars = max_chars(static_cast<const E*>(nullptr));
+
+//Writes "x y z", nothing is terminated. Like std::to_chars, on errc::value_too_large
+//the contents of [first, last) are unspecified:
+template<typename T, std::size_t N>
+inline auto to_chars(char* first, char* last, const vec<T, N>& v) noexcept{
+  auto result = std::to_chars_result{ first, std::errc() };
+
+  for (auto i : range(N)){
+    if (i != 0) result = detail::format_separator(result, last);
+    if (result.ec != std::errc()) return result;
+
+    result = detail::format_scalar(result.ptr, last, v[i]);
+  }
+
+  return result;
+}
+
+//Row by row, like operator<<, whatever the storage layout:
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline auto to_chars(char* first, char* last, const mat<T, W, H, L>& m) noexcept{
+  auto result = std::to_chars_result{ first, std::errc() };
+
+  for (auto y : range(H)){
+    for (auto x : range(W)){
+      if (x != 0 || y != 0) result = detail::format_separator(result, last);
+      if (result.ec != std::errc()) return result;
+
+      result = detail::format_scalar(result.ptr, last, m.at(x, y));
+    }
+  }
+
+  return result;
+}
+
+//Leading separators are skipped. Like std::from_chars, the value is only
+//changed when every component was parsed:
+template<typename T, std::size_t N>
+inline auto from_chars(const char* first, const char* last, vec<T, N>& v) noexcept{
+  auto parsed = vec<T, N>();
+  auto result = std::from_chars_result{ first, std::errc() };
+
+  for (auto i : range(N)){
+    result = detail::parse_scalar(result.ptr, last, parsed[i]);
+    if (result.ec != std::errc()) return result;
+  }
+
+  v = parsed;
+  return result;
+}
+
+template<typename T, std::size_t W, std::size_t H, typename L>
+inline auto from_chars(const char* first, const char* last, mat<T, W, H, L>& m) noexcept{
+  auto parsed = mat<T, W, H, L>();
+  auto result = std::from_chars_result{ first, std::errc() };
+
+  for (auto y : range(H)){
+    for (auto x : range(W)){
+      result = detail::parse_scalar(result.ptr, last, parsed.at(x, y));
+      if (result.ec != std::errc()) return result;
+    }
+  }
+
+  m = parsed;
+  return result;
+}
+
+template<typename E>
+inline auto to_string(const E& element){
+  char buffer[MaxChars<E>];
+  const auto result = math::to_chars(buffer, buffer + sizeof(buffer), element);
+  return std::string(buffer, result.ptr);
+}
+
+//Returns the parsed element, or a default constructed one when text doesn't start with one:
+template<typename E>
+inline auto from_string(std::string_view text){
+  auto element = E();
+  math::from_chars(text.data(), text.data() + text.size(), element);
+  return element;
+}
+
+//Bulk import: appends every element of [first, last) to elements. Stops at the
+//first malformed (or incomplete) element, whose position is returned with its error:
+template<typename E>
+inline auto parse_array(const char* first, const char* last, std::vector<E>& elements){
+  auto element = E();
+
+  while (true){
+    first = detail::skip_text_separators(first, last);
+    if (first == last) return std::from_chars_result{ first, std::errc() };
+
+    const auto result = math::from_chars(first, last, element);
+    if (result.ec != std::errc()) return std::from_chars_result{ first, result.ec };
+
+    elements.push_back(element);
+    first = result.ptr;
+  }
+}
+
+template<typename E>
+inline auto parse_array(std::string_view text){
+  auto elements = std::vector<E>();
+  parse_array(text.data(), text.data() + text.size(), elements);
+  return elements;
+}
+
+//Bulk export, one element per line:
+template<typename E>
+inline auto format_array(const std::vector<E>& elements){
+  auto text = std::string(elements.size() * (MaxChars<E> + 1), '\0');
+
+  auto* first = text.data();
+  auto* last = first + text.size();
+
+  for (const auto& element : elements){
+    //The buffer can't be too small, every element gets MaxChars:
+    first = math::to_chars(first, last, element).ptr;
+    *first++ = '\n';
+  }
+
+  text.resize(first - text.data());
+  return text;
+}
+
+} //namespace gf::math